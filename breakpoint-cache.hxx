@@ -23,8 +23,8 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include <QString>
-#include <QMap>
 #include <QSet>
 
 #include "source-code-location.hxx"
@@ -75,8 +75,8 @@ struct GdbBreakpointData
 class BreakpointCache
 {
 private:
-	QMap<QString /* filename */, QSet<int /* line numbers */>> enabledSourceCodeBreakpoints;
-	QMap<QString /* filename */, QSet<int /* line numbers */>> disabledSourceCodeBreakpoints;
+	std::unordered_map<FileId, QSet<int /* line numbers */>> enabledSourceCodeBreakpoints;
+	std::unordered_map<FileId, QSet<int /* line numbers */>> disabledSourceCodeBreakpoints;
 	QSet<uint64_t /* address */> enabledBreakpointAddresses;
 	QSet<uint64_t /* address */> disabledBreakpointAddresses;
 	const QSet<int /* line number */> emptySet;
@@ -92,30 +92,26 @@ public:
 			if (!b.multipleLocationBreakpoints.size())
 			{
 				(b.enabled ? enabledSourceCodeBreakpoints : disabledSourceCodeBreakpoints)
-					    .operator [](b.sourceCodeLocation.fullFileName).insert(b.sourceCodeLocation.lineNumber);
+					    .operator [](b.sourceCodeLocation.fileId()).insert(b.sourceCodeLocation.lineNumber);
 				(b.enabled ? enabledBreakpointAddresses : disabledBreakpointAddresses).insert(b.address);
 			}
 			else
 				for (const auto & t : b.multipleLocationBreakpoints)
 				{
 					(t.enabled ? enabledSourceCodeBreakpoints : disabledSourceCodeBreakpoints)
-							.operator [](t.sourceCodeLocation.fullFileName).insert(t.sourceCodeLocation.lineNumber);
+							.operator [](t.sourceCodeLocation.fileId()).insert(t.sourceCodeLocation.lineNumber);
 					(t.enabled ? enabledBreakpointAddresses : disabledBreakpointAddresses).insert(t.address);
 				}
 		}
 	}
 	bool hasEnabledBreakpointAtAddress(uint64_t address) const { return enabledBreakpointAddresses.contains(address); }
 	bool hasDisabledBreakpointAtAddress(uint64_t address) const { return disabledBreakpointAddresses.contains(address); }
-	bool hasEnabledBreakpointAtLineNumber(const QString & fullFileName, int lineNumber) const
-	{ return enabledSourceCodeBreakpoints.contains(fullFileName) && enabledSourceCodeBreakpoints.operator [](fullFileName).contains(lineNumber); }
-	bool hasDisabledBreakpointAtLineNumber(const QString & fullFileName, int lineNumber) const
-	{ return disabledSourceCodeBreakpoints.contains(fullFileName) && disabledSourceCodeBreakpoints.operator [](fullFileName).contains(lineNumber); }
-	/*! \todo	!?!?!? Making this function 'const' leads to returning null references and crashing the program.
-	 *		Investigate what is going on??? */
-	const QSet<int /* line numbers */> & enabledBreakpointLinesForFile(const QString & fullFileName) /* const */
-	{ return enabledSourceCodeBreakpoints.contains(fullFileName) ? enabledSourceCodeBreakpoints.operator [](fullFileName) : emptySet; }
-	/*! \todo	!?!?!? Making this function 'const' leads to returning null references and crashing the program.
-	 *		Investigate what is going on??? */
-	const QSet<int /* line numbers */> & disabledBreakpointLinesForFile(const QString & fullFileName) /* const */
-	{ return disabledSourceCodeBreakpoints.contains(fullFileName) ? disabledSourceCodeBreakpoints.operator [](fullFileName) : emptySet; }
+	bool hasEnabledBreakpointAtLineNumber(FileId fileId, int lineNumber) const
+	{ return enabledBreakpointLinesForFile(fileId).contains(lineNumber); }
+	bool hasDisabledBreakpointAtLineNumber(FileId fileId, int lineNumber) const
+	{ return disabledBreakpointLinesForFile(fileId).contains(lineNumber); }
+	const QSet<int /* line numbers */> & enabledBreakpointLinesForFile(FileId fileId) const
+	{ auto i = enabledSourceCodeBreakpoints.find(fileId); return i != enabledSourceCodeBreakpoints.cend() ? i->second : emptySet; }
+	const QSet<int /* line numbers */> & disabledBreakpointLinesForFile(FileId fileId) const
+	{ auto i = disabledSourceCodeBreakpoints.find(fileId); return i != disabledSourceCodeBreakpoints.cend() ? i->second : emptySet; }
 };
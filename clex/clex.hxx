@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2020 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/* The interface of the 'clex' source code scanner, generated from 'clex.y'. The scanner does not generate
+ * any output by itself, it only reports the tokens that it recognizes. The same tokens are used for the
+ * syntax highlighting of the source code view, and for indexing the identifiers in the source code files. */
+namespace clex
+{
+	enum FORMAT_TYPE_ENUM
+	{
+		INVALID	=	0,
+		COMMENT,
+		SINGLE_LINE_COMMENT,
+		PREPROCESSOR_START,
+		PREPROCESSOR,
+		KEYWORD_GROUP_A,
+		KEYWORD_GROUP_B,
+		KEYWORD_GROUP_C,
+		KEYWORD_GROUP_D,
+		PUNCTUATION,
+		NUMBER,
+		STRING,
+		FORMAT_TYPES_COUNT,
+	};
+	/* A token recognized by the scanner. Tokens never span multiple lines - comments and preprocessor
+	 * directives that continue on several lines are reported as one token per line. Whitespace, and
+	 * characters that the scanner does not recognize, are not reported. */
+	struct Token
+	{
+		/* The byte offset and length of the token in the scanned source code. */
+		int			offset;
+		int			length;
+		enum FORMAT_TYPE_ENUM	format;
+	};
+	/* The scanner state, passed to the scanner as its 'extra' data. */
+	struct ScannerState;
+
+	/* Scans a null-terminated source code string, and returns the tokens in it, in source code order. */
+	std::vector<Token> scan_tokens(const char * source);
+	/* Generates the html formatted source code, which is highlighted with the 'highlight.css' style sheet,
+	 * from the tokens scanned from a null-terminated source code string. */
+	std::string format_html(const char * source, const std::vector<Token> & tokens);
+}
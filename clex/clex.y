@@ -36,40 +36,30 @@ IS                      ((u|U)|(u|U)?(l|L|ll|LL)|(l|L|ll|LL)(u|U))
 %option header-file="cscanner.hxx" outfile="cscanner.cxx"
 %option noyywrap
 %option reentrant
-%option extra-type="std::string *"
+%option extra-type="clex::ScannerState *"
 
 %{
 #include <stdio.h>
+#include <string.h>
 #include <string>
+#include <vector>
+
+#include "clex.hxx"
 
 namespace clex
 {
-	enum FORMAT_TYPE_ENUM
+	struct ScannerState
 	{
-		INVALID	=	0,
-		COMMENT,
-		SINGLE_LINE_COMMENT,
-		PREPROCESSOR_START,
-		PREPROCESSOR,
-		KEYWORD_GROUP_A,
-		KEYWORD_GROUP_B,
-		KEYWORD_GROUP_C,
-		KEYWORD_GROUP_D,
-		PUNCTUATION,
-		NUMBER,
-		STRING,
-		FORMAT_TYPES_COUNT,
+		std::vector<Token>	tokens;
+		/* The offset in the scanned source code of the next character to be consumed by the scanner. */
+		int			offset = 0;
 	};
 }
 using namespace clex;
 
-static void emit(int c, yyscan_t yyscanner);
-static void emit_raw_string(const char * s, yyscan_t yyscanner);
-static void emit_escaped(int c, yyscan_t yyscanner);
-static void emit_format_begin(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner);
-static void emit_format_end(yyscan_t yyscanner);
-static void emit_yytext(yyscan_t yyscanner);
+static void emit_token(enum FORMAT_TYPE_ENUM format, int offset, int length, yyscan_t yyscanner);
 static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner);
+static void skip_yytext(yyscan_t yyscanner);
 static void comment(yyscan_t yyscanner);
 static void preprocessor(yyscan_t yyscanner);
 
@@ -187,75 +177,28 @@ L?\"(\\.|[^\\"\n])*\"	{ emit_formatted_yytext(STRING, yyscanner); }
 "|"			{ emit_formatted_yytext(PUNCTUATION, yyscanner); }
 "?"			{ emit_formatted_yytext(PUNCTUATION, yyscanner); }
 
-[ \t\v\n\f]		{ emit(* yytext, yyscanner); }
-.			{ emit(* yytext, yyscanner); }
+[ \t\v\n\f]		{ skip_yytext(yyscanner); }
+.			{ skip_yytext(yyscanner); }
 
 %%
 
-static void emit(int c, yyscan_t yyscanner)
+static void emit_token(enum FORMAT_TYPE_ENUM format, int offset, int length, yyscan_t yyscanner)
 {
-	yyget_extra(yyscanner)->operator+=(c);
-}
-
-static void emit_raw_string(const char * s, yyscan_t yyscanner)
-{
-	while (* s)
-		emit(* s ++, yyscanner);
-}
-
-
-static void emit_escaped(int c, yyscan_t yyscanner)
-{
-	switch (c)
-	{
-		default: emit(c, yyscanner); break;
-		case '<': emit_raw_string("&lt;", yyscanner); break;
-		case '>': emit_raw_string("&gt;", yyscanner); break;
-		case '&': emit_raw_string("&amp;", yyscanner); break;
-	}
+	/* Empty comment and preprocessor lines are not reported. */
+	if (length)
+		yyget_extra(yyscanner)->tokens.push_back(Token { offset, length, format });
 }
 
-static void emit_format_begin(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner)
-{
-static const char * format_strings[FORMAT_TYPES_COUNT] = {
-	[FORMAT_TYPE_ENUM::INVALID] =			"inv",
-	[FORMAT_TYPE_ENUM::COMMENT] =			"com",
-	[FORMAT_TYPE_ENUM::SINGLE_LINE_COMMENT] =	"slc",
-	[FORMAT_TYPE_ENUM::PREPROCESSOR_START] =	"pps",
-	[FORMAT_TYPE_ENUM::PREPROCESSOR] =		"ppc",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_A] =		"kwa",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_B] =		"kwb",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_C] =		"kwc",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_D] =		"kwd",
-	[FORMAT_TYPE_ENUM::PUNCTUATION] =		"opt",
-	[FORMAT_TYPE_ENUM::NUMBER] =			"num",
-	[FORMAT_TYPE_ENUM::STRING] =			"str",
-};
-	if (format < 0 || format >= FORMAT_TYPES_COUNT)
-		format = FORMAT_TYPE_ENUM::INVALID;
-
-	emit_raw_string("<span class=\"hl ", yyscanner);
-	emit_raw_string(format_strings[format], yyscanner);
-	emit_raw_string("\">", yyscanner);
-}
-
-static void emit_format_end(yyscan_t yyscanner)
-{
-	emit_raw_string("</span>", yyscanner);
-}
-
-static void emit_yytext(yyscan_t yyscanner)
+static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner)
 {
-	const char * p = yyget_text(yyscanner);
-	while (* p)
-		emit_escaped(* p ++, yyscanner);
+	ScannerState * state = yyget_extra(yyscanner);
+	emit_token(format, state->offset, yyget_leng(yyscanner), yyscanner);
+	state->offset += yyget_leng(yyscanner);
 }
 
-static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner)
+static void skip_yytext(yyscan_t yyscanner)
 {
-	emit_format_begin(format, yyscanner);
-	emit_yytext(yyscanner);
-	emit_format_end(yyscanner);
+	yyget_extra(yyscanner)->offset += yyget_leng(yyscanner);
 }
 
 /*! !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -265,59 +208,106 @@ static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscann
 static void comment(yyscan_t yyscanner)
 {
 	char c, prev = 0;
-	emit_format_begin(FORMAT_TYPE_ENUM::COMMENT, yyscanner);
-	emit_yytext(yyscanner);
+	ScannerState * state = yyget_extra(yyscanner);
+	int start = state->offset;
+	state->offset += yyget_leng(yyscanner);
 
 	while ((c = yyinput(yyscanner)) != 0)      /* (EOF maps to 0) */
 	{
+		state->offset ++;
 		if (c == '/' && prev == '*')
 		{
-			emit_escaped(c, yyscanner);
-			emit_format_end(yyscanner);
+			emit_token(FORMAT_TYPE_ENUM::COMMENT, start, state->offset - start, yyscanner);
 			return;
 		}
 		if (c == '\n')
 		{
-			emit_format_end(yyscanner);
-			emit_escaped(c, yyscanner);
-			emit_format_begin(FORMAT_TYPE_ENUM::COMMENT, yyscanner);
+			emit_token(FORMAT_TYPE_ENUM::COMMENT, start, state->offset - 1 - start, yyscanner);
+			start = state->offset;
 		}
-		else
-			emit_escaped(c, yyscanner);
 		prev = c;
 	}
-	emit_raw_string("unterminated comment", yyscanner);
-	emit_format_end(yyscanner);
+	/* Unterminated comment. */
+	emit_token(FORMAT_TYPE_ENUM::COMMENT, start, state->offset - start, yyscanner);
 }
 
 /*! \todo This is broken for dos line endings (<CR><LF>). */
 static void preprocessor(yyscan_t yyscanner)
 {
 	char c, prev = 0;
-	emit_format_begin(FORMAT_TYPE_ENUM::PREPROCESSOR_START, yyscanner);
-	emit_yytext(yyscanner);
-	emit_format_end(yyscanner);
-	emit_format_begin(FORMAT_TYPE_ENUM::PREPROCESSOR, yyscanner);
+	ScannerState * state = yyget_extra(yyscanner);
+	emit_formatted_yytext(FORMAT_TYPE_ENUM::PREPROCESSOR_START, yyscanner);
+	int start = state->offset;
 
 	while ((c = yyinput(yyscanner)) != 0)      /* (EOF maps to 0) */
 	{
-		if (c == '\n' && prev == '\\')
-		{
-			emit_format_end(yyscanner);
-			emit(c, yyscanner);
-			emit_format_begin(FORMAT_TYPE_ENUM::PREPROCESSOR, yyscanner);
-		}
-		else if (c == '\n')
+		state->offset ++;
+		if (c == '\n')
 		{
-			emit_format_end(yyscanner);
-			emit_escaped(c, yyscanner);
-			return;
+			emit_token(FORMAT_TYPE_ENUM::PREPROCESSOR, start, state->offset - 1 - start, yyscanner);
+			if (prev != '\\')
+				return;
+			start = state->offset;
 		}
-		else
-			emit_escaped(c, yyscanner);
 		prev = c;
 	}
-	emit_format_end(yyscanner);
+	emit_token(FORMAT_TYPE_ENUM::PREPROCESSOR, start, state->offset - start, yyscanner);
+}
+
+std::vector<Token> clex::scan_tokens(const char * source)
+{
+	yyscan_t scanner;
+	ScannerState state;
+	yylex_init_extra(& state, &scanner);
+
+	yy_scan_string(source, scanner);
+	yylex(scanner);
+	yylex_destroy(scanner);
+	return std::move(state.tokens);
+}
+
+std::string clex::format_html(const char * source, const std::vector<Token> & tokens)
+{
+static const char * format_strings[FORMAT_TYPES_COUNT] = {
+	[FORMAT_TYPE_ENUM::INVALID] =			"inv",
+	[FORMAT_TYPE_ENUM::COMMENT] =			"com",
+	[FORMAT_TYPE_ENUM::SINGLE_LINE_COMMENT] =	"slc",
+	[FORMAT_TYPE_ENUM::PREPROCESSOR_START] =	"pps",
+	[FORMAT_TYPE_ENUM::PREPROCESSOR] =		"ppc",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_A] =		"kwa",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_B] =		"kwb",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_C] =		"kwc",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_D] =		"kwd",
+	[FORMAT_TYPE_ENUM::PUNCTUATION] =		"opt",
+	[FORMAT_TYPE_ENUM::NUMBER] =			"num",
+	[FORMAT_TYPE_ENUM::STRING] =			"str",
+};
+	std::string html;
+	int offset = 0, length = strlen(source);
+	html.reserve(length + length / 2);
+
+	auto emit_escaped = [&] (int end) -> void
+	{
+		for (; offset < end; offset ++)
+			switch (source[offset])
+			{
+				default: html += source[offset]; break;
+				case '<': html += "&lt;"; break;
+				case '>': html += "&gt;"; break;
+				case '&': html += "&amp;"; break;
+			}
+	};
+	for (const auto & token : tokens)
+	{
+		emit_escaped(token.offset);
+		html += "<span class=\"hl ";
+		html += format_strings[(token.format < 0 || token.format >= FORMAT_TYPES_COUNT) ? FORMAT_TYPE_ENUM::INVALID : token.format];
+		html += "\">";
+		emit_escaped(token.offset + token.length);
+		html += "</span>";
+	}
+	emit_escaped(length);
+	return html;
 }
 
 
@@ -364,14 +354,8 @@ FILE * infile;
 	fread(test_string, 1, MAX_SCANNED_SOURCE_CODE_FILE_SIZE, infile);
 	fclose(infile);
 
-	yyscan_t scanner;
-	std::string s;
-	yylex_init_extra(& s, &scanner);
-
-	s = html_header;
-	yy_scan_string(test_string, scanner);
-	yylex(scanner);
-	yylex_destroy(scanner);
+	std::string s = html_header;
+	s += format_html(test_string, scan_tokens(test_string));
 	s += html_footer;
 	printf("%s", s.c_str());
 	return 0;
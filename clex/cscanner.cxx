@@ -671,43 +671,33 @@ static const flex_int16_t yy_chk[630] =
  * http://www.quut.com/c/ANSI-C-grammar-l-1999.html
  * Thanks!
  */
-#line 20 "clex.y"
+#line 42 "clex.y"
 #include <stdio.h>
+#include <string.h>
 #include <string>
+#include <vector>
+
+#include "clex.hxx"
 
 namespace clex
 {
-	enum FORMAT_TYPE_ENUM
+	struct ScannerState
 	{
-		INVALID	=	0,
-		COMMENT,
-		SINGLE_LINE_COMMENT,
-		PREPROCESSOR_START,
-		PREPROCESSOR,
-		KEYWORD_GROUP_A,
-		KEYWORD_GROUP_B,
-		KEYWORD_GROUP_C,
-		KEYWORD_GROUP_D,
-		PUNCTUATION,
-		NUMBER,
-		STRING,
-		FORMAT_TYPES_COUNT,
+		std::vector<Token>	tokens;
+		/* The offset in the scanned source code of the next character to be consumed by the scanner. */
+		int			offset = 0;
 	};
 }
 using namespace clex;
 
-static void emit(int c, yyscan_t yyscanner);
-static void emit_raw_string(const char * s, yyscan_t yyscanner);
-static void emit_escaped(int c, yyscan_t yyscanner);
-static void emit_format_begin(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner);
-static void emit_format_end(yyscan_t yyscanner);
-static void emit_yytext(yyscan_t yyscanner);
+static void emit_token(enum FORMAT_TYPE_ENUM format, int offset, int length, yyscan_t yyscanner);
 static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner);
+static void skip_yytext(yyscan_t yyscanner);
 static void comment(yyscan_t yyscanner);
 static void preprocessor(yyscan_t yyscanner);
 
-#line 709 "cscanner.cxx"
-#line 710 "cscanner.cxx"
+#line 699 "cscanner.cxx"
+#line 700 "cscanner.cxx"
 
 #define INITIAL 0
 
@@ -719,7 +709,7 @@ static void preprocessor(yyscan_t yyscanner);
 #include <unistd.h>
 #endif
 
-#define YY_EXTRA_TYPE std::string *
+#define YY_EXTRA_TYPE clex::ScannerState *
 
 /* Holds the entire state of the reentrant scanner. */
 struct yyguts_t
@@ -965,9 +955,9 @@ YY_DECL
 		}
 
 	{
-#line 56 "clex.y"
+#line 69 "clex.y"
 
-#line 970 "cscanner.cxx"
+#line 960 "cscanner.cxx"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -1026,521 +1016,521 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 57 "clex.y"
+#line 70 "clex.y"
 { /* */ comment(yyscanner); }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 58 "clex.y"
+#line 71 "clex.y"
 { emit_formatted_yytext(SINGLE_LINE_COMMENT, yyscanner); }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 61 "clex.y"
+#line 74 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_C, yyscanner); }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 62 "clex.y"
+#line 75 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 63 "clex.y"
+#line 76 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 64 "clex.y"
+#line 77 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 65 "clex.y"
+#line 78 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 66 "clex.y"
+#line 79 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 67 "clex.y"
+#line 80 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 68 "clex.y"
+#line 81 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 69 "clex.y"
+#line 82 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 70 "clex.y"
+#line 83 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 71 "clex.y"
+#line 84 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 72 "clex.y"
+#line 85 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 73 "clex.y"
+#line 86 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 74 "clex.y"
+#line 87 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_C, yyscanner); }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 75 "clex.y"
+#line 88 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 76 "clex.y"
+#line 89 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 77 "clex.y"
+#line 90 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 78 "clex.y"
+#line 91 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 79 "clex.y"
+#line 92 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 80 "clex.y"
+#line 93 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_C, yyscanner); }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 81 "clex.y"
+#line 94 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 82 "clex.y"
+#line 95 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 83 "clex.y"
+#line 96 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_C, yyscanner); }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 84 "clex.y"
+#line 97 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 85 "clex.y"
+#line 98 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 86 "clex.y"
+#line 99 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 87 "clex.y"
+#line 100 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 88 "clex.y"
+#line 101 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 89 "clex.y"
+#line 102 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 90 "clex.y"
+#line 103 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 91 "clex.y"
+#line 104 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 92 "clex.y"
+#line 105 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_C, yyscanner); }
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 93 "clex.y"
+#line 106 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 94 "clex.y"
+#line 107 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 95 "clex.y"
+#line 108 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_B, yyscanner); }
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 96 "clex.y"
+#line 109 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_C, yyscanner); }
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 97 "clex.y"
+#line 110 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
-#line 99 "clex.y"
+#line 112 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 100 "clex.y"
+#line 113 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_A, yyscanner); }
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 102 "clex.y"
+#line 115 "clex.y"
 { emit_formatted_yytext(KEYWORD_GROUP_D, yyscanner); }
 	YY_BREAK
 case 43:
 YY_RULE_SETUP
-#line 104 "clex.y"
+#line 117 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 44:
 YY_RULE_SETUP
-#line 105 "clex.y"
+#line 118 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 45:
 YY_RULE_SETUP
-#line 106 "clex.y"
+#line 119 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 107 "clex.y"
+#line 120 "clex.y"
 { emit_formatted_yytext(STRING, yyscanner); }
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 109 "clex.y"
+#line 122 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 110 "clex.y"
+#line 123 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 49:
 YY_RULE_SETUP
-#line 111 "clex.y"
+#line 124 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 50:
 YY_RULE_SETUP
-#line 112 "clex.y"
+#line 125 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 51:
 YY_RULE_SETUP
-#line 113 "clex.y"
+#line 126 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 52:
 YY_RULE_SETUP
-#line 114 "clex.y"
+#line 127 "clex.y"
 { emit_formatted_yytext(NUMBER, yyscanner); }
 	YY_BREAK
 case 53:
 YY_RULE_SETUP
-#line 117 "clex.y"
+#line 130 "clex.y"
 { emit_formatted_yytext(STRING, yyscanner); }
 	YY_BREAK
 case 54:
 YY_RULE_SETUP
-#line 119 "clex.y"
+#line 132 "clex.y"
 { preprocessor(yyscanner); }
 	YY_BREAK
 case 55:
 YY_RULE_SETUP
-#line 121 "clex.y"
+#line 134 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 56:
 YY_RULE_SETUP
-#line 122 "clex.y"
+#line 135 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 57:
 YY_RULE_SETUP
-#line 123 "clex.y"
+#line 136 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 58:
 YY_RULE_SETUP
-#line 124 "clex.y"
+#line 137 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 59:
 YY_RULE_SETUP
-#line 125 "clex.y"
+#line 138 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 60:
 YY_RULE_SETUP
-#line 126 "clex.y"
+#line 139 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 61:
 YY_RULE_SETUP
-#line 127 "clex.y"
+#line 140 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
-#line 128 "clex.y"
+#line 141 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 129 "clex.y"
+#line 142 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 64:
 YY_RULE_SETUP
-#line 130 "clex.y"
+#line 143 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 65:
 YY_RULE_SETUP
-#line 131 "clex.y"
+#line 144 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 66:
 YY_RULE_SETUP
-#line 132 "clex.y"
+#line 145 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 67:
 YY_RULE_SETUP
-#line 133 "clex.y"
+#line 146 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 68:
 YY_RULE_SETUP
-#line 134 "clex.y"
+#line 147 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 69:
 YY_RULE_SETUP
-#line 135 "clex.y"
+#line 148 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 70:
 YY_RULE_SETUP
-#line 136 "clex.y"
+#line 149 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 71:
 YY_RULE_SETUP
-#line 137 "clex.y"
+#line 150 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 72:
 YY_RULE_SETUP
-#line 138 "clex.y"
+#line 151 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 73:
 YY_RULE_SETUP
-#line 139 "clex.y"
+#line 152 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 74:
 YY_RULE_SETUP
-#line 140 "clex.y"
+#line 153 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 75:
 YY_RULE_SETUP
-#line 141 "clex.y"
+#line 154 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 76:
 YY_RULE_SETUP
-#line 142 "clex.y"
+#line 155 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 77:
 YY_RULE_SETUP
-#line 143 "clex.y"
+#line 156 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 78:
 YY_RULE_SETUP
-#line 144 "clex.y"
+#line 157 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 79:
 YY_RULE_SETUP
-#line 145 "clex.y"
+#line 158 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 80:
 YY_RULE_SETUP
-#line 146 "clex.y"
+#line 159 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 81:
 YY_RULE_SETUP
-#line 147 "clex.y"
+#line 160 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 82:
 YY_RULE_SETUP
-#line 148 "clex.y"
+#line 161 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 83:
 YY_RULE_SETUP
-#line 149 "clex.y"
+#line 162 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 84:
 YY_RULE_SETUP
-#line 150 "clex.y"
+#line 163 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 85:
 YY_RULE_SETUP
-#line 151 "clex.y"
+#line 164 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 86:
 YY_RULE_SETUP
-#line 152 "clex.y"
+#line 165 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 87:
 YY_RULE_SETUP
-#line 153 "clex.y"
+#line 166 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 88:
 YY_RULE_SETUP
-#line 154 "clex.y"
+#line 167 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 89:
 YY_RULE_SETUP
-#line 155 "clex.y"
+#line 168 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 90:
 YY_RULE_SETUP
-#line 156 "clex.y"
+#line 169 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 91:
 YY_RULE_SETUP
-#line 157 "clex.y"
+#line 170 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 92:
 YY_RULE_SETUP
-#line 158 "clex.y"
+#line 171 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 93:
 YY_RULE_SETUP
-#line 159 "clex.y"
+#line 172 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 94:
 YY_RULE_SETUP
-#line 160 "clex.y"
+#line 173 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 95:
 YY_RULE_SETUP
-#line 161 "clex.y"
+#line 174 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 96:
 YY_RULE_SETUP
-#line 162 "clex.y"
+#line 175 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 97:
 YY_RULE_SETUP
-#line 163 "clex.y"
+#line 176 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 98:
 YY_RULE_SETUP
-#line 164 "clex.y"
+#line 177 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 99:
 YY_RULE_SETUP
-#line 165 "clex.y"
+#line 178 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 100:
 YY_RULE_SETUP
-#line 166 "clex.y"
+#line 179 "clex.y"
 { emit_formatted_yytext(PUNCTUATION, yyscanner); }
 	YY_BREAK
 case 101:
 /* rule 101 can match eol */
 YY_RULE_SETUP
-#line 168 "clex.y"
-{ emit(* yytext, yyscanner); }
+#line 181 "clex.y"
+{ skip_yytext(yyscanner); }
 	YY_BREAK
 case 102:
 YY_RULE_SETUP
-#line 169 "clex.y"
-{ emit(* yytext, yyscanner); }
+#line 182 "clex.y"
+{ skip_yytext(yyscanner); }
 	YY_BREAK
 case 103:
 YY_RULE_SETUP
 #line 171 "clex.y"
 ECHO;
 	YY_BREAK
-#line 1543 "cscanner.cxx"
+#line 1533 "cscanner.cxx"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -2709,73 +2699,25 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 171 "clex.y"
-
+#line 184 "clex.y"
 
-static void emit(int c, yyscan_t yyscanner)
+static void emit_token(enum FORMAT_TYPE_ENUM format, int offset, int length, yyscan_t yyscanner)
 {
-	yyget_extra(yyscanner)->operator+=(c);
+	/* Empty comment and preprocessor lines are not reported. */
+	if (length)
+		yyget_extra(yyscanner)->tokens.push_back(Token { offset, length, format });
 }
 
-static void emit_raw_string(const char * s, yyscan_t yyscanner)
-{
-	while (* s)
-		emit(* s ++, yyscanner);
-}
-
-
-static void emit_escaped(int c, yyscan_t yyscanner)
-{
-	switch (c)
-	{
-		default: emit(c, yyscanner); break;
-		case '<': emit_raw_string("&lt;", yyscanner); break;
-		case '>': emit_raw_string("&gt;", yyscanner); break;
-		case '&': emit_raw_string("&amp;", yyscanner); break;
-	}
-}
-
-static void emit_format_begin(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner)
-{
-static const char * format_strings[FORMAT_TYPES_COUNT] = {
-	[FORMAT_TYPE_ENUM::INVALID] =			"inv",
-	[FORMAT_TYPE_ENUM::COMMENT] =			"com",
-	[FORMAT_TYPE_ENUM::SINGLE_LINE_COMMENT] =	"slc",
-	[FORMAT_TYPE_ENUM::PREPROCESSOR_START] =	"pps",
-	[FORMAT_TYPE_ENUM::PREPROCESSOR] =		"ppc",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_A] =		"kwa",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_B] =		"kwb",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_C] =		"kwc",
-	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_D] =		"kwd",
-	[FORMAT_TYPE_ENUM::PUNCTUATION] =		"opt",
-	[FORMAT_TYPE_ENUM::NUMBER] =			"num",
-	[FORMAT_TYPE_ENUM::STRING] =			"str",
-};
-	if (format < 0 || format >= FORMAT_TYPES_COUNT)
-		format = FORMAT_TYPE_ENUM::INVALID;
-
-	emit_raw_string("<span class=\"hl ", yyscanner);
-	emit_raw_string(format_strings[format], yyscanner);
-	emit_raw_string("\">", yyscanner);
-}
-
-static void emit_format_end(yyscan_t yyscanner)
+static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner)
 {
-	emit_raw_string("</span>", yyscanner);
+	ScannerState * state = yyget_extra(yyscanner);
+	emit_token(format, state->offset, yyget_leng(yyscanner), yyscanner);
+	state->offset += yyget_leng(yyscanner);
 }
 
-static void emit_yytext(yyscan_t yyscanner)
+static void skip_yytext(yyscan_t yyscanner)
 {
-	const char * p = yyget_text(yyscanner);
-	while (* p)
-		emit_escaped(* p ++, yyscanner);
-}
-
-static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscanner)
-{
-	emit_format_begin(format, yyscanner);
-	emit_yytext(yyscanner);
-	emit_format_end(yyscanner);
+	yyget_extra(yyscanner)->offset += yyget_leng(yyscanner);
 }
 
 /*! !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -2785,59 +2727,106 @@ static void emit_formatted_yytext(enum FORMAT_TYPE_ENUM format, yyscan_t yyscann
 static void comment(yyscan_t yyscanner)
 {
 	char c, prev = 0;
-	emit_format_begin(FORMAT_TYPE_ENUM::COMMENT, yyscanner);
-	emit_yytext(yyscanner);
-  
+	ScannerState * state = yyget_extra(yyscanner);
+	int start = state->offset;
+	state->offset += yyget_leng(yyscanner);
+
 	while ((c = yyinput(yyscanner)) != 0)      /* (EOF maps to 0) */
 	{
+		state->offset ++;
 		if (c == '/' && prev == '*')
 		{
-			emit_escaped(c, yyscanner);
-			emit_format_end(yyscanner);
+			emit_token(FORMAT_TYPE_ENUM::COMMENT, start, state->offset - start, yyscanner);
 			return;
 		}
 		if (c == '\n')
 		{
-			emit_format_end(yyscanner);
-			emit_escaped(c, yyscanner);
-			emit_format_begin(FORMAT_TYPE_ENUM::COMMENT, yyscanner);
+			emit_token(FORMAT_TYPE_ENUM::COMMENT, start, state->offset - 1 - start, yyscanner);
+			start = state->offset;
 		}
-		else
-			emit_escaped(c, yyscanner);
 		prev = c;
 	}
-	emit_raw_string("unterminated comment", yyscanner);
-	emit_format_end(yyscanner);
+	/* Unterminated comment. */
+	emit_token(FORMAT_TYPE_ENUM::COMMENT, start, state->offset - start, yyscanner);
 }
 
 /*! \todo This is broken for dos line endings (<CR><LF>). */
 static void preprocessor(yyscan_t yyscanner)
 {
 	char c, prev = 0;
-	emit_format_begin(FORMAT_TYPE_ENUM::PREPROCESSOR_START, yyscanner);
-	emit_yytext(yyscanner);
-	emit_format_end(yyscanner);
-	emit_format_begin(FORMAT_TYPE_ENUM::PREPROCESSOR, yyscanner);
-  
+	ScannerState * state = yyget_extra(yyscanner);
+	emit_formatted_yytext(FORMAT_TYPE_ENUM::PREPROCESSOR_START, yyscanner);
+	int start = state->offset;
+
 	while ((c = yyinput(yyscanner)) != 0)      /* (EOF maps to 0) */
 	{
-		if (c == '\n' && prev == '\\')
-		{
-			emit_format_end(yyscanner);
-			emit(c, yyscanner);
-			emit_format_begin(FORMAT_TYPE_ENUM::PREPROCESSOR, yyscanner);
-		}
-		else if (c == '\n')
+		state->offset ++;
+		if (c == '\n')
 		{
-			emit_format_end(yyscanner);
-			emit_escaped(c, yyscanner);
-			return;
+			emit_token(FORMAT_TYPE_ENUM::PREPROCESSOR, start, state->offset - 1 - start, yyscanner);
+			if (prev != '\\')
+				return;
+			start = state->offset;
 		}
-		else
-			emit_escaped(c, yyscanner);
 		prev = c;
 	}
-	emit_format_end(yyscanner);
+	emit_token(FORMAT_TYPE_ENUM::PREPROCESSOR, start, state->offset - start, yyscanner);
+}
+
+std::vector<Token> clex::scan_tokens(const char * source)
+{
+	yyscan_t scanner;
+	ScannerState state;
+	yylex_init_extra(& state, &scanner);
+
+	yy_scan_string(source, scanner);
+	yylex(scanner);
+	yylex_destroy(scanner);
+	return std::move(state.tokens);
+}
+
+std::string clex::format_html(const char * source, const std::vector<Token> & tokens)
+{
+static const char * format_strings[FORMAT_TYPES_COUNT] = {
+	[FORMAT_TYPE_ENUM::INVALID] =			"inv",
+	[FORMAT_TYPE_ENUM::COMMENT] =			"com",
+	[FORMAT_TYPE_ENUM::SINGLE_LINE_COMMENT] =	"slc",
+	[FORMAT_TYPE_ENUM::PREPROCESSOR_START] =	"pps",
+	[FORMAT_TYPE_ENUM::PREPROCESSOR] =		"ppc",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_A] =		"kwa",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_B] =		"kwb",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_C] =		"kwc",
+	[FORMAT_TYPE_ENUM::KEYWORD_GROUP_D] =		"kwd",
+	[FORMAT_TYPE_ENUM::PUNCTUATION] =		"opt",
+	[FORMAT_TYPE_ENUM::NUMBER] =			"num",
+	[FORMAT_TYPE_ENUM::STRING] =			"str",
+};
+	std::string html;
+	int offset = 0, length = strlen(source);
+	html.reserve(length + length / 2);
+
+	auto emit_escaped = [&] (int end) -> void
+	{
+		for (; offset < end; offset ++)
+			switch (source[offset])
+			{
+				default: html += source[offset]; break;
+				case '<': html += "&lt;"; break;
+				case '>': html += "&gt;"; break;
+				case '&': html += "&amp;"; break;
+			}
+	};
+	for (const auto & token : tokens)
+	{
+		emit_escaped(token.offset);
+		html += "<span class=\"hl ";
+		html += format_strings[(token.format < 0 || token.format >= FORMAT_TYPES_COUNT) ? FORMAT_TYPE_ENUM::INVALID : token.format];
+		html += "\">";
+		emit_escaped(token.offset + token.length);
+		html += "</span>";
+	}
+	emit_escaped(length);
+	return html;
 }
 
 
@@ -2884,18 +2873,11 @@ FILE * infile;
 	fread(test_string, 1, MAX_SCANNED_SOURCE_CODE_FILE_SIZE, infile);
 	fclose(infile);
 
-	yyscan_t scanner;
-	std::string s;
-	yylex_init_extra(& s, &scanner);
-
-	s = html_header;
-	yy_scan_string(test_string, scanner);
-	yylex(scanner);
-	yylex_destroy(scanner);
+	std::string s = html_header;
+	s += format_html(test_string, scan_tokens(test_string));
 	s += html_footer;
 	printf("%s", s.c_str());
 	return 0;
 }
 #endif
 
-
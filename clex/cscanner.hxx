@@ -234,7 +234,7 @@ void yyfree ( void * , yyscan_t yyscanner );
 #include <unistd.h>
 #endif
 
-#define YY_EXTRA_TYPE std::string *
+#define YY_EXTRA_TYPE clex::ScannerState *
 
 int yylex_init (yyscan_t* scanner);
 
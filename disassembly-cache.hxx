@@ -57,7 +57,7 @@ public:
 	};
 private:
 	std::unordered_map<uint64_t /* address */, int /* textLineNumber */> disassemblyLines;
-	std::unordered_map<QString /* fileName */, std::unordered_map<int /* lineNumber */, std::unordered_set<int /* textLineNumber */>>> sourceLines;
+	std::unordered_map<FileId, std::unordered_map<int /* lineNumber */, std::unordered_set<int /* textLineNumber */>>> sourceLines;
 
 	QTextCharFormat enabledBreakpointFormat;
 	QTextCharFormat disabledBreakpointFormat;
@@ -141,7 +141,7 @@ public:
 						auto sourceData = sourceFilesCache.getSourceFileCacheData(fullFileName, errorMessage);
 						QString backgroundColor = "Azure";
 
-						sourceLines.operator [](fullFileName).operator [](lineNumber).insert(currentLine);
+						sourceLines.operator [](PathTable::global().fileId(fullFileName)).operator [](lineNumber).insert(currentLine);
 						if (sourceData && lineNumber - 1 < sourceData->sourceCodeTextlines.length())
 						{
 							htmlDocument += QString("<p style=\"background-color:%1;\"><pre>%2: %3</pre></p>")
@@ -186,7 +186,7 @@ public:
 
 		std::function<void(const GdbBreakpointData & /* breakpoint */)> processBreakpoint = [&] (const GdbBreakpointData & breakpoint) -> void
 		{
-			const auto s = sourceLines.find(breakpoint.sourceCodeLocation.fullFileName);
+			const auto s = sourceLines.find(breakpoint.sourceCodeLocation.fileId());
 			if (s != sourceLines.cend())
 			{
 				const auto lines = s->second.find(breakpoint.sourceCodeLocation.lineNumber);
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <QString>
+#include <QHash>
+#include <QDir>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+/* A compact integer id for a file path. File ids are used as keys in the data structures that are
+ * indexed by source code file names, so that file names are hashed and compared only once, when the
+ * file ids for them are looked up. */
+typedef uint32_t FileId;
+
+/* A process-wide table of file paths. Each file path is assigned a file id when it is first seen.
+ * Paths are normalized only when first seen, and different spellings of the same path (e.g., with
+ * redundant separators, or with '.' and '..' components) are assigned the same file id.
+ *
+ * File id 0 is always the empty path. File ids are never reused, and remain valid for the lifetime
+ * of the program.
+ *
+ * This class is thread safe. */
+class PathTable
+{
+private:
+	mutable QReadWriteLock lock;
+	/* File ids for all path spellings seen. */
+	QHash<QString /* path */, FileId> ids;
+	/* File ids for normalized paths. */
+	QHash<QString /* normalized path */, FileId> normalizedIds;
+	/* The first seen spelling of each path, indexed by file id. */
+	std::vector<QString> paths;
+
+	PathTable(void) { paths.push_back(QString()); ids.insert(QString(), 0); normalizedIds.insert(QString(), 0); }
+	static QString normalize(const QString & path) { return path.isEmpty() ? path : QDir::cleanPath(QDir::fromNativeSeparators(path)); }
+public:
+	static PathTable & global(void) { static PathTable table; return table; }
+
+	FileId fileId(const QString & path)
+	{
+		{
+			QReadLocker locker(& lock);
+			auto i = ids.constFind(path);
+			if (i != ids.cend())
+				return i.value();
+		}
+		QString normalizedPath = normalize(path);
+		QWriteLocker locker(& lock);
+		auto i = ids.constFind(path);
+		if (i != ids.cend())
+			return i.value();
+		FileId id;
+		auto n = normalizedIds.constFind(normalizedPath);
+		if (n != normalizedIds.cend())
+			id = n.value();
+		else
+		{
+			id = paths.size();
+			paths.push_back(path);
+			normalizedIds.insert(normalizedPath, id);
+		}
+		ids.insert(path, id);
+		return id;
+	}
+	/* Returns the path, as it was first seen, for a file id. */
+	QString path(FileId fileId) const { QReadLocker locker(& lock); return paths.at(fileId); }
+};
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QString>
+#include <QRegularExpression>
+
+/* Helpers for values of expressions, as printed by gdb. */
+class GdbValue
+{
+public:
+	/* Returns true, if a value printed by gdb contains a string or an array that gdb has truncated,
+	 * because it has reached the limit of printed elements ('set print elements'). 'repeatThreshold'
+	 * is the gdb 'set print repeats' setting. */
+	static bool isTruncated(const QString & value, int maxElements, int repeatThreshold)
+	{
+		/* Gdb appends an ellipsis to strings and arrays that it has truncated, after printing 'maxElements'
+		 * elements of them. Runs of repeated elements, printed as '<repeats N times>', are counted as
+		 * 'repeatThreshold' elements. An ellipsis is only considered a truncation mark if it is outside of
+		 * string and character literals, it immediately follows a part of a string, or closes an array, and at
+		 * least 'maxElements' elements precede it. Gdb also prints '{...}' for aggregates nested too deeply,
+		 * and '...' in the signatures of variadic functions, these are not truncation marks. */
+		static const QRegularExpression repeats(" ?<repeats \\d+ times>");
+		/* The number of elements printed for each array being parsed, the last entry is for the innermost array. */
+		std::vector<int> arrayElements;
+		/* The number of characters in the string being parsed. Strings may be printed as several parts,
+		 * e.g. "abc", 'x' <repeats 20 times>, "def". */
+		int stringCharacters = 0;
+		bool isStringPart = false;
+		int i = 0;
+		auto skipLiteral = [&] (QChar quote) -> int
+		{
+			int characters = 0;
+			for (i ++; i < value.length() && value.at(i) != quote; i ++, characters ++)
+				if (value.at(i) == '\\')
+				{
+					/* Octal escape sequences are printed for unprintable characters. */
+					if (++ i < value.length() && value.at(i).isDigit())
+						while (i + 1 < value.length() && value.at(i + 1).isDigit())
+							i ++;
+				}
+			i ++;
+			return characters;
+		};
+		auto isRepeatBlock = [&] (void) -> bool
+		{
+			QRegularExpressionMatch match = repeats.match(value, i, QRegularExpression::NormalMatch, QRegularExpression::AnchoredMatchOption);
+			if (match.hasMatch())
+				i += match.capturedLength();
+			return match.hasMatch();
+		};
+		while (i < value.length())
+		{
+			QChar c = value.at(i);
+			if (c == '"' || c == '\'')
+			{
+				int characters = skipLiteral(c);
+				bool isRepeated = isRepeatBlock();
+				if (c == '"' || isRepeated)
+				{
+					stringCharacters = (isStringPart ? stringCharacters : 0) + (isRepeated ? repeatThreshold : characters);
+					isStringPart = true;
+				}
+				else
+					isStringPart = false;
+				if (!arrayElements.empty() && isRepeated)
+					arrayElements.back() += repeatThreshold - 1;
+				if (isStringPart && value.midRef(i, 3) == "..." && stringCharacters >= maxElements)
+					return true;
+				continue;
+			}
+			if (value.midRef(i, 3) == "...")
+			{
+				if (value.midRef(i + 3, 1) == "}" && !arrayElements.empty() && arrayElements.back() + 1 >= maxElements && value.midRef(i - 1, 1) != "{")
+					return true;
+				i += 3;
+				continue;
+			}
+			if (c == '{')
+				arrayElements.push_back(0);
+			else if (c == '}' && !arrayElements.empty())
+				arrayElements.pop_back();
+			else if (c == ',' && !arrayElements.empty())
+				arrayElements.back() ++;
+			else if (c == '<' && isRepeatBlock())
+			{
+				if (!arrayElements.empty())
+					arrayElements.back() += repeatThreshold - 1;
+				continue;
+			}
+			if (c != ',' && c != ' ')
+				isStringPart = false;
+			i ++;
+		}
+		return false;
+	}
+};
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <ctype.h>
+#include <algorithm>
+
+#include "identifier-index.hxx"
+
+std::vector<std::pair<std::string, IdentifierIndex::Occurrence>> IdentifierIndex::findOccurrences(const QByteArray & sourceCode, const std::vector<clex::Token> & tokens)
+{
+	std::vector<std::pair<std::string, Occurrence>> occurrences;
+	const char * source = sourceCode.constData();
+	/* The line number, and the offset of the start of the line, of the last token processed. */
+	int lineNumber = 1, lineOffset = 0, offset = 0;
+	bool isIncludeDirective = false;
+
+	/* Splits the text of a comment, string literal, or preprocessor directive token into words.
+	 * Words starting with a digit are skipped. */
+	auto addWords = [&] (const clex::Token & token, enum OCCURRENCE_KIND kind) -> void
+	{
+		int i = token.offset, end = token.offset + token.length;
+		while (i < end)
+		{
+			if (!isalnum((unsigned char) source[i]) && source[i] != '_')
+			{
+				i ++;
+				continue;
+			}
+			int start = i;
+			while (i < end && (isalnum((unsigned char) source[i]) || source[i] == '_'))
+				i ++;
+			if (!isdigit((unsigned char) source[start]))
+				occurrences.push_back(std::pair<std::string, Occurrence>(std::string(source + start, i - start),
+											 Occurrence(-1, lineNumber, start - lineOffset, kind)));
+		}
+	};
+
+	for (const auto & token : tokens)
+	{
+		if (token.offset + token.length > sourceCode.size())
+			break;
+		/* Tokens do not span multiple lines, so only the lines before the token need to be counted. */
+		for (; offset < token.offset; offset ++)
+			if (source[offset] == '\n')
+				lineNumber ++, lineOffset = offset + 1;
+		switch (token.format)
+		{
+		case clex::KEYWORD_GROUP_D:
+			occurrences.push_back(std::pair<std::string, Occurrence>(std::string(source + token.offset, token.length),
+										 Occurrence(-1, lineNumber, token.offset - lineOffset, CODE)));
+			break;
+		case clex::COMMENT:
+		case clex::SINGLE_LINE_COMMENT:
+			addWords(token, COMMENT);
+			break;
+		case clex::STRING:
+			addWords(token, STRING);
+			break;
+		case clex::PREPROCESSOR_START:
+			isIncludeDirective = !std::string(source + token.offset, token.length).compare(0, 8, "#include");
+			break;
+		case clex::PREPROCESSOR:
+			addWords(token, isIncludeDirective ? STRING : CODE);
+			break;
+		default:
+			break;
+		}
+	}
+	return occurrences;
+}
+
+void IdentifierIndex::indexFile(int fileId, const QByteArray & sourceCode, const std::vector<clex::Token> & tokens)
+{
+	removeFile(fileId);
+	std::vector<std::string> & identifiers = fileIdentifiers[fileId];
+	for (const auto & occurrence : findOccurrences(sourceCode, tokens))
+	{
+		std::vector<Occurrence> & t = index[occurrence.first];
+		if (t.empty() || t.back().fileId != fileId)
+			identifiers.push_back(occurrence.first);
+		t.push_back(occurrence.second);
+		t.back().fileId = fileId;
+	}
+}
+
+void IdentifierIndex::removeFile(int fileId)
+{
+	auto f = fileIdentifiers.find(fileId);
+	if (f == fileIdentifiers.end())
+		return;
+	for (const auto & identifier : f->second)
+	{
+		auto i = index.find(identifier);
+		if (i == index.end())
+			continue;
+		i->second.erase(std::remove_if(i->second.begin(), i->second.end(), [=] (const Occurrence & o) -> bool { return o.fileId == fileId; }), i->second.end());
+		if (i->second.empty())
+			index.erase(i);
+	}
+	fileIdentifiers.erase(f);
+}
+
+std::vector<IdentifierIndex::Occurrence> IdentifierIndex::occurrences(const std::string & identifier, bool codeOccurrencesOnly) const
+{
+	std::vector<Occurrence> result;
+	auto i = index.find(identifier);
+	if (i != index.cend())
+		for (const auto & o : i->second)
+			if (!codeOccurrencesOnly || o.kind == CODE)
+				result.push_back(o);
+	return result;
+}
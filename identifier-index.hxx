@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <QByteArray>
+
+#include "clex.hxx"
+
+/* An index of the occurrences of identifiers in a set of source code files. The occurrences are found in
+ * the tokens reported by the 'clex' scanner, the same tokens that are used for syntax highlighting of the
+ * source code view, so that identifiers are recognized exactly as they are highlighted. For each occurrence,
+ * it is recorded whether the identifier occurs in code, or inside a comment or a string literal.
+ * Identifiers inside comments and string literals are only found by splitting the comment and
+ * string literal text into words.
+ *
+ * Files are referred to by numeric ids, which are supplied by the users of this class. */
+class IdentifierIndex
+{
+public:
+	enum OCCURRENCE_KIND
+	{
+		CODE		= 0,
+		COMMENT,
+		STRING,
+	};
+	struct Occurrence
+	{
+		int		fileId;
+		int		lineNumber;
+		/* Zero-based byte offset of the identifier in its line. */
+		int		column;
+		uint8_t		kind;
+		Occurrence(int fileId, int lineNumber, int column, enum OCCURRENCE_KIND kind) :
+			fileId(fileId), lineNumber(lineNumber), column(column), kind(kind) {}
+	};
+	/* Returns all identifier occurrences in a source code file, given the tokens scanned from the file.
+	 * The file id of the occurrences returned is always -1. */
+	static std::vector<std::pair<std::string /* identifier */, Occurrence>> findOccurrences(const QByteArray & sourceCode, const std::vector<clex::Token> & tokens);
+
+	void indexFile(int fileId, const QByteArray & sourceCode, const std::vector<clex::Token> & tokens);
+	void removeFile(int fileId);
+	/* Returns all known occurrences of an identifier, optionally skipping occurrences in comments and strings. */
+	std::vector<Occurrence> occurrences(const std::string & identifier, bool codeOccurrencesOnly) const;
+private:
+	std::unordered_map<std::string /* identifier */, std::vector<Occurrence>> index;
+	/* The distinct identifiers that occur in each file, used when removing files from the index. */
+	std::unordered_map<int /* file id */, std::vector<std::string>> fileIdentifiers;
+};
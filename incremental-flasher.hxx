@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <elfio/elfio.hpp>
+
+#include "target.hxx"
+#include "gdb-remote.hxx"
+#include "target-memory-verifier.hxx"
+
+/* Programs only the target flash sectors, whose contents differ from the loadable segments of an ELF file.
+ *
+ * Programming a whole executable into the target flash is slow, but usually, in the edit-debug cycle, only a
+ * few flash sectors change between successive builds. The incremental flasher:
+ *	- reads the target memory map, to find out the flash sector layout
+ *	- computes the expected contents of each flash sector, that is touched by the ELF file; the bytes not
+ *	  covered by the ELF file are assumed to be erased
+ *	- compares the CRC32 checksums of the expected sector contents against the checksums computed on the target
+ *	  side (by the remote protocol 'qCRC' packet)
+ *	- erases and programs only the sectors, whose checksums differ
+ *
+ * This class does not communicate with the target. Instead, it produces the remote protocol request packets to be
+ * sent to the target for each step, and consumes the replies to these packets. */
+class IncrementalFlasher
+{
+public:
+	enum STATE
+	{
+		IDLE = 0,
+		READING_MEMORY_MAP,
+		COMPARING_SECTORS,
+		PROGRAMMING_SECTORS,
+		DONE,
+		FAILED,
+	};
+	enum
+	{
+		MEMORY_MAP_CHUNK_SIZE	= 0x400,
+		ERASED_FLASH_BYTE	= 0xff,
+	};
+	struct Sector
+	{
+		uint32_t	address;
+		QByteArray	data;
+		bool		isChanged = true;
+		Sector(uint32_t address, const QByteArray & data) : address(address), data(data) {}
+	};
+private:
+	enum STATE currentState = IDLE;
+	QString lastError;
+	QByteArray memoryMapXml;
+	TargetMemoryAreas memoryAreas;
+	std::vector<std::pair<uint32_t /* load address */, QByteArray /* data */>> segments;
+	std::vector<struct Sector> sectors;
+	int programmingPacketCount = 0;
+
+	QVector<QByteArray> fail(const QString & error) { currentState = FAILED; lastError = error; return QVector<QByteArray>(); }
+	/* Splits the loadable segments in flash sectors. Returns false if some of the segments is not entirely in flash memory. */
+	bool buildSectors(void)
+	{
+		sectors.clear();
+		std::vector<std::pair<uint32_t, uint32_t>> ranges;
+		for (const auto & s : segments)
+		{
+			auto r = memoryAreas.flashAreasForRange(s.first, s.second.length());
+			if (r.empty())
+				return false;
+			ranges.insert(ranges.end(), r.cbegin(), r.cend());
+		}
+		/* Collect the sectors touched by all segments, in ascending address order, without duplicates. */
+		std::vector<uint32_t> sectorAddresses;
+		for (const auto & r : ranges)
+		{
+			unsigned blocksize = memoryAreas.flashBlockSize(r.first);
+			if (!blocksize)
+				return false;
+			for (uint32_t offset = 0; offset < r.second; offset += blocksize)
+				sectorAddresses.push_back(r.first + offset);
+		}
+		std::sort(sectorAddresses.begin(), sectorAddresses.end());
+		sectorAddresses.erase(std::unique(sectorAddresses.begin(), sectorAddresses.end()), sectorAddresses.end());
+		for (const auto & address : sectorAddresses)
+		{
+			QByteArray data(memoryAreas.flashBlockSize(address), (char) ERASED_FLASH_BYTE);
+			for (const auto & s : segments)
+			{
+				uint32_t start = std::max(address, s.first), end = std::min(address + data.length(), s.first + s.second.length());
+				if (start < end)
+					data.replace(start - address, end - start, s.second.constData() + (start - s.first), end - start);
+			}
+			sectors.push_back(Sector(address, data));
+		}
+		return true;
+	}
+public:
+	enum STATE state(void) const { return currentState; }
+	const QString & errorString(void) const { return lastError; }
+	bool isActive(void) const { return currentState != IDLE && currentState != DONE && currentState != FAILED; }
+	int sectorCount(void) const { return sectors.size(); }
+	int changedSectorCount(void) const
+	{ return std::count_if(sectors.cbegin(), sectors.cend(), [] (const struct Sector & s) { return s.isChanged; }); }
+	int changedByteCount(void) const
+	{ int n = 0; for (const auto & s : sectors) if (s.isChanged) n += s.data.length(); return n; }
+
+	/* Starts incremental flashing, and returns the request packets for the first step. */
+	QVector<QByteArray> start(const ELFIO::elfio & elf)
+	{
+		segments.clear();
+		sectors.clear();
+		memoryMapXml.clear();
+		lastError.clear();
+		for (const auto & segment : elf.segments)
+			if (segment->get_type() == PT_LOAD && segment->get_file_size())
+				segments.push_back(std::make_pair((uint32_t) segment->get_physical_address(),
+								  QByteArray(segment->get_data(), segment->get_file_size())));
+		if (segments.empty())
+			return fail("The ELF file contains no loadable segments");
+		currentState = READING_MEMORY_MAP;
+		return QVector<QByteArray>() << GdbRemote::memoryMapReadRequest(0, MEMORY_MAP_CHUNK_SIZE);
+	}
+	void cancel(void) { currentState = IDLE; }
+	/* Processes the replies to the request packets of the current step. Returns the request packets for the
+	 * next step. If an empty packet vector is returned, incremental flashing is either done, or has failed. */
+	QVector<QByteArray> repliesReceived(const QVector<QByteArray> & replies)
+	{
+		QVector<QByteArray> packets;
+		switch (currentState)
+		{
+		case READING_MEMORY_MAP:
+		{
+			QByteArray data;
+			if (replies.size() != 1 || (data = GdbRemote::packetData(replies.at(0))).isEmpty() || (data.at(0) != 'm' && data.at(0) != 'l'))
+				return fail("Failed to read the target memory map");
+			memoryMapXml += data.mid(1);
+			if (data.at(0) == 'm')
+				return packets << GdbRemote::memoryMapReadRequest(memoryMapXml.length(), MEMORY_MAP_CHUNK_SIZE);
+			memoryAreas.parseMemoryAreas(QString::fromUtf8(memoryMapXml));
+			if (!buildSectors())
+				return fail("Some of the loadable segments of the ELF file are not in flash memory");
+			for (const auto & s : sectors)
+				packets << GdbRemote::crcRequest(s.address, s.data.length());
+			currentState = COMPARING_SECTORS;
+			return packets;
+		}
+		case COMPARING_SECTORS:
+			if (replies.size() != (int) sectors.size())
+				return fail("Failed to compute the target flash sector checksums");
+			for (int i = 0; i < (int) sectors.size(); i ++)
+			{
+				uint32_t crc;
+				/* If the checksum is not available, assume that the sector has changed. */
+				sectors.at(i).isChanged = !GdbRemote::crcReply(replies.at(i), crc)
+						|| crc != TargetMemoryVerifier::crc32(sectors.at(i).data.constData(), sectors.at(i).data.length());
+			}
+			/* Erase and program runs of adjacent changed sectors with single requests. */
+			for (int i = 0; i < (int) sectors.size();)
+			{
+				if (!sectors.at(i).isChanged)
+				{
+					i ++;
+					continue;
+				}
+				uint32_t address = sectors.at(i).address;
+				QByteArray data;
+				while (i < (int) sectors.size() && sectors.at(i).isChanged && sectors.at(i).address == address + data.length())
+					data += sectors.at(i ++).data;
+				packets << GdbRemote::eraseFlashMemoryRequest(address, data.length());
+				packets << GdbRemote::writeFlashMemoryRequest(address, data.length(), data);
+			}
+			programmingPacketCount = packets.size();
+			currentState = packets.isEmpty() ? DONE : PROGRAMMING_SECTORS;
+			return packets;
+		case PROGRAMMING_SECTORS:
+			if (replies.size() != programmingPacketCount)
+				return fail("Failed to program the target flash");
+			for (const auto & r : replies)
+				if (!GdbRemote::isOkResponse(r))
+					return fail("Failed to program the target flash");
+			currentState = DONE;
+			return packets;
+		default:
+			return packets;
+		}
+	}
+};
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory>
+#include <deque>
+#include <functional>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/* A job that is performed in small steps, so that it can be interleaved with the processing of other
+ * events in the main (gui) thread. This is used for applying large gdb responses (e.g., the lists of all
+ * symbols in a program) to the frontend data structures and views, without blocking the user interface. */
+struct IncrementalJob
+{
+	/* Jobs of the same kind are run one after another, in the order they were queued. Jobs of different kinds
+	 * are interleaved. */
+	QString kind;
+	/* A human readable description of the job, used for progress reporting. */
+	QString description;
+	/* Performs a small, bounded, amount of work. Returns true if there is more work to do, false if the job is complete. */
+	std::function<bool(void)> step;
+	/* Returns the progress of the job, as the number of work items done so far, and the total number of work items. */
+	std::function<std::pair<int /* done */, int /* total */>(void)> progress;
+	/* If set, this is called once, after the last step of the job, or when the user cancels the job before it
+	 * has completed, so that the work already done is finalized in both cases. This is not called for jobs that
+	 * are dropped because their results have become stale. */
+	std::function<void(void)> finish;
+
+	IncrementalJob(const QString & kind, const QString & description, std::function<bool(void)> step,
+		       std::function<std::pair<int, int>(void)> progress = [] { return std::pair<int, int>(0, 0); },
+		       std::function<void(void)> finish = std::function<void(void)>()) :
+		kind(kind), description(description), step(step), progress(progress), finish(finish) {}
+};
+
+/* Runs incremental jobs in time slices, in the main (gui) thread. In each turn of the event loop, steps of the
+ * queued jobs are performed until the time slice expires, and the rest of the work is postponed to the
+ * next turn of the event loop. */
+class IncrementalJobRunner : public QObject
+{
+	Q_OBJECT
+private:
+	const int TIME_SLICE_MS = 5;
+	QTimer timer;
+	/* Queues of jobs, by job kind. */
+	QHash<QString /* job kind */, std::deque<std::shared_ptr<IncrementalJob>>> queues;
+	/* The job kinds, in round-robin order. */
+	QStringList kinds;
+	int nextKind = 0;
+
+	void runTimeSlice(void)
+	{
+		QElapsedTimer t;
+		t.start();
+		while (!kinds.isEmpty() && t.elapsed() < TIME_SLICE_MS)
+		{
+			nextKind %= kinds.size();
+			QString kind = kinds.at(nextKind);
+			std::shared_ptr<IncrementalJob> job = queues[kind].front();
+			if (!job->step())
+			{
+				/* The job may have been cancelled while performing its last step. */
+				auto queue = queues.find(kind);
+				if (queue != queues.end() && !queue->empty() && queue->front() == job)
+				{
+					queue->pop_front();
+					if (job->finish)
+						job->finish();
+				}
+			}
+			removeEmptyQueues();
+			nextKind ++;
+		}
+		reportProgress();
+		if (kinds.isEmpty())
+		{
+			timer.stop();
+			emit idle();
+		}
+	}
+	void removeEmptyQueues(void)
+	{
+		for (int i = 0; i < kinds.size();)
+			if (queues[kinds.at(i)].empty())
+			{
+				queues.remove(kinds.at(i));
+				kinds.removeAt(i);
+				if (nextKind > i)
+					nextKind --;
+			}
+			else
+				i ++;
+	}
+	void reportProgress(void)
+	{
+		int done = 0, total = 0;
+		QString description;
+		for (const auto & kind : kinds)
+			for (const auto & job : queues[kind])
+			{
+				std::pair<int, int> p = job->progress();
+				done += p.first, total += p.second;
+				if (description.isEmpty())
+					description = job->description;
+			}
+		emit progressChanged(description, done, total);
+	}
+public:
+	IncrementalJobRunner(QObject * parent = 0) : QObject(parent)
+	{
+		timer.setInterval(0);
+		connect(& timer, & QTimer::timeout, this, & IncrementalJobRunner::runTimeSlice);
+	}
+	void enqueue(std::shared_ptr<IncrementalJob> job)
+	{
+		if (!queues.contains(job->kind))
+			kinds << job->kind;
+		queues[job->kind].push_back(job);
+		if (!timer.isActive())
+			timer.start();
+	}
+	/* Convenience function for queueing work that is done in a single step, after all previously queued
+	 * jobs of the same kind have completed. The work is done as the finishing of the job, so that it is
+	 * also done if the user cancels the jobs. */
+	void enqueue(const QString & kind, std::function<void(void)> work)
+	{
+		enqueue(std::make_shared<IncrementalJob>(kind, QString(), [] { return false; },
+							 [] { return std::pair<int, int>(0, 0); }, work));
+	}
+	bool hasJobs(const QString & kind) const { return queues.contains(kind); }
+	/* Drops the queued jobs of a kind, without finishing them. This is used when the results of the jobs have become stale. */
+	void cancel(const QString & kind)
+	{
+		queues.remove(kind);
+		int i = kinds.indexOf(kind);
+		if (i != -1)
+		{
+			kinds.removeAt(i);
+			if (nextKind > i)
+				nextKind --;
+		}
+	}
+	/* Cancels all queued jobs on user request. The remaining steps of the jobs are skipped, but the jobs are
+	 * finished, in the order they were queued for each job kind. */
+	void cancelAll(void)
+	{
+		QHash<QString, std::deque<std::shared_ptr<IncrementalJob>>> cancelledQueues;
+		QStringList cancelledKinds = kinds;
+		cancelledQueues.swap(queues);
+		kinds.clear();
+		nextKind = 0;
+		/* Finishing jobs may queue new jobs. */
+		for (const auto & kind : cancelledKinds)
+			for (const auto & job : cancelledQueues[kind])
+				if (job->finish)
+					job->finish();
+	}
+signals:
+	void progressChanged(const QString description, int done, int total);
+	/* Emitted when all queued jobs have completed. */
+	void idle(void);
+};
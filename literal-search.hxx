@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <string.h>
+#include <ctype.h>
+
+#include <QByteArray>
+
+/* The C runtime libraries of these systems provide 'memmem()', which is usually much faster than a naive scan.
+ * Elsewhere (e.g., on Windows), a scan that filters candidate positions on the first and last bytes
+ * of the searched string is used instead. */
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#define LITERAL_SEARCH_HAVE_MEMMEM	1
+#else
+#define LITERAL_SEARCH_HAVE_MEMMEM	0
+#endif
+
+/* Searches for a literal string directly over UTF-8 encoded text, without decoding it, and without
+ * splitting it into lines first. Line numbers are only computed for the matches found. */
+class LiteralSearch
+{
+public:
+	/* Returns true, if the byte passed can be part of a word, in the sense of the '\b' regular expression assertion.
+	 * Bytes of multibyte UTF-8 sequences are considered word characters. */
+	static bool isWordByte(unsigned char c) { return isalnum(c) || c == '_' || (c & 0x80); }
+
+	/* Returns the first occurrence of a string of a nonzero length in the range [p, end), or null if there is none.
+	 * Candidate positions are located with 'memchr()', which is vectorized in the C runtime libraries, and only
+	 * positions at which the last byte of the searched string also matches are compared in full, so that
+	 * common first bytes (such as '_', or a space in C sources) do not cause a full comparison at every occurrence. */
+	static const char * findByFirstAndLastBytes(const char * p, const char * end, const char * literal, int literalLength)
+	{
+		const char first = literal[0], last = literal[literalLength - 1];
+		const char * lastCandidate = end - literalLength;
+		while (p <= lastCandidate && (p = (const char *) memchr(p, first, lastCandidate - p + 1)))
+		{
+			if (p[literalLength - 1] == last && (literalLength <= 2 || !memcmp(p + 1, literal + 1, literalLength - 2)))
+				return p;
+			p ++;
+		}
+		return 0;
+	}
+	/* Same as above, using the fastest method available. */
+	static const char * find(const char * p, const char * end, const char * literal, int literalLength)
+	{
+#if LITERAL_SEARCH_HAVE_MEMMEM
+		return p < end ? (const char *) memmem(p, end - p, literal, literalLength) : 0;
+#else
+		return findByFirstAndLastBytes(p, end, literal, literalLength);
+#endif
+	}
+
+	/* Finds the lines of a text that contain a string of a nonzero length, and calls
+	 * 'lineFound(lineNumber, lineStart, lineEnd)' for each of them, in order. Line numbers start from 1,
+	 * and the line end excludes the line terminating newline. Lines are reported only once, regardless of
+	 * the number of matches in them. The search stops when the function called returns false.
+	 *
+	 * If 'isWholeWordsOnlySearch' is true, only matches that start and end at word boundaries, in the
+	 * sense of the '\b' regular expression assertion, are reported. */
+	template <typename F>
+	static void findLines(const QByteArray & contents, const QByteArray & literal, bool isWholeWordsOnlySearch, F lineFound,
+			      const char * (* find)(const char *, const char *, const char *, int) = LiteralSearch::find)
+	{
+		const char * data = contents.constData(), * end = data + contents.size(), * p = data, * lineStart = data;
+		const char * s = literal.constData();
+		int literalLength = literal.length(), lineNumber = 1;
+		while ((p = find(p, end, s, literalLength)))
+		{
+			if (isWholeWordsOnlySearch)
+			{
+				bool isWordBefore = p > data && isWordByte(p[-1]), isWordAfter = p + literalLength < end && isWordByte(p[literalLength]);
+				if (isWordBefore == isWordByte(s[0]) || isWordAfter == isWordByte(s[literalLength - 1]))
+				{
+					p ++;
+					continue;
+				}
+			}
+			/* Match confirmed - compute its line number, and report the line. */
+			for (const char * n; (n = (const char *) memchr(lineStart, '\n', p - lineStart)); lineStart = n + 1)
+				lineNumber ++;
+			const char * lineEnd = (const char *) memchr(p, '\n', end - p);
+			if (!lineEnd)
+				lineEnd = end;
+			if (!lineFound(lineNumber, lineStart, lineEnd) || lineEnd == end)
+				break;
+			/* Continue with the next line. */
+			p = lineStart = lineEnd + 1;
+			lineNumber ++;
+		}
+	}
+};
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/* A fixed capacity ring buffer of the sampled values of a live watch. When the buffer is full,
+ * the oldest samples are overwritten. */
+class LiveWatchSampleRing
+{
+public:
+	struct Sample
+	{
+		/* Milliseconds since sampling was started. */
+		qint64		timestamp = 0;
+		QByteArray	data;
+	};
+private:
+	std::vector<struct Sample> samples;
+	size_t head = 0, count = 0;
+public:
+	LiveWatchSampleRing(size_t capacity = 1024) : samples(capacity) {}
+	void push(qint64 timestamp, const QByteArray & data)
+	{
+		samples[head].timestamp = timestamp, samples[head].data = data;
+		head = (head + 1) % samples.size();
+		if (count < samples.size())
+			count ++;
+	}
+	size_t size(void) const { return count; }
+	/* Index 0 is the oldest sample in the buffer. */
+	const struct Sample & at(size_t index) const { return samples.at((head + samples.size() - count + index) % samples.size()); }
+	const struct Sample & latest(void) const { return at(count - 1); }
+	void clear(void) { head = count = 0; }
+};
+
+/* Periodically samples the values of target memory ranges ('live watches'), while the target is running.
+ *
+ * Each sampling round reads all watched ranges. To reduce the number of round trips to the target, which
+ * dominate the time needed for a sampling round, watched ranges that are close to each other are merged,
+ * and are read in a single contiguous target memory read. The reads are performed one at a time, and the
+ * sampled values are appended to the ring buffers of the watches.
+ *
+ * This class does not access the target memory itself. Instead, it emits signal 'readMemory()', and
+ * expects each read request to be completed by a call to 'memoryReadCompleted()'. This way, the same
+ * sampling engine can be used for reading the target memory through different means, e.g. through gdb
+ * when the target is halted, and by talking directly to a debug probe when the target is running. */
+class LiveWatchEngine : public QObject
+{
+	Q_OBJECT
+public:
+	struct Watch
+	{
+		int		id;
+		QString		expression;
+		/* The address and size of the watched object are known after the watch expression is evaluated. */
+		bool		isAddressKnown = false;
+		bool		isSizeKnown = false;
+		uint32_t	address = 0;
+		uint32_t	size = 0;
+		LiveWatchSampleRing samples;
+		Watch(int id, const QString & expression) : id(id), expression(expression) {}
+		bool isResolved(void) const { return isAddressKnown && isSizeKnown && size; }
+	};
+	/* A single contiguous target memory read, covering one or more watched ranges. */
+	struct MemoryRead
+	{
+		uint32_t	address;
+		uint32_t	length;
+		std::vector<int /* watch id */> watchIds;
+		MemoryRead(uint32_t address, uint32_t length, int watchId) : address(address), length(length), watchIds(1, watchId) {}
+	};
+	struct Statistics
+	{
+		/* The number of sampling rounds completed. */
+		unsigned	completedRounds = 0;
+		/* The number of sampling rounds skipped, because the previous sampling round was still running. */
+		unsigned	skippedRounds = 0;
+		unsigned	failedReads = 0;
+		/* The number of memory reads performed for a single sampling round. */
+		unsigned	readsPerRound = 0;
+	};
+
+	enum
+	{
+		/* Watched ranges that are at most this number of bytes apart are read together. Reading a few
+		 * unneeded bytes is much cheaper than an additional round trip to the target. */
+		MAX_COALESCING_GAP	= 64,
+		/* The maximum length of a single read, chosen so that a read reply fits in a single remote protocol
+		 * packet of the debug probes. This is also the maximum size of a watched object. */
+		MAX_READ_LENGTH		= 256,
+		DEFAULT_SAMPLE_RATE_HZ	= 10,
+	};
+
+	/* Merges the ranges passed into the minimum number of reads, such that ranges at most 'MAX_COALESCING_GAP'
+	 * bytes apart are read together, and no read is longer than 'MAX_READ_LENGTH' bytes. Each range passed must
+	 * cover a single watch. */
+	static std::vector<struct MemoryRead> coalesceReads(std::vector<struct MemoryRead> ranges)
+	{
+		std::vector<struct MemoryRead> reads;
+		std::sort(ranges.begin(), ranges.end(), [] (const struct MemoryRead & a, const struct MemoryRead & b) -> bool
+			{ return a.address < b.address || (a.address == b.address && a.length > b.length); });
+		for (const auto & r : ranges)
+		{
+			if (reads.size())
+			{
+				struct MemoryRead & last = reads.back();
+				uint64_t lastEnd = (uint64_t) last.address + last.length, end = (uint64_t) r.address + r.length;
+				if (r.address <= lastEnd + (uint64_t) MAX_COALESCING_GAP && std::max(lastEnd, end) - last.address <= (uint64_t) MAX_READ_LENGTH)
+				{
+					last.length = std::max(lastEnd, end) - last.address;
+					last.watchIds.push_back(r.watchIds.at(0));
+					continue;
+				}
+			}
+			reads.push_back(r);
+		}
+		return reads;
+	}
+
+	LiveWatchEngine(QObject * parent = 0) : QObject(parent)
+	{
+		sampleTimer.setInterval(1000 / DEFAULT_SAMPLE_RATE_HZ);
+		connect(& sampleTimer, & QTimer::timeout, this, & LiveWatchEngine::startSamplingRound);
+		clock.start();
+	}
+	const std::vector<struct Watch> & watches(void) const { return watchList; }
+	const struct Statistics & statistics(void) const { return stats; }
+	int addWatch(const QString & expression)
+	{
+		watchList.push_back(Watch(nextWatchId, expression));
+		isReadPlanValid = false;
+		return nextWatchId ++;
+	}
+	void setWatchAddress(int id, uint32_t address)
+	{
+		struct Watch * w = watch(id);
+		if (w)
+			w->address = address, w->isAddressKnown = true, isReadPlanValid = false;
+	}
+	/* Objects larger than 'MAX_READ_LENGTH' are truncated. */
+	void setWatchSize(int id, uint32_t size)
+	{
+		struct Watch * w = watch(id);
+		if (w)
+			w->size = std::min(size, (uint32_t) MAX_READ_LENGTH), w->isSizeKnown = true, isReadPlanValid = false;
+	}
+	bool hasWatch(int id) const
+	{
+		for (const auto & w : watchList)
+			if (w.id == id)
+				return true;
+		return false;
+	}
+	void removeWatch(int id)
+	{
+		for (auto w = watchList.begin(); w != watchList.end(); w ++)
+			if (w->id == id)
+			{
+				watchList.erase(w);
+				isReadPlanValid = false;
+				return;
+			}
+	}
+	void removeAllWatches(void) { watchList.clear(); isReadPlanValid = false; }
+	void setSampleRate(int hz) { sampleTimer.setInterval(1000 / std::max(hz, 1)); }
+	/* Starts periodic sampling. Sampling rounds that would start while the previous round is still running are skipped. */
+	void startSampling(void) { stats = Statistics(); sampleTimer.start(); startSamplingRound(); }
+	/* Stops periodic sampling, and abandons the sampling round in progress, if any. */
+	void stopSampling(void) { sampleTimer.stop(); isSampling = false; }
+	bool isSamplingActive(void) const { return sampleTimer.isActive(); }
+	/* Runs a single sampling round, e.g. when the target halts. */
+	void sampleOnce(void) { isSampling = false; startSamplingRound(); }
+	/* Completes a memory read request. An empty data array means that the read has failed.
+	 * Completions for abandoned requests are ignored. */
+	void memoryReadCompleted(unsigned requestNumber, const QByteArray & data)
+	{
+		if (!isSampling || requestNumber != pendingRequestNumber)
+			return;
+		const struct MemoryRead & read = readPlan.at(nextRead ++);
+		if (data.length() != (int) read.length)
+			stats.failedReads ++;
+		else for (const auto & id : read.watchIds)
+		{
+			struct Watch * w = watch(id);
+			/* The watch may have changed while the read was in progress. */
+			if (w && w->isResolved() && w->address >= read.address && (uint64_t) w->address + w->size <= (uint64_t) read.address + read.length)
+				w->samples.push(roundTimestamp, data.mid(w->address - read.address, w->size));
+		}
+		if (nextRead < readPlan.size())
+			requestNextRead();
+		else
+		{
+			isSampling = false;
+			stats.completedRounds ++;
+			emit samplesUpdated();
+		}
+	}
+signals:
+	/* Requests a target memory read. Each request must be completed by calling 'memoryReadCompleted()'. */
+	void readMemory(unsigned requestNumber, uint32_t address, uint32_t length);
+	/* Emitted after a sampling round completes. */
+	void samplesUpdated(void);
+private:
+	std::vector<struct Watch> watchList;
+	int nextWatchId = 1;
+	QTimer sampleTimer;
+	QElapsedTimer clock;
+	struct Statistics stats;
+
+	/* The reads needed for a sampling round. This is only recomputed when the watches change. */
+	std::vector<struct MemoryRead> readPlan;
+	bool isReadPlanValid = false;
+
+	/* The state of the sampling round in progress. */
+	bool isSampling = false;
+	size_t nextRead = 0;
+	qint64 roundTimestamp = 0;
+	unsigned pendingRequestNumber = 0;
+
+	struct Watch * watch(int id)
+	{
+		for (auto & w : watchList)
+			if (w.id == id)
+				return & w;
+		return 0;
+	}
+	void startSamplingRound(void)
+	{
+		if (isSampling)
+		{
+			stats.skippedRounds ++;
+			return;
+		}
+		if (!isReadPlanValid)
+		{
+			std::vector<struct MemoryRead> ranges;
+			for (const auto & w : watchList)
+				if (w.isResolved())
+					ranges.push_back(MemoryRead(w.address, w.size, w.id));
+			readPlan = coalesceReads(ranges);
+			isReadPlanValid = true;
+			stats.readsPerRound = readPlan.size();
+		}
+		if (readPlan.empty())
+			return;
+		isSampling = true;
+		nextRead = 0;
+		roundTimestamp = clock.elapsed();
+		requestNextRead();
+	}
+	void requestNextRead(void)
+	{
+		const struct MemoryRead & read = readPlan.at(nextRead);
+		emit readMemory(++ pendingRequestNumber, read.address, read.length);
+	}
+};
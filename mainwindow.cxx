@@ -29,8 +29,10 @@
 
 #include <QFileDialog>
 #include <QTextBlock>
+#include <QScrollBar>
+#include <QtConcurrent>
 
-#include "clex/cscanner.hxx"
+#include "clex/clex.hxx"
 
 using namespace ELFIO;
 
@@ -88,6 +90,7 @@ MainWindow::MainWindow(QWidget *parent) :
 	ui->groupBoxTargetRunning->setTitle("");
 
 	settings = std::make_shared<QSettings>(SETTINGS_FILE_NAME, QSettings::IniFormat);
+	svdSnapshotsDirectory = QFileInfo(settings->fileName()).absoluteDir().filePath(SVD_SNAPSHOTS_DIRECTORY_NAME);
 	restoreState(settings->value(SETTINGS_MAINWINDOW_STATE, QByteArray()).toByteArray());
 	restoreGeometry(settings->value(SETTINGS_MAINWINDOW_GEOMETRY, QByteArray()).toByteArray());
 
@@ -99,7 +102,9 @@ MainWindow::MainWindow(QWidget *parent) :
 
 	connect(ui->pushButtonVerifyTargetMemory, & QPushButton::clicked, [&] { compareTargetMemory(); });
 	connect(ui->actionVerifyTargetFlash, & QAction::triggered, [&] { compareTargetMemory(); });
-	connect(ui->actionLoadProgramIntoTarget, & QAction::triggered, [&] { sendDataToGdbProcess("-target-download\n"); });
+	connect(ui->actionLoadProgramIntoTarget, & QAction::triggered, [&] { loadProgramIntoTarget(); });
+	connect(& blackMagicProbeServer, & BlackMagicProbeServer::injectedPacketsCompleted, [&] (unsigned requestNumber, const QVector<QByteArray> replies)
+		{ Q_UNUSED(requestNumber); continueIncrementalFlashing(replies); });
 	connect(ui->actionDisconnectGdbServer, & QAction::triggered, [&] { sendDataToGdbProcess("-target-disconnect\n"); });
 	connect(ui->actionactionScanForTargets, & QAction::triggered, [&] { scanForTargets(); });
 
@@ -130,6 +135,7 @@ MainWindow::MainWindow(QWidget *parent) :
 	connect(ui->pushButtonDisconnectGdb, & QPushButton::clicked, [&]{ sendDataToGdbProcess("-target-disconnect\n"); });
 
 	connect(ui->pushButtonLoadSVDFile, & QPushButton::clicked, [&]{ loadSVDFile(); });
+	connect(ui->pushButtonCompareSvdSnapshots, & QPushButton::clicked, [&]{ compareSvdSnapshots(); });
 
 	connect(ui->pushButtonRESTART, & QPushButton::clicked, [&]{
 		QApplication::closeAllWindows();
@@ -141,50 +147,104 @@ MainWindow::MainWindow(QWidget *parent) :
 		sendDataToGdbProcess(QString("-data-disassemble -a $pc -- 5\n"));
 	});
 
+	ui->treeViewSvd->setModel(& svdTreeModel);
 	connect(ui->lineEditSearchSVDTree, & QLineEdit::returnPressed, [&]
 	{
+		/* Expanding too many items makes the tree view unusable, so only this many matches are displayed. */
+		const int maxDisplayedMatches = 256;
 		QString text = ui->lineEditSearchSVDTree->text();
-		/* Special case for the empty string - show all items in the tree. No need to do anything special. */
-		std::vector<QTreeWidgetItem *> matchingItems, nonMatchingItems;
-		std::function<void(QTreeWidgetItem * item)> scan = [&](QTreeWidgetItem * item) -> void
+		ui->treeViewSvd->collapseAll();
+		ui->treeViewSvd->selectionModel()->clearSelection();
+		if (text.isEmpty())
 		{
-			item->setHidden(true);
-			if (item->text(0).contains(text, Qt::CaseInsensitive))
-				matchingItems.push_back(item);
-			else
-				nonMatchingItems.push_back(item);
-			for (int i = 0; i < item->childCount(); scan(item->child(i ++)))
-			     ;
-		};
-		std::function<void(QTreeWidgetItem * item)> makeSubtreeVisible = [&](QTreeWidgetItem * root) -> void
-		{
-			root->setHidden(false);
-			for (int i = 0; i < root->childCount(); makeSubtreeVisible(root->child(i ++)))
-			     ;
-		};
-		for (int i = 0; i < ui->treeWidgetSvd->topLevelItemCount(); scan(ui->treeWidgetSvd->topLevelItem(i ++)))
-			;
-		/* For matching items - make sure its parent items, upto the tree root, are visible.
-		 * Also, make sure that all items in subtrees with, roots amongst the matching items, are visible. */
-		for (auto & i : matchingItems)
-		{
-			QTreeWidgetItem * w = i->parent();
-			while (w) w->setHidden(false), w = w->parent();
-			makeSubtreeVisible(i);
+			/* Special case for the empty string - just show the list of peripherals. */
+			ui->treeViewSvd->expand(svdTreeModel.deviceIndex());
+			return;
+		}
+		std::vector<SvdTreeModel::Match> matches = svdTreeModel.find(text, maxDisplayedMatches);
+		QItemSelection selection;
+		for (const auto & m : matches)
+		{
+			QModelIndex index = svdTreeModel.matchIndex(m);
+			if (!index.isValid())
+				continue;
+			for (QModelIndex parent = index.parent(); parent.isValid(); parent = parent.parent())
+				ui->treeViewSvd->expand(parent);
+			selection.select(index, index.sibling(index.row(), svdTreeModel.columnCount() - 1));
 		}
+		ui->treeViewSvd->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+		if (!selection.isEmpty())
+			ui->treeViewSvd->scrollTo(selection.first().topLeft());
+		if ((int) matches.size() == maxDisplayedMatches)
+			appendLineToGdbLog(QString("Too many SVD items match '%1', only the first %2 matches are displayed").arg(text).arg(maxDisplayedMatches));
 	});
 
+	ui->tableViewMemoryDump->setModel(& memoryDumpModel);
+	connect(& memoryDumpModel, & MemoryDumpModel::readMemory, [&] (uint32_t address, uint32_t length) {
+		readTargetMemory(address, length, GdbTokenContext::GdbResponseContext(
+					 GdbTokenContext::GdbResponseContext::GDB_RESPONSE_DATA_READ_MEMORY, QString::number(address)));
+	});
 	connect(ui->pushButtonReadMemory, & QPushButton::clicked, [&] {
-		unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
-								   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_DATA_READ_MEMORY));
-		sendDataToGdbProcess(QString("%1-data-read-memory-bytes %2 %3\n")
-				     .arg(t)
-				     .arg(ui->lineEditMemoryReadAddress->text())
-				     .arg(ui->lineEditMemoryReadLength->text()));
-		/* By default, enable target memory view auto update. */
-		ui->checkBoxMemoryDumpAutoUpdate->setChecked(false);
+		bool ok;
+		uint32_t length = ui->lineEditMemoryReadLength->text().toUInt(& ok, 0);
+		if (!ok || !length)
+		{
+			QMessageBox::critical(0, "Invalid memory dump length", "Please, enter a valid memory dump length");
+			return;
+		}
+		uint32_t address = ui->lineEditMemoryReadAddress->text().toUInt(& ok, 0);
+		if (ok)
+		{
+			memoryDumpModel.setRange(address, length);
+			memoryDumpModel.setFetchingEnabled(true);
+		}
+		else
+		{
+			/* The address is not a number, let gdb evaluate it. */
+			unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
+									   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_MEMORY_DUMP_ADDRESS, QString::number(length)));
+			sendDataToGdbProcess(QString("%1-data-evaluate-expression \"(unsigned) (%2)\"\n").arg(t)
+					     .arg(Utils::escapeString(ui->lineEditMemoryReadAddress->text())));
+		}
 	});
 
+	/*****************************************
+	 * Configure the live watch view.
+	 *****************************************/
+	connect(& liveWatchEngine, & LiveWatchEngine::readMemory, [&] (unsigned requestNumber, uint32_t address, uint32_t length) {
+		if (target_state == TARGET_STOPPED)
+			readTargetMemory(address, length, GdbTokenContext::GdbResponseContext(
+						 GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_READ, QString::number(requestNumber)));
+		else if (!blackMagicProbeServer.injectMemoryRead(requestNumber, address, length))
+			liveWatchEngine.memoryReadCompleted(requestNumber, QByteArray());
+	});
+	connect(& blackMagicProbeServer, & BlackMagicProbeServer::injectedMemoryReadCompleted, & liveWatchEngine, & LiveWatchEngine::memoryReadCompleted);
+	connect(& blackMagicProbeServer, & BlackMagicProbeServer::injectedMemoryReadsNotSupported, [&] {
+		liveWatchEngine.stopSampling();
+		ui->labelLiveWatchStatus->setText("Target memory could not be read while the target is running, sampling stopped");
+	});
+	connect(& liveWatchEngine, & LiveWatchEngine::samplesUpdated, [&] { updateLiveWatchView(); });
+	connect(ui->lineEditLiveWatchExpression, & QLineEdit::returnPressed, [&] {
+		addLiveWatch(ui->lineEditLiveWatchExpression->text());
+		ui->lineEditLiveWatchExpression->clear();
+	});
+	connect(ui->spinBoxLiveWatchSampleRate, QOverload<int>::of(& QSpinBox::valueChanged), [&] (int hz) { liveWatchEngine.setSampleRate(hz); });
+	connect(ui->checkBoxLiveWatchSampleWhileRunning, & QCheckBox::toggled, [&] (bool checked) {
+		if (!checked)
+			liveWatchEngine.stopSampling();
+		else if (target_state == TARGET_RUNNING && isBlackmagicProbeConnected)
+			liveWatchEngine.startSampling();
+	});
+	connect(ui->pushButtonLiveWatchRemove, & QPushButton::clicked, [&] {
+		QTreeWidgetItem * item = ui->treeWidgetLiveWatch->currentItem();
+		if (item)
+		{
+			liveWatchEngine.removeWatch(item->data(0, Qt::UserRole).toInt());
+			updateLiveWatchView();
+		}
+	});
+	connect(ui->pushButtonLiveWatchRemoveAll, & QPushButton::clicked, [&] { liveWatchEngine.removeAllWatches(); updateLiveWatchView(); });
+
 	/*****************************************
 	 * Configure the 'Settings' dialog.
 	 *****************************************/
@@ -220,6 +280,7 @@ MainWindow::MainWindow(QWidget *parent) :
 		settings->setValue(SETTINGS_EXTERNAL_EDITOR_COMMAND_LINE_OPTIONS, uiSettings.lineEditExternalEditorOptions->text());
 		targetSVDFileName = uiSettings.lineEditTargetSVDFileName->text();
 		settings->setValue(SETTINGS_CHECKBOX_ENABLE_NATIVE_DEBUGGING_STATE, uiSettings.checkBoxEnableNativeDebugging->isChecked());
+		settings->setValue(SETTINGS_CHECKBOX_ENABLE_INCREMENTAL_FLASHING_STATE, uiSettings.checkBoxEnableIncrementalFlashing->isChecked());
 		settings->setValue(SETTINGS_CHECKBOX_HIDE_LESS_USED_UI_ITEMS, uiSettings.checkBoxHideLessUsedUiItems->isChecked());
 		dialogEditSettings->hide();
 	});
@@ -352,9 +413,18 @@ MainWindow::MainWindow(QWidget *parent) :
 	connect(gdbMiReceiver, SIGNAL(gdbMiOutputLineAvailable(QString)), this, SLOT(gdbMiLineAvailable(QString)));
 	gdbMiReceiverThread.start();
 
-	connect(&varObjectTreeItemModel, SIGNAL(readGdbVarObjectChildren(const QString)), this, SLOT(readGdbVarObjectChildren(const QString)));
+	connect(&varObjectTreeItemModel, SIGNAL(readGdbVarObjectChildren(const QString,int,int)), this, SLOT(readGdbVarObjectChildren(const QString,int,int)));
 	ui->treeViewDataObjects->setModel(&varObjectTreeItemModel);
 
+	varObjectViewScanTimer.setSingleShot(true);
+	varObjectViewScanTimer.setInterval(50);
+	connect(& varObjectViewScanTimer, & QTimer::timeout, [&] { scanVisibleVarObjects(); });
+	connect(ui->treeViewDataObjects->verticalScrollBar(), & QScrollBar::valueChanged, [&] { varObjectViewScanTimer.start(); });
+	connect(ui->treeViewDataObjects, & QTreeView::expanded, [&] { varObjectViewScanTimer.start(); });
+	connect(& varObjectTreeItemModel, & QAbstractItemModel::rowsInserted, [&] { varObjectViewScanTimer.start(); });
+	connect(& varObjectPageEvictionTimer, & QTimer::timeout, [&] { evictVarObjectPages(); });
+	varObjectPageEvictionTimer.start(VAR_OBJECT_PAGE_EVICTION_CHECK_INTERVAL_MS);
+
 	/* Forcing the rows of the tree view to be of uniform height enables some optimizations, which
 	 * makes a significant difference when a large number of items is displayed. */
 	ui->treeViewDataObjects->setUniformRowHeights(true);
@@ -369,14 +439,59 @@ MainWindow::MainWindow(QWidget *parent) :
 	ui->treeViewDataObjects->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
 #endif
 
-	ui->treeWidgetSourceFiles->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-	ui->treeWidgetSourceFiles->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-	//ui->treeWidgetSourceFiles->header()->setSectionResizeMode(1,1);
+	ui->treeViewSourceFiles->setModel(& sourceFilesModel);
+	ui->treeViewSourceFiles->sortByColumn(0, Qt::AscendingOrder);
+	ui->treeViewSourceFiles->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	ui->treeViewSourceFiles->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	//ui->treeViewSourceFiles->header()->setSectionResizeMode(1,1);
 
 	ui->treeWidgetStackVariables->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
 	ui->treeWidgetStackVariables->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
 	ui->treeWidgetStackVariables->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
+	/* Retrieve the full values of the selected data objects. */
+	connect(ui->treeViewDataObjects->selectionModel(), & QItemSelectionModel::currentChanged, [&] (const QModelIndex & current)
+	{
+		const GdbVarObjectTreeItem * t = GdbVarObjectTreeItemModel::varoObjectTreeItemForIndex(current);
+		if (t && !t->isPlaceholder && t->isInScope)
+			fetchFullValue(t->value, QString("-var-evaluate-expression %1").arg(t->miName),
+				       GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VAR_OBJECT_FULL_VALUE, t->miName);
+	});
+	connect(ui->treeWidgetStackVariables, & QTreeWidget::currentItemChanged, [&] (QTreeWidgetItem * current)
+	{
+		if (current)
+			fetchFullValue(current->text(1), QString("-data-evaluate-expression \"%1\"").arg(Utils::escapeString(current->text(0))),
+				       GdbTokenContext::GdbResponseContext::GDB_RESPONSE_STACK_VARIABLE_FULL_VALUE, current->text(0));
+	});
+	labelValueBytesReceived = new QLabel(this);
+	ui->statusBar->addPermanentWidget(labelValueBytesReceived);
+	countReceivedValueBytes(0);
+
+	/* Show the progress of incremental jobs in the status bar. */
+	progressBarIncrementalJobs = new QProgressBar(this);
+	progressBarIncrementalJobs->setMaximumWidth(200);
+	progressBarIncrementalJobs->setFormat("%v / %m");
+	toolButtonCancelIncrementalJobs = new QToolButton(this);
+	toolButtonCancelIncrementalJobs->setText("Cancel");
+	ui->statusBar->addWidget(progressBarIncrementalJobs);
+	ui->statusBar->addWidget(toolButtonCancelIncrementalJobs);
+	progressBarIncrementalJobs->hide();
+	toolButtonCancelIncrementalJobs->hide();
+	connect(toolButtonCancelIncrementalJobs, & QToolButton::clicked, [&] { incrementalJobRunner.cancelAll(); });
+	connect(& incrementalJobRunner, & IncrementalJobRunner::progressChanged, [&] (const QString description, int done, int total)
+	{
+		progressBarIncrementalJobs->setToolTip(description);
+		progressBarIncrementalJobs->setMaximum(total);
+		progressBarIncrementalJobs->setValue(done);
+		progressBarIncrementalJobs->show();
+		toolButtonCancelIncrementalJobs->show();
+	});
+	connect(& incrementalJobRunner, & IncrementalJobRunner::idle, [&]
+	{
+		progressBarIncrementalJobs->hide();
+		toolButtonCancelIncrementalJobs->hide();
+	});
+
 	ui->treeWidgetBookmarks->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
 	ui->treeWidgetBookmarks->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
 
@@ -384,19 +499,25 @@ MainWindow::MainWindow(QWidget *parent) :
 	ui->treeWidgetSearchResults->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
 	ui->treeWidgetSearchResults->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
-	ui->treeWidgetSubprograms->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-	ui->treeWidgetSubprograms->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-	ui->treeWidgetSubprograms->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-	ui->treeWidgetSubprograms->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
-
-	ui->treeWidgetStaticDataObjects->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-	ui->treeWidgetStaticDataObjects->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-	ui->treeWidgetStaticDataObjects->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
-	ui->treeWidgetStaticDataObjects->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
-
-	ui->treeWidgetDataTypes->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-	ui->treeWidgetDataTypes->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-	ui->treeWidgetDataTypes->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+	ui->treeViewSubprograms->setModel(& subprogramsModel);
+	ui->treeViewSubprograms->sortByColumn(0, Qt::AscendingOrder);
+	ui->treeViewSubprograms->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	ui->treeViewSubprograms->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	ui->treeViewSubprograms->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+	ui->treeViewSubprograms->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
+
+	ui->treeViewStaticDataObjects->setModel(& staticDataObjectsModel);
+	ui->treeViewStaticDataObjects->sortByColumn(0, Qt::AscendingOrder);
+	ui->treeViewStaticDataObjects->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	ui->treeViewStaticDataObjects->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	ui->treeViewStaticDataObjects->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+	ui->treeViewStaticDataObjects->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
+
+	ui->treeViewDataTypes->setModel(& dataTypesModel);
+	ui->treeViewDataTypes->sortByColumn(0, Qt::AscendingOrder);
+	ui->treeViewDataTypes->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	ui->treeViewDataTypes->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	ui->treeViewDataTypes->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
 	ui->treeWidgetBacktrace->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
 	ui->treeWidgetBacktrace->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
@@ -404,13 +525,13 @@ MainWindow::MainWindow(QWidget *parent) :
 	ui->treeWidgetBacktrace->header()->setSectionResizeMode(3, QHeaderView::ResizeToContents);
 	ui->treeWidgetBacktrace->header()->setSectionResizeMode(4, QHeaderView::ResizeToContents);
 
-	ui->treeWidgetSvd->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
-	ui->treeWidgetSvd->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
-	ui->treeWidgetSvd->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+	ui->treeViewSvd->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	ui->treeViewSvd->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+	ui->treeViewSvd->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
 	ui->treeWidgetBreakpoints->header()->setSectionResizeMode(5, QHeaderView::ResizeToContents);
 
-	connect(ui->actionSourceFilesViewShowFullFileNames, & QAction::toggled, [&](bool checked) { ui->treeWidgetSourceFiles->setColumnHidden(1, !checked); });
+	connect(ui->actionSourceFilesViewShowFullFileNames, & QAction::toggled, [&](bool checked) { ui->treeViewSourceFiles->setColumnHidden(1, !checked); });
 	ui->actionSourceFilesViewShowFullFileNames->setChecked(settings->value(SETTINGS_BOOL_SHOW_FULL_FILE_NAME_STATE, false).toBool());
 	ui->toolButtonSourceFilesViewOptions->addAction(ui->actionSourceFilesViewShowFullFileNames);
 	/* Force updating of the full file name column in the source files widget. */
@@ -422,6 +543,11 @@ MainWindow::MainWindow(QWidget *parent) :
 	ui->actionSourceFilesShowOnlyExistingFiles->setChecked(settings->value(SETTINGS_BOOL_SHOW_ONLY_EXISTING_SOURCE_FILES, false).toBool());
 	ui->toolButtonSourceFilesViewOptions->addAction(ui->actionSourceFilesShowOnlyFilesWithMachineCode);
 	ui->toolButtonSourceFilesViewOptions->addAction(ui->actionSourceFilesShowOnlyExistingFiles);
+	ui->toolButtonSourceFilesViewOptions->addAction(ui->actionSourceFilesRemapSourcePaths);
+	connect(ui->actionSourceFilesRemapSourcePaths, & QAction::triggered, [&] { editSourcePathRemapRules(); });
+	/* Existence checks for source files are run in the background, refresh the source files view when results arrive.
+	 * Only the files found missing are removed from the view, the view is not rebuilt. */
+	connect(& pathResolver, & PathResolver::existenceUpdated, [&] { if (ui->actionSourceFilesShowOnlyExistingFiles->isChecked()) sourceFilesModel.refilter(); });
 
 
 	connect(ui->treeWidgetBookmarks, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
@@ -429,35 +555,38 @@ MainWindow::MainWindow(QWidget *parent) :
 	connect(ui->treeWidgetBookmarks, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
 		{ showSourceCode(item); } );
 
-	connect(ui->treeWidgetObjectLocator, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
-	connect(ui->treeWidgetObjectLocator, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
+	ui->treeViewObjectLocator->setModel(& objectLocatorModel);
+	ui->treeViewObjectLocator->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+	objectLocatorModel.setMessage("< enter more text to search for... >");
+	connect(ui->treeViewObjectLocator, & QTreeView::activated, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
+	connect(ui->treeViewObjectLocator, & QTreeView::clicked, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
 
-	connect(ui->treeWidgetSourceFiles, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
-	connect(ui->treeWidgetSourceFiles, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
+	connect(ui->treeViewSourceFiles, & QTreeView::activated, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
+	connect(ui->treeViewSourceFiles, & QTreeView::clicked, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
 
 	connect(ui->treeWidgetSearchResults, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
 		{ showSourceCode(item); } );
 	connect(ui->treeWidgetSearchResults, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
 		{ showSourceCode(item); } );
 
-	connect(ui->treeWidgetSubprograms, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
-	connect(ui->treeWidgetSubprograms, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
+	connect(ui->treeViewSubprograms, & QTreeView::activated, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
+	connect(ui->treeViewSubprograms, & QTreeView::clicked, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
 
-	connect(ui->treeWidgetStaticDataObjects, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
-	connect(ui->treeWidgetStaticDataObjects, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
+	connect(ui->treeViewStaticDataObjects, & QTreeView::activated, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
+	connect(ui->treeViewStaticDataObjects, & QTreeView::clicked, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
 
-	connect(ui->treeWidgetDataTypes, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
-	connect(ui->treeWidgetDataTypes, & QTreeWidget::itemClicked, [=] (QTreeWidgetItem * item, int column)
-		{ showSourceCode(item); } );
+	connect(ui->treeViewDataTypes, & QTreeView::activated, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
+	connect(ui->treeViewDataTypes, & QTreeView::clicked, [=] (const QModelIndex & index)
+		{ showSourceCode(index); } );
 
 	connect(ui->treeWidgetBacktrace, & QTreeWidget::itemActivated, [=] (QTreeWidgetItem * item, int column)
 		{ selectStackFrame(item); } );
@@ -579,6 +708,9 @@ MainWindow::MainWindow(QWidget *parent) :
 "QPlainTextEdit {\n"
 	+ DEFAULT_PLAINTEXTEDIT_STYLESHEET +
 "}\n"
+"QTableView#tableViewMemoryDump {\n"
+	+ DEFAULT_PLAINTEXTEDIT_STYLESHEET +
+"}\n"
 "QLineEdit{\n"
     "font: 10pt 'Hack';\n"
 "}\n"
@@ -586,6 +718,12 @@ MainWindow::MainWindow(QWidget *parent) :
 
 	ui->plainTextEditScratchpad->setPlainText(settings->value(SETTINGS_SCRATCHPAD_TEXT_CONTENTS, QString("Lorem ipsum dolor sit amet")).toString());
 
+	/* Do not use 'QHeaderView::ResizeToContents' for the memory dump view, it would read all of the target memory dumped. */
+	ui->tableViewMemoryDump->horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	ui->tableViewMemoryDump->horizontalHeader()->setDefaultSectionSize(QFontMetrics(QFont("Hack", 10)).boundingRect("0000").width());
+	ui->tableViewMemoryDump->horizontalHeader()->setSectionResizeMode(MemoryDumpModel::ASCII_COLUMN, QHeaderView::Stretch);
+	ui->tableViewMemoryDump->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
 	ui->plainTextEditSourceView->installEventFilter(this);
 	ui->plainTextEditDisassembly->installEventFilter(this);
 	ui->plainTextEditSourceView->viewport()->installEventFilter(this);
@@ -594,7 +732,10 @@ MainWindow::MainWindow(QWidget *parent) :
 	connect(gdbProcess.get(), & QProcess::started, [&] {
 		sendDataToGdbProcess("-gdb-set tcp auto-retry off\n");
 		sendDataToGdbProcess("-gdb-set mem inaccessible-by-default off\n");
-		sendDataToGdbProcess("-gdb-set print elements unlimited\n");
+		/* Do not print the full values of large arrays and strings, as they would be retrieved each time the target halts.
+		 * The full values are retrieved on demand. */
+		sendDataToGdbProcess(QString("-gdb-set print elements %1\n").arg(VALUE_PREVIEW_MAX_ELEMENTS));
+		sendDataToGdbProcess(QString("-gdb-set print repeats %1\n").arg(VALUE_PREVIEW_REPEAT_THRESHOLD));
 
 		int result;
 		QFileInfo fi;
@@ -620,23 +761,23 @@ MainWindow::MainWindow(QWidget *parent) :
 	ui->treeWidgetBookmarks->setContextMenuPolicy(Qt::CustomContextMenu);
 	connect(ui->treeWidgetBookmarks, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(bookmarksContextMenuRequested(QPoint)));
 
-	ui->treeWidgetSvd->setContextMenuPolicy(Qt::CustomContextMenu);
-	connect(ui->treeWidgetSvd, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(svdContextMenuRequested(QPoint)));
+	ui->treeViewSvd->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(ui->treeViewSvd, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(svdContextMenuRequested(QPoint)));
 
 	ui->treeViewDataObjects->setContextMenuPolicy(Qt::CustomContextMenu);
 	connect(ui->treeViewDataObjects, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(varObjectContextMenuRequested(QPoint)));
 
 	/* Unified custom menu processing for source items. */
-	ui->treeWidgetObjectLocator->setContextMenuPolicy(Qt::CustomContextMenu);
-	connect(ui->treeWidgetObjectLocator, &QTreeWidget::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeWidgetObjectLocator, p); });
-	ui->treeWidgetDataTypes->setContextMenuPolicy(Qt::CustomContextMenu);
-	connect(ui->treeWidgetDataTypes, &QTreeWidget::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeWidgetDataTypes, p); });
-	ui->treeWidgetStaticDataObjects->setContextMenuPolicy(Qt::CustomContextMenu);
-	connect(ui->treeWidgetStaticDataObjects, &QTreeWidget::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeWidgetStaticDataObjects, p); });
-	ui->treeWidgetSubprograms->setContextMenuPolicy(Qt::CustomContextMenu);
-	connect(ui->treeWidgetSubprograms, &QTreeWidget::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeWidgetSubprograms, p); });
-	ui->treeWidgetSourceFiles->setContextMenuPolicy(Qt::CustomContextMenu);
-	connect(ui->treeWidgetSourceFiles, &QTreeWidget::customContextMenuRequested, [&] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeWidgetSourceFiles, p); });
+	ui->treeViewObjectLocator->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(ui->treeViewObjectLocator, &QTreeView::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeViewObjectLocator, p); });
+	ui->treeViewDataTypes->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(ui->treeViewDataTypes, &QTreeView::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeViewDataTypes, p); });
+	ui->treeViewStaticDataObjects->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(ui->treeViewStaticDataObjects, &QTreeView::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeViewStaticDataObjects, p); });
+	ui->treeViewSubprograms->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(ui->treeViewSubprograms, &QTreeView::customContextMenuRequested, [=] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeViewSubprograms, p); });
+	ui->treeViewSourceFiles->setContextMenuPolicy(Qt::CustomContextMenu);
+	connect(ui->treeViewSourceFiles, &QTreeView::customContextMenuRequested, [&] (QPoint p) -> void { sourceItemContextMenuRequested(ui->treeViewSourceFiles, p); });
 
 	/* Use this for handling changes to the breakpoint enable/disable checkbox modifications. */
 	connect(ui->treeWidgetBreakpoints, SIGNAL(itemChanged(QTreeWidgetItem*,int)), this, SLOT(breakpointViewItemChanged(QTreeWidgetItem*,int)));
@@ -653,6 +794,16 @@ MainWindow::MainWindow(QWidget *parent) :
 	highlightFormats.bookmark.setBackground(QBrush(Qt::darkCyan));
 	highlightFormats.searchedText.setBackground(QBrush(Qt::yellow));
 
+	connect(ui->plainTextEditSourceView->verticalScrollBar(), & QScrollBar::valueChanged, [=] { highlightVisibleSearchMatches(); });
+	connect(& searchData.matchCountWatcher, & QFutureWatcher<QPair<unsigned, int>>::finished, [=]
+		{
+			QPair<unsigned, int> matchCount = searchData.matchCountWatcher.result();
+			/* Discard stale match counts. */
+			if (matchCount.first != searchData.generation)
+				return;
+			ui->labelSearchMatchCount->setText(QString("%1 matches").arg(matchCount.second));
+		});
+
 	connect(ui->plainTextEditSourceView, &QPlainTextEdit::cursorPositionChanged, [=]()
 		{
 			QTextCursor c(ui->plainTextEditSourceView->textCursor());
@@ -709,13 +860,22 @@ MainWindow::MainWindow(QWidget *parent) :
 	});
 
 	connect(&blackMagicProbeServer, &BlackMagicProbeServer::GdbClientDisconnected, [&]
-		{ targetStateDependentWidgets.enterTargetState(target_state = GDBSERVER_DISCONNECTED, isBlackmagicProbeConnected, ui->labelSystemState, ui->pushButtonShortState);}
+		{ liveWatchEngine.stopSampling(); targetMemoryVerifier.cancel(); consoleDataCapture.stopCapture(); incrementalFlasher.cancel(); pendingSvdSnapshot.reset();
+		  targetStateDependentWidgets.enterTargetState(target_state = GDBSERVER_DISCONNECTED, isBlackmagicProbeConnected, ui->labelSystemState, ui->pushButtonShortState);}
 	);
 
 	connect(this, &MainWindow::targetStopped, [&] {
 		if (target_state == GDBSERVER_DISCONNECTED || target_state == TARGET_DETACHED)
 			compareTargetMemory();
+		valueBytesReceivedSinceStop = 0;
+		countReceivedValueBytes(0);
 		targetStateDependentWidgets.enterTargetState(target_state = TARGET_STOPPED, isBlackmagicProbeConnected, ui->labelSystemState, ui->pushButtonShortState);
+		liveWatchEngine.stopSampling();
+		liveWatchEngine.sampleOnce();
+		if (ui->checkBoxMemoryDumpAutoUpdate->isChecked())
+			memoryDumpModel.setFetchingEnabled(true);
+		if (ui->checkBoxSvdAutoRefreshOnHalt->isChecked())
+			refreshSvdRegisterViews();
 		/*! \todo Make the frame limits configurable. */
 		sendDataToGdbProcess("-stack-list-frames 0 100\n");
 		if (!targetRegisterIndices.size())
@@ -738,13 +898,18 @@ MainWindow::MainWindow(QWidget *parent) :
 
 	connect(this, &MainWindow::targetRunning, [&] {
 		targetStateDependentWidgets.enterTargetState(target_state = TARGET_RUNNING, isBlackmagicProbeConnected, ui->labelSystemState, ui->pushButtonShortState);
+		if (ui->checkBoxLiveWatchSampleWhileRunning->isChecked() && isBlackmagicProbeConnected)
+			liveWatchEngine.startSampling();
+		targetMemoryCache.invalidate();
+		memoryDumpModel.setFetchingEnabled(false);
+		memoryDumpModel.targetResumed();
 	});
 
 	connect(this, &MainWindow::targetDetached, [&]
 		/*! \todo	This is getting too complicated... It is problematic to distinguish between a gdbserver detach and a gdbserver disconnect event.
 		 *		The target state handling needs to be improved and simplified.
 		 *		For the moment, try to do some special case handling - if the target state is GDBSERVER_DISCONNECTED, then stay in the disconnected state. */
-		{ if (target_state != GDBSERVER_DISCONNECTED) targetStateDependentWidgets.enterTargetState(target_state = TARGET_DETACHED, isBlackmagicProbeConnected, ui->labelSystemState, ui->pushButtonShortState);}
+		{ liveWatchEngine.stopSampling(); if (target_state != GDBSERVER_DISCONNECTED) targetStateDependentWidgets.enterTargetState(target_state = TARGET_DETACHED, isBlackmagicProbeConnected, ui->labelSystemState, ui->pushButtonShortState);}
 	);
 
 	/***************************************
@@ -754,9 +919,10 @@ MainWindow::MainWindow(QWidget *parent) :
 	connect(ui->pushButtonResetAndRunTarget, & QPushButton::clicked, [&] { sendDataToGdbProcess("-exec-run\n"); });
 	connect(ui->pushButtonContinue, & QPushButton::clicked, [&] { sendDataToGdbProcess("-exec-continue\n"); });
 
-	stringFinder = new StringFinder();
+	stringFinder = new StringFinder(sourceCorpus);
 	stringFinder->moveToThread(&fileSearchThread);
-	connect(this, SIGNAL(findString(QString,uint)), stringFinder, SLOT(findString(QString,uint)));
+	connect(this, SIGNAL(findString(QString,uint,uint)), stringFinder, SLOT(findString(QString,uint,uint)));
+	connect(this, SIGNAL(findIdentifierReferences(QString,uint)), stringFinder, SLOT(findIdentifierReferences(QString,uint)));
 	connect(this, SIGNAL(addFilesToSearchSet(QStringList)), stringFinder, SLOT(addFilesToSearchSet(QStringList)));
 
 	widgetFlashHighlighterData.timer.setSingleShot(true);
@@ -786,6 +952,7 @@ MainWindow::MainWindow(QWidget *parent) :
 	makeHighlightAction(ui->dockWidgetDataTypes->windowTitle(), "", ui->dockWidgetDataTypes);
 	makeHighlightAction(ui->dockWidgetSvdView->windowTitle(), "", ui->dockWidgetSvdView);
 	makeHighlightAction(ui->dockWidgetMemoryDump->windowTitle(), "", ui->dockWidgetMemoryDump);
+	makeHighlightAction(ui->dockWidgetLiveWatch->windowTitle(), "", ui->dockWidgetLiveWatch);
 	for (const auto & a : highlightWidgetActions)
 		addAction(a);
 
@@ -800,6 +967,7 @@ MainWindow::MainWindow(QWidget *parent) :
 		 * not exist at this time. Adding a small delay before checking if the file exists is not a very
 		 * nice solution, but works satisfactorily in practice. */
 		usleep(20000);
+		pathResolver.invalidate(path);
 		QFileInfo fi(path);
 		if (!fi.exists())
 			QMessageBox::warning(0, "File has disappeared", QString("This file has disappeared, it may have been renamed or removed:\n%1").arg(path));
@@ -817,7 +985,7 @@ MainWindow::MainWindow(QWidget *parent) :
 	}
 	);
 
-	connect(ui->treeWidgetSvd, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(createSvdRegisterView(QTreeWidgetItem*,int)));
+	connect(ui->treeViewSvd, & QTreeView::doubleClicked, this, & MainWindow::createSvdRegisterView);
 
 	connect(ui->lineEditGdbCommand1, & QLineEdit::returnPressed, [&] { sendCommandsToGdb(ui->lineEditGdbCommand1); });
 	connect(ui->pushButtonSendCommandToGdb1, & QPushButton::clicked, [&] { sendCommandsToGdb(ui->lineEditGdbCommand1); });
@@ -844,10 +1012,12 @@ void MainWindow::loadSessions()
 
 void MainWindow::restoreSession(const QString &executableFileName)
 {
+	bool isSessionFound = false;
 	for (const auto & session : sessions)
 	{
 		if (session.executableFileName != executableFileName)
 			continue;
+		isSessionFound = true;
 		targetSVDFileName = session.targetSVDFileName;
 		/* Load bookmarks. */
 		for (const auto & bookmark : session.bookmarks)
@@ -858,6 +1028,10 @@ void MainWindow::restoreSession(const QString &executableFileName)
 			bookmarks << SourceCodeLocation(bookmarkData.at(0), bookmarkData.at(1).toInt());
 		}
 		updateBookmarksView();
+		QList<PathResolver::RemapRule> rules;
+		for (const auto & rule : session.sourcePathRemapRules)
+			rules << PathResolver::RemapRule::fromString(rule);
+		pathResolver.setRemapRules(rules);
 		/* Attempt to restore breakpoints. */
 		for (const auto & b : session.breakpoints)
 			if (!b.isEmpty())
@@ -865,6 +1039,10 @@ void MainWindow::restoreSession(const QString &executableFileName)
 
 		break;
 	}
+	if (!isSessionFound)
+		/* Source path remapping rules are specific to an executable, do not keep
+		 * the rules of a previously loaded executable. */
+		pathResolver.setRemapRules({});
 	isSessionRestored = true;
 }
 
@@ -881,7 +1059,9 @@ void MainWindow::saveSessions()
 	for (i = 0; i < ui->treeWidgetBreakpoints->topLevelItemCount(); i ++)
 		s.breakpoints << ui->treeWidgetBreakpoints->topLevelItem(i)->text(5);
 	for (const auto & bookmark : bookmarks)
-		s.bookmarks << QString("%1\n%2").arg(bookmark.fullFileName).arg(bookmark.lineNumber);
+		s.bookmarks << QString("%1\n%2").arg(bookmark.fullFileName()).arg(bookmark.lineNumber);
+	for (const auto & rule : pathResolver.remapRules())
+		s.sourcePathRemapRules << rule.toString();
 	/* Override the session information for the currently loaded executable file, if it exists in the list of saved sessions. */
 	sessions.removeAll(s);
 	sessions.prepend(s);
@@ -985,7 +1165,7 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 				if (!s.isEmpty())
 				{
 					if (mouseEvent->modifiers() == Qt::ShiftModifier)
-						emit findString(s, ui->checkBoxSearchForWholeWordsOnly->isChecked() ? StringFinder::SEARCH_FOR_WHOLE_WORDS_ONLY : 0);
+						searchSourceFilesForText(s);
 					if (mouseEvent->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
 						ui->lineEditObjectLocator->setText(s);
 				}
@@ -1011,7 +1191,7 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 					if (b.empty())
 						/* Breakpoint not found for the source code line - insert one. */
 						sendDataToGdbProcess(QString("-break-insert --source \"%1\" --line %2\n")
-								     .arg(escapeString(t.fullFileName))
+								     .arg(Utils::escapeString(t.fullFileName))
 								     .arg(t.lineNumber));
 					else
 					{
@@ -1108,8 +1288,9 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 				/* Special case for internal files - do not attempt to open them in an external editor. */
 				if (sourceFilename.startsWith(":/"))
 					break;
-				if (!QFileInfo(sourceFilename).exists())
-					sourceFilename = Utils::filenameToWindowsFilename(sourceFilename);
+				QString filesystemFileName = pathResolver.filesystemFileName(displayedSourceCodeFileId);
+				if (!filesystemFileName.isEmpty())
+					sourceFilename = filesystemFileName;
 				QString editor = settings->value(SETTINGS_EXTERNAL_EDITOR_PROGRAM, "").toString();
 				if (!QFileInfo(editor).exists())
 					editor = Utils::filenameToWindowsFilename(editor);
@@ -1155,6 +1336,16 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 			ui->lineEditFindText->clear();
 			ui->lineEditFindText->setFocus();
 			break;
+		case Qt::Key_R:
+		{
+			QTextCursor c = ui->plainTextEditSourceView->textCursor();
+			c.select(QTextCursor::WordUnderCursor);
+			QString identifier = c.selectedText();
+			if (!identifier.isEmpty())
+				findReferencesToIdentifier(identifier);
+			result = true;
+		}
+			break;
 		case Qt::Key_Asterisk:
 		{
 			QTextCursor c = ui->plainTextEditSourceView->textCursor();
@@ -1190,7 +1381,7 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 				if (b.empty())
 					/* Breakpoint not found at current source code line - insert one. */
 					sendDataToGdbProcess(QString("-break-insert --source \"%1\" --line %2\n")
-							     .arg(escapeString(displayedSourceCodeFile))
+							     .arg(Utils::escapeString(displayedSourceCodeFile))
 							     .arg(lineNumber));
 				else
 				{
@@ -1220,6 +1411,8 @@ MainWindow::~MainWindow()
 	gdbMiReceiverThread.wait();
 	gdbProcess->waitForFinished();
 
+	/* Abandon any string search in progress. */
+	stringFinder->startNewSearchGeneration();
 	fileSearchThread.quit();
 	fileSearchThread.wait();
 
@@ -1248,6 +1441,7 @@ void MainWindow::gdbMiLineAvailable(QString line)
 		case '~':
 		/* Console stream output. */
 			appendLineToGdbLog(normalizeGdbString(line.right(line.length() - 1)));
+			consoleDataCapture.captureLine(normalizeGdbString(line.right(line.length() - 1)));
 			break;
 		case '&':
 		/* Log stream output. */
@@ -1281,8 +1475,9 @@ void MainWindow::gdbMiLineAvailable(QString line)
 				handleVariablesResponse(result, results, tokenNumber) ||
 				handleFrameResponse(result, results, tokenNumber) ||
 				handleDisassemblyResponse(result, results, tokenNumber) ||
+				handleLiveWatchResponse(result, results, tokenNumber) ||
 				handleValueResponse(result, results, tokenNumber) ||
-				handleVerifyTargetMemoryContentsSeqPoint(result, results, tokenNumber) ||
+				handleVerifyTargetMemoryResponse(result, results, tokenNumber) ||
 				handleMemoryResponse(result, results, tokenNumber) ||
 				false)
 					break;
@@ -1335,6 +1530,17 @@ void MainWindow::gdbMiLineAvailable(QString line)
 			if (line.startsWith("=breakpoint-created") || line.startsWith("=breakpoint-modified")
 					|| line.startsWith("=breakpoint-deleted"))
 				sendDataToGdbProcess("-break-list\n");
+			else if (line.startsWith("=memory-changed"))
+			{
+				/* Target memory has been written, e.g. by assigning a value to a variable. */
+				QRegularExpression rx("addr=\"([^\"]+)\",len=\"([^\"]+)\"");
+				QRegularExpressionMatch match = rx.match(line);
+				if (match.hasMatch())
+					targetMemoryCache.invalidate(match.captured(1).toUInt(0, 0), match.captured(2).toUInt(0, 0));
+				else
+					targetMemoryCache.invalidate();
+				memoryDumpModel.invalidate();
+			}
 			else if (line.startsWith("=thread-group-started"))
 			{
 				QRegularExpression rx("=thread-group-started,id=\"(.+)\",pid=\"(.+)\"");
@@ -1470,7 +1676,10 @@ bool MainWindow::handleNumchildResponse(GdbMiParser::RESULT_CLASS_ENUM parseResu
 					else if (t.first == "numchild")
 						childCount = QString::fromStdString(t.second->asConstant()->constant()).toInt(0, 0);
 					else if (t.first == "value")
+					{
 						node->value = t.second->asConstant()->constant().c_str();
+						countReceivedValueBytes(t.second->asConstant()->constant().length());
+					}
 					else if (t.first == "type")
 						node->type = t.second->asConstant()->constant().c_str();
 					else if (t.first == "exp")
@@ -1491,6 +1700,8 @@ bool MainWindow::handleFilesResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult,
 		return false;
 	if (results.size() != 1 || results.at(0).variable != "files" || !results.at(0).value->asList())
 		return false;
+	/* Drop any symbols still being processed for a previously loaded executable. */
+	incrementalJobRunner.cancel(SYMBOLS_JOB_KIND);
 	sourceFiles->clear();
 	for (const auto & t : results.at(0).value->asList()->values)
 	{
@@ -1510,9 +1721,9 @@ bool MainWindow::handleFilesResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult,
 			else if (v.first == "fullname")
 				s.fullFileName = v.second->asConstant()->constant().c_str();
 		}
-		sourceFiles->operator [](s.fullFileName) = s;
+		sourceFiles->operator [](PathTable::global().fileId(s.fullFileName)) = s;
 	}
-	updateSourceListView();
+	updateSymbolViews();
 
 	/* Retrieve source line addresses for all source code files reported. */
 	for (const auto & f : sourceFiles.operator *())
@@ -1521,7 +1732,7 @@ bool MainWindow::handleFilesResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult,
 								   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LINES,
 								   f.fullFileName)
 							   );
-		sendDataToGdbProcess(QString("%1-symbol-list-lines \"%2\"\n").arg(t).arg(escapeString(f.fullFileName)));
+		sendDataToGdbProcess(QString("%1-symbol-list-lines \"%2\"\n").arg(t).arg(Utils::escapeString(f.fullFileName)));
 	}
 	unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
 				   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_FUNCTION_SYMBOLS));
@@ -1547,7 +1758,8 @@ bool MainWindow::handleFilesResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult,
 
 	emit addFilesToSearchSet(sourceCodeFilenames);
 	qRegisterMetaType<QSharedPointer<QVector<StringFinder::SearchResult>>>();
-	connect(stringFinder, SIGNAL(searchReady(QString,QSharedPointer<QVector<StringFinder::SearchResult> >,bool)), this, SLOT(stringSearchReady(QString,QSharedPointer<QVector<StringFinder::SearchResult> >,bool)));
+	connect(stringFinder, SIGNAL(searchResultsAvailable(uint,QSharedPointer<QVector<StringFinder::SearchResult> >)), this, SLOT(stringSearchResultsAvailable(uint,QSharedPointer<QVector<StringFinder::SearchResult> >)));
+	connect(stringFinder, SIGNAL(searchCompleted(uint,QString,bool)), this, SLOT(stringSearchCompleted(uint,QString,bool)));
 	fileSearchThread.start();
 
 	return true;
@@ -1562,10 +1774,11 @@ bool MainWindow::handleLinesResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult,
 		return false;
 	if (results.size() != 1 || results.at(0).variable != "lines" || !results.at(0).value->asList())
 		return false;
-	if (!sourceFiles->count(context->s))
+	FileId fileId = PathTable::global().fileId(context->s);
+	if (!sourceFiles->count(fileId))
 		return false;
 
-	SourceFileData & sourceFile(sourceFiles.operator *().operator [](context->s));
+	SourceFileData & sourceFile(sourceFiles.operator *().operator [](fileId));
 	for (const auto & t : results.at(0).value->asList()->values)
 	{
 		if (!t->asTuple())
@@ -1600,89 +1813,127 @@ bool MainWindow::handleSymbolsResponse(GdbMiParser::RESULT_CLASS_ENUM parseResul
 	const GdbMiParser::MITuple * t;
 	if (results.size() != 1 || results.at(0).variable != "symbols" || !(t = results.at(0).value->asTuple()))
 		return false;
+
+	/* The symbol lists can be very large, so they are applied incrementally, in order not to block the user interface. */
+	struct SymbolsJobState
+	{
+		/* Keep the parsed gdb response alive while the job is running. */
+		std::vector<GdbMiParser::MIResult> results;
+		std::vector<const GdbMiParser::MITuple *> sources;
+		enum GdbTokenContext::GdbResponseContext::GDB_RESPONSE_ENUM gdbResponseCode;
+		size_t sourceIndex = 0, symbolIndex = 0;
+	};
+	std::shared_ptr<SymbolsJobState> state = std::make_shared<SymbolsJobState>();
+	state->results = results;
+	state->gdbResponseCode = context->gdbResponseCode;
 	for (const auto & x : t->map)
 	{
 		const GdbMiParser::MIList * sources;
 		if (x.first == "debug" && (sources = x.second->asList()))
-		{
 			for (const auto & s : sources->values)
-			{
-				const GdbMiParser::MITuple * t = s->asTuple();
-				if (!t)
-					continue;
+				if (s->asTuple())
+					state->sources.push_back(s->asTuple());
+	}
 
-				QString fullFileName, gdbReportedFileName;
-				std::vector<SourceFileData::SymbolData> symbols;
-				const GdbMiParser::MIList * symbolList;
-				for (const auto & x : t->map)
-					if (x.first == "fullname")
-						fullFileName = QString::fromStdString(x.second->asConstant()->constant());
-					else if (x.first == "filename")
-						gdbReportedFileName = QString::fromStdString(x.second->asConstant()->constant());
-					else if (x.first == "symbols" && (symbolList = x.second->asList()))
-					{
-						const GdbMiParser::MITuple * misymbol;
-						for (const auto & s : symbolList->values)
-						{
-							SourceFileData::SymbolData symbol;
-
-							if (!(misymbol = s->asTuple()))
-								continue;
-							for (const auto & s : misymbol->map)
-								if (s.first == "line")
-									symbol.line = QString::fromStdString(s.second->asConstant()->constant()).toInt();
-								else if (s.first == "name")
-									symbol.name = QString::fromStdString(s.second->asConstant()->constant());
-								else if (s.first == "type")
-									symbol.type = QString::fromStdString(s.second->asConstant()->constant());
-								else if (s.first == "description")
-									symbol.description = QString::fromStdString(s.second->asConstant()->constant());
-							if (symbol.line != -1)
-								/* The source code line number should not normally be set for some symbols,
-								 * for example base types. Discard such symbols, as they would most probably
-								 * not be informative. */
-								symbols.push_back(symbol);
-						}
-					}
-				if (!sourceFiles.operator *().count(fullFileName))
-				{
-					/* Symbols found for a file, which was not reported by gdb in the list of source code files
-					 * by the response of the "-file-list-exec-source-files" machine interface command.
-					 * This is possible when gdb replies to a "-symbol-info-types" machine interface command,
-					 * and the reported filename in the response was not previously present in the reply of
-					 * the "-file-list-exec-source-files" command.
-					 * So, create a new file entry here. */
-					SourceFileData s;
-					s.fileName = QFileInfo(gdbReportedFileName).fileName();
-					s.gdbReportedFileName = gdbReportedFileName;
-					s.fullFileName = fullFileName;
-					/* Force the "SourceFileData" to true so that the file does not appear when only files
-					 * with machine code are being shown. */
-					s.isSourceLinesFetched = true;
-					sourceFiles->operator[](fullFileName) = s;
-				}
-				if (context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_FUNCTION_SYMBOLS)
-					sourceFiles->operator [](fullFileName).subprograms.insert(symbols.cbegin(), symbols.cend());
-				else if (context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VARIABLE_SYMBOLS)
-					sourceFiles->operator [](fullFileName).variables.insert(symbols.cbegin(), symbols.cend());
-				else
-					sourceFiles->operator [](fullFileName).dataTypes.insert(symbols.cbegin(), symbols.cend());
-			}
+	auto step = [=] () -> bool
+	{
+		if (state->sourceIndex == state->sources.size())
+			return false;
+		const GdbMiParser::MITuple * t = state->sources.at(state->sourceIndex);
+		QString fullFileName, gdbReportedFileName;
+		const GdbMiParser::MIList * symbolList = 0;
+		for (const auto & x : t->map)
+			if (x.first == "fullname")
+				fullFileName = QString::fromStdString(x.second->asConstant()->constant());
+			else if (x.first == "filename")
+				gdbReportedFileName = QString::fromStdString(x.second->asConstant()->constant());
+			else if (x.first == "symbols")
+				symbolList = x.second->asList();
+
+		FileId fileId = PathTable::global().fileId(fullFileName);
+		if (!sourceFiles.operator *().count(fileId))
+		{
+			/* Symbols found for a file, which was not reported by gdb in the list of source code files
+			 * by the response of the "-file-list-exec-source-files" machine interface command.
+			 * This is possible when gdb replies to a "-symbol-info-types" machine interface command,
+			 * and the reported filename in the response was not previously present in the reply of
+			 * the "-file-list-exec-source-files" command.
+			 * So, create a new file entry here. */
+			SourceFileData s;
+			s.fileName = QFileInfo(gdbReportedFileName).fileName();
+			s.gdbReportedFileName = gdbReportedFileName;
+			s.fullFileName = fullFileName;
+			/* Force the "SourceFileData" to true so that the file does not appear when only files
+			 * with machine code are being shown. */
+			s.isSourceLinesFetched = true;
+			sourceFiles->operator[](fileId) = s;
 		}
-	}
+		SourceFileData & sourceFile = sourceFiles->operator [](fileId);
+		auto & symbols =
+			(state->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_FUNCTION_SYMBOLS) ? sourceFile.subprograms :
+			(state->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VARIABLE_SYMBOLS) ? sourceFile.variables : sourceFile.dataTypes;
 
-	/* Update the list of source code files that are searched. */
-	QStringList sourceCodeFilenames;
-	for (const auto & f : sourceFiles.operator *())
-		sourceCodeFilenames << f.fullFileName;
+		size_t symbolCount = symbolList ? symbolList->values.size() : 0, i;
+		for (i = 0; state->symbolIndex < symbolCount && i < SYMBOLS_PER_JOB_STEP; state->symbolIndex ++, i ++)
+		{
+			const GdbMiParser::MITuple * misymbol;
+			SourceFileData::SymbolData symbol;
 
-	emit addFilesToSearchSet(sourceCodeFilenames);
+			if (!(misymbol = symbolList->values.at(state->symbolIndex)->asTuple()))
+				continue;
+			for (const auto & s : misymbol->map)
+				if (s.first == "line")
+					symbol.line = QString::fromStdString(s.second->asConstant()->constant()).toInt();
+				else if (s.first == "name")
+					symbol.nameId = StringPool::global().intern(s.second->asConstant()->constant());
+				else if (s.first == "type")
+					symbol.typeId = StringPool::global().intern(s.second->asConstant()->constant());
+				else if (s.first == "description")
+					symbol.descriptionId = StringPool::global().intern(s.second->asConstant()->constant());
+			if (symbol.line != -1)
+				/* The source code line number should not normally be set for some symbols,
+				 * for example base types. Discard such symbols, as they would most probably
+				 * not be informative. */
+				symbols.insert(symbol);
+		}
+		if (state->symbolIndex == symbolCount)
+			state->sourceIndex ++, state->symbolIndex = 0;
+		return true;
+	};
+	auto progress = [=] () -> std::pair<int, int> { return std::pair<int, int>(state->sourceIndex, state->sources.size()); };
+	QString description = (context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_FUNCTION_SYMBOLS) ? "Loading function symbols" :
+		(context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VARIABLE_SYMBOLS) ? "Loading variable symbols" : "Loading data type symbols";
+	auto finish = [=] () -> void
+	{
+		/* Update the list of source code files that are searched. This is also done if the job is cancelled,
+		 * because files may have been added for the symbols processed so far. */
+		QStringList sourceCodeFilenames;
+		for (const auto & f : sourceFiles.operator *())
+			sourceCodeFilenames << f.fullFileName;
+
+		emit addFilesToSearchSet(sourceCodeFilenames);
+	};
+	incrementalJobRunner.enqueue(std::make_shared<IncrementalJob>(SYMBOLS_JOB_KIND, description, step, progress, finish));
 	return true;
 }
 
 bool MainWindow::handleFileExecAndSymbolsResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
 {
 	const struct GdbTokenContext::GdbResponseContext * context = gdbTokenContext.contextForTokenNumber(tokenNumber);
+	if (context && context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_EXECUTABLE_RELOADED_FOR_PROGRAMMING)
+	{
+		if (parseResult == GdbMiParser::ERROR)
+		{
+			appendLineToGdbLog(QString("Failed to reload executable file \"%1\" in gdb, not loading the program into the target").arg(context->s));
+			return true;
+		}
+		executableFileLastModified = QFileInfo(context->s).lastModified();
+		elfReader = std::make_shared<elfio>();
+		if (!elfReader->load(context->s.toStdString()))
+			elfReader.reset();
+		programTarget();
+		return true;
+	}
 	if (!context || context->gdbResponseCode != GdbTokenContext::GdbResponseContext::GDB_RESPONSE_EXECUTABLE_SYMBOL_FILE_LOADED)
 		return false;
 	if (parseResult == GdbMiParser::ERROR)
@@ -1698,6 +1949,7 @@ bool MainWindow::handleFileExecAndSymbolsResponse(GdbMiParser::RESULT_CLASS_ENUM
 	}
 
 	settings->setValue(SETTINGS_LAST_LOADED_EXECUTABLE_FILE, context->s);
+	executableFileLastModified = QFileInfo(context->s).lastModified();
 	elfReader = std::make_shared<elfio>();
 	if (!elfReader->load(context->s.toStdString()))
 		elfReader.reset();
@@ -1749,7 +2001,9 @@ bool MainWindow::handleBreakpointTableResponse(GdbMiParser::RESULT_CLASS_ENUM pa
 				else if (x.first == "file")
 					breakpointDetails.fileName = QString::fromStdString(x.second->asConstant()->constant());
 				else if (x.first == "fullname")
-					breakpointDetails.sourceCodeLocation.fullFileName = QString::fromStdString(x.second->asConstant()->constant());
+					/* Construct a new location, so that the file id gets computed for the file name. */
+					breakpointDetails.sourceCodeLocation = SourceCodeLocation(QString::fromStdString(x.second->asConstant()->constant()),
+												  breakpointDetails.sourceCodeLocation.lineNumber);
 				else if (x.first == "line")
 					breakpointDetails.sourceCodeLocation.lineNumber = QString::fromStdString(x.second->asConstant()->constant()).toULong(0, 0);
 				else if (x.first == "original-location")
@@ -1784,7 +2038,8 @@ bool MainWindow::handleBreakpointTableResponse(GdbMiParser::RESULT_CLASS_ENUM pa
 							else if (x.first == "file")
 								nestedBreakpoint.fileName = QString::fromStdString(x.second->asConstant()->constant());
 							else if (x.first == "fullname")
-								nestedBreakpoint.sourceCodeLocation.fullFileName = QString::fromStdString(x.second->asConstant()->constant());
+								nestedBreakpoint.sourceCodeLocation = SourceCodeLocation(QString::fromStdString(x.second->asConstant()->constant()),
+															 nestedBreakpoint.sourceCodeLocation.lineNumber);
 							else if (x.first == "line")
 								nestedBreakpoint.sourceCodeLocation.lineNumber = QString::fromStdString(x.second->asConstant()->constant()).toULong(0, 0);
 						}
@@ -1912,7 +2167,6 @@ bool MainWindow::handleChangelistResponse(GdbMiParser::RESULT_CLASS_ENUM parseRe
 	if (parseResult != GdbMiParser::DONE || results.size() != 1 || results.at(0).variable != "changelist" || !(changelist = results.at(0).value->asList()))
 		return false;
 
-	std::unordered_set<const GdbVarObjectTreeItem *> highlightedItems;
 	varObjectTreeItemModel.clearHighlightedVarObjectNames();
 
 	struct varObjectUpdate
@@ -1921,7 +2175,6 @@ bool MainWindow::handleChangelistResponse(GdbMiParser::RESULT_CLASS_ENUM parseRe
 		unsigned newNumChildren = 0;
 		bool isInScope = false, isTypeChanged = true;
 	};
-	std::unordered_map<QString, struct varObjectUpdate> changedVarObjects;
 
 	for (const auto & c : changelist->values)
 	{
@@ -1939,7 +2192,10 @@ bool MainWindow::handleChangelistResponse(GdbMiParser::RESULT_CLASS_ENUM parseRe
 			if (t.first == "name")
 				v.miName = QString::fromStdString(t.second->asConstant()->constant());
 			else if (t.first == "value")
+			{
 				v.value = QString::fromStdString(t.second->asConstant()->constant());
+				countReceivedValueBytes(t.second->asConstant()->constant().length());
+			}
 			else if (t.first == "new_type")
 				v.newType = QString::fromStdString(t.second->asConstant()->constant());
 			else if (t.first == "new_num_children")
@@ -1949,16 +2205,14 @@ bool MainWindow::handleChangelistResponse(GdbMiParser::RESULT_CLASS_ENUM parseRe
 			else if (t.first == "type_changed")
 				v.isTypeChanged = (t.second->asConstant()->constant() == "true" ? true : false);
 		}
-		changedVarObjects.insert({v.miName, v});
-	}
-
-	std::function<void(QModelIndex & index)> updateNode = [&](QModelIndex & index)
-	{
-		GdbVarObjectTreeItem * node = static_cast<GdbVarObjectTreeItem*>(index.internalPointer());
-		auto it = changedVarObjects.find(node->miName);
-		if (it == changedVarObjects.end())
-			return;
-		struct varObjectUpdate & v = it->second;
+		/* Each change list entry updates exactly one item. The item model emits the data change notifications
+		 * for the updated items, so that only these items get repainted. Items may be missing, e.g., if a change
+		 * list entry for a child of an item follows the entry for the item, and the children of the item have
+		 * been deleted when processing the entry for the item. */
+		QModelIndex index = varObjectTreeItemModel.indexForMiVariableName(v.miName);
+		if (!index.isValid())
+			continue;
+		const GdbVarObjectTreeItem * node = GdbVarObjectTreeItemModel::varoObjectTreeItemForIndex(index);
 		if ((!v.isInScope || v.isTypeChanged) && node->childCount())
 		{
 			sendDataToGdbProcess(QString("-var-delete -c %1\n").arg(node->miName).toLocal8Bit());
@@ -1976,37 +2230,7 @@ bool MainWindow::handleChangelistResponse(GdbMiParser::RESULT_CLASS_ENUM parseRe
 			else
 				varObjectTreeItemModel.updateNodeType(index, v.newType, v.value, v.newNumChildren);
 		}
-		highlightedItems.insert(node);
-	};
-
-	/* Mark all items in the data object tree view for updating */
-	std::function<QModelIndex(QModelIndex & root)> scan = [&](QModelIndex & root) -> QModelIndex
-	{
-		assert(root.isValid());
-		updateNode(root);
-		ui->treeViewDataObjects->update(root);
-		ui->treeViewDataObjects->update(root.siblingAtColumn(1));
-		ui->treeViewDataObjects->update(root.siblingAtColumn(2));
-		int i = 0;
-		while (true)
-		{
-			QModelIndex index = varObjectTreeItemModel.index(i ++, 0, root);
-			if (!index.isValid())
-				break;
-			scan(index);
-		}
-	};
-
-	int i = 0;
-	QModelIndex root = QModelIndex();
-	while (true)
-	{
-		QModelIndex index = varObjectTreeItemModel.index(i ++, 0, root);
-		if (!index.isValid())
-			break;
-		scan(index);
 	}
-	ui->treeViewDataObjects->update();
 
 	return true;
 }
@@ -2017,24 +2241,45 @@ bool MainWindow::handleVariablesResponse(GdbMiParser::RESULT_CLASS_ENUM parseRes
 	const GdbMiParser::MIList * variables;
 	if (parseResult != GdbMiParser::DONE || results.size() != 1 || results.at(0).variable != "variables" || !(variables = results.at(0).value->asList()))
 		return false;
+	/* Any stack variables still being processed are stale now. */
+	incrementalJobRunner.cancel(STACK_VARIABLES_JOB_KIND);
 	ui->treeWidgetStackVariables->clear();
-	for (const auto & v : variables->values)
+	struct StackVariablesJobState
 	{
-		const GdbMiParser::MITuple * variable;
-		if (!(variable = v->asTuple()))
-			continue;
-		QString name, value, hexValue = "???";
-		for (const auto & t : variable->map)
-			if (t.first == "name")
-				name = QString::fromStdString(t.second->asConstant()->constant());
-			else if (t.first == "value")
-				value = QString::fromStdString(t.second->asConstant()->constant());
-		bool ok;
-		unsigned long long t = value.toULongLong(& ok);
-		if (ok)
-			hexValue = QString("0x%1").arg(t, (t > 255) ? ((t > 0xffffffffUL) ? 0 : 8) : 2, 16, QChar('0'));
-		ui->treeWidgetStackVariables->addTopLevelItem(new QTreeWidgetItem(QStringList() << name << value << hexValue));
-	}
+		/* Keep the parsed gdb response alive while the job is running. */
+		std::vector<GdbMiParser::MIResult> results;
+		size_t index = 0;
+	};
+	std::shared_ptr<StackVariablesJobState> state = std::make_shared<StackVariablesJobState>();
+	state->results = results;
+	auto step = [=] () -> bool
+	{
+		QList<QTreeWidgetItem *> items;
+		for (; state->index < variables->values.size() && items.size() < STACK_VARIABLES_PER_JOB_STEP; state->index ++)
+		{
+			const GdbMiParser::MITuple * variable;
+			if (!(variable = variables->values.at(state->index)->asTuple()))
+				continue;
+			QString name, value, hexValue = "???";
+			for (const auto & t : variable->map)
+				if (t.first == "name")
+					name = QString::fromStdString(t.second->asConstant()->constant());
+				else if (t.first == "value")
+				{
+					value = QString::fromStdString(t.second->asConstant()->constant());
+					countReceivedValueBytes(t.second->asConstant()->constant().length());
+				}
+			bool ok;
+			unsigned long long t = value.toULongLong(& ok);
+			if (ok)
+				hexValue = QString("0x%1").arg(t, (t > 255) ? ((t > 0xffffffffUL) ? 0 : 8) : 2, 16, QChar('0'));
+			items << new QTreeWidgetItem(QStringList() << name << value << hexValue);
+		}
+		ui->treeWidgetStackVariables->addTopLevelItems(items);
+		return state->index < variables->values.size();
+	};
+	auto progress = [=] () -> std::pair<int, int> { return std::pair<int, int>(state->index, variables->values.size()); };
+	incrementalJobRunner.enqueue(std::make_shared<IncrementalJob>(STACK_VARIABLES_JOB_KIND, "Loading stack variables", step, progress));
 	return true;
 }
 
@@ -2106,9 +2351,50 @@ bool MainWindow::handleValueResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult,
 		if (ok)
 			lastKnownProgramCounter = pc;
 	}
+	else if (context && context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_MEMORY_DUMP_ADDRESS)
+	{
+		bool ok;
+		uint32_t address = QString::fromStdString(results.at(0).value->asConstant()->constant()).toUInt(& ok, 0);
+		if (ok)
+		{
+			memoryDumpModel.setRange(address, context->s.toUInt());
+			memoryDumpModel.setFetchingEnabled(true);
+		}
+	}
+	else if (context && context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VAR_OBJECT_FULL_VALUE)
+	{
+		QString value = QString::fromStdString(results.at(0).value->asConstant()->constant());
+		countReceivedValueBytes(results.at(0).value->asConstant()->constant().length());
+		varObjectTreeItemModel.setNodeValue(varObjectTreeItemModel.indexForMiVariableName(context->s), value);
+	}
+	else if (context && context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_STACK_VARIABLE_FULL_VALUE)
+	{
+		QString value = QString::fromStdString(results.at(0).value->asConstant()->constant());
+		countReceivedValueBytes(results.at(0).value->asConstant()->constant().length());
+		/* The stack variables may have been updated in the meantime. */
+		QTreeWidgetItem * item = ui->treeWidgetStackVariables->currentItem();
+		if (item && item->text(0) == context->s)
+			item->setText(1, value);
+	}
 	return true;
 }
 
+void MainWindow::countReceivedValueBytes(int byteCount)
+{
+	valueBytesReceivedSinceStop += byteCount;
+	labelValueBytesReceived->setText(QString("Value data received since halt: %1 bytes").arg(valueBytesReceivedSinceStop));
+}
+
+void MainWindow::fetchFullValue(const QString & currentValue, const QString & gdbCommand, GdbTokenContext::GdbResponseContext::GDB_RESPONSE_ENUM responseCode, const QString & name)
+{
+	if (!GdbValue::isTruncated(currentValue, VALUE_PREVIEW_MAX_ELEMENTS, VALUE_PREVIEW_REPEAT_THRESHOLD))
+		return;
+	unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(responseCode, name));
+	sendDataToGdbProcess("-gdb-set print elements unlimited\n");
+	sendDataToGdbProcess(QString("%1%2\n").arg(t).arg(gdbCommand));
+	sendDataToGdbProcess(QString("-gdb-set print elements %1\n").arg(VALUE_PREVIEW_MAX_ELEMENTS));
+}
+
 bool MainWindow::handleSequencePoints(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
 {
 	if (parseResult != GdbMiParser::DONE)
@@ -2119,8 +2405,8 @@ bool MainWindow::handleSequencePoints(GdbMiParser::RESULT_CLASS_ENUM parseResult
 	switch (context->gdbResponseCode)
 	{
 	case GdbTokenContext::GdbResponseContext::GDB_SEQUENCE_POINT_SOURCE_CODE_ADDRESSES_RETRIEVED:
-		updateSourceListView();
-		updateSymbolViews();
+		/* The symbol lists may still be being processed, update the symbol views after that. */
+		incrementalJobRunner.enqueue(SYMBOLS_JOB_KIND, [=] { updateSymbolViews(); });
 		return true;
 	default:
 		break;
@@ -2128,58 +2414,90 @@ bool MainWindow::handleSequencePoints(GdbMiParser::RESULT_CLASS_ENUM parseResult
 	return false;
 }
 
-bool MainWindow::handleVerifyTargetMemoryContentsSeqPoint(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
+bool MainWindow::handleVerifyTargetMemoryResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
 {
-	if (parseResult != GdbMiParser::DONE)
-		return false;
+	Q_UNUSED(results);
 	const struct GdbTokenContext::GdbResponseContext * context = gdbTokenContext.contextForTokenNumber(tokenNumber);
-	if (!context || context->gdbResponseCode != GdbTokenContext::GdbResponseContext::GDB_SEQUENCE_POINT_CHECK_MEMORY_CONTENTS)
+	if (!context || context->gdbResponseCode != GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VERIFY_BLOCK_CRC)
 		return false;
-	bool match = true;
-	int i = 0;
-	for (const auto & f : targetMemorySectionsTempFileNames)
+	/* The gdb server reply is printed by gdb on the console, in the form 'received: "C<crc32>"'. The console
+	 * output for the command is all of the console output captured after the response to the previous command. */
+	QRegularExpression rx("^received: \"C([0-9a-fA-F]{1,8})\"");
+	bool isCrcValid = false;
+	uint32_t crc = 0;
+	if (parseResult == GdbMiParser::DONE)
 	{
-		if (!QFileInfo(f).exists())
-		{
-			match = false;
-			QMessageBox::critical(0, "Error reading target memory", "Failed to read target memory, for verifying the target memory contents");
-			break;
-		}
-		QFile tf(f);
-		if (!tf.open(QFile::ReadOnly))
+		const QStringList & output(consoleDataCapture.capturedLines());
+		for (int i = output.size() - 1; i >= 0 && !isCrcValid; i --)
 		{
-			match = false;
-			QMessageBox::critical(0, "Error verifying target memory",
-					      QString("Failed to open temporary file\n\n"
-						      "%1\n\nwhen verifying target memory contents").arg(f));
-			break;
-		}
-		if (tf.readAll() != QByteArray(elfReader->segments[i]->get_data(), elfReader->segments[i]->get_file_size()))
-		{
-			match = false;
-			auto choice = QMessageBox::question(0, "Target memory contents mismatch",
-					      QString("The target memory contents are different from the memory contents of file:\n\n"
-						      "%1\n\n"
-						      "It is recommended that you update (reflash) the target memory.\n"
-						      "Do you want to update (reflash) the target now?"
-						      ).arg(settings->value(SETTINGS_LAST_LOADED_EXECUTABLE_FILE, "???").toString()),
-							    QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
-			if (choice == QMessageBox::Yes)
-				ui->actionLoadProgramIntoTarget->trigger();
-			break;
+			QRegularExpressionMatch match = rx.match(output.at(i));
+			if (match.hasMatch())
+				crc = match.captured(1).toUInt(& isCrcValid, 16);
 		}
-		i ++;
 	}
-	for (const auto & f : targetMemorySectionsTempFileNames)
+	consoleDataCapture.startCapture();
+	if (!targetMemoryVerifier.isActive() || !targetMemoryVerifier.crcReceived(context->s.toInt(), isCrcValid, crc))
+		return true;
+	consoleDataCapture.stopCapture();
+	/* All checksums received - read back the blocks that differ, or whose checksums are not available. The reads
+	 * are sent directly to gdb, and not through the target memory cache, as the cached data may be stale. */
+	std::vector<int> indices = targetMemoryVerifier.startReadBack();
+	if (indices.empty())
 	{
-		QFile tf(f);
-		tf.remove();
+		reportTargetMemoryVerification();
+		return true;
 	}
-	if (match)
-		QMessageBox::information(0, "Target memory contents match", "Target memory contents match");
+	QString gdbRequest;
+	for (const auto & i : indices)
+	{
+		const TargetMemoryVerifier::Block & b = targetMemoryVerifier.blocks().at(i);
+		unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
+				GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VERIFY_BLOCK_READ, QString::number(i)));
+		gdbRequest += QString("%1-data-read-memory-bytes 0x%2 %3\n").arg(t).arg(b.address, 0, 16).arg(b.expectedData.length());
+	}
+	sendDataToGdbProcess(gdbRequest);
 	return true;
 }
 
+void MainWindow::reportTargetMemoryVerification()
+{
+	targetMemoryVerifier.finish();
+	if (targetMemoryVerifier.isReadBackFailed())
+	{
+		QMessageBox::critical(0, "Error reading target memory", "Failed to read target memory, for verifying the target memory contents");
+		return;
+	}
+	std::vector<std::pair<uint32_t, uint32_t>> differences = targetMemoryVerifier.differences();
+	/* A block may have a mismatching checksum, but identical contents, if the target memory changed after
+	 * the checksum was computed. Do not report such blocks. */
+	if (differences.empty())
+	{
+		QMessageBox::information(0, "Target memory contents match", "Target memory contents match");
+		return;
+	}
+	enum { MAX_REPORTED_DIFFERENCES = 10, };
+	QString s;
+	uint32_t differentBytes = 0;
+	for (const auto & d : differences)
+		differentBytes += d.second - d.first;
+	for (int i = 0; i < std::min((int) differences.size(), (int) MAX_REPORTED_DIFFERENCES); i ++)
+		s += QString("0x%1 - 0x%2\n").arg(differences.at(i).first, 8, 16, QChar('0')).arg(differences.at(i).second - 1, 8, 16, QChar('0'));
+	if (differences.size() > MAX_REPORTED_DIFFERENCES)
+		s += QString("... and %1 more areas\n").arg(differences.size() - MAX_REPORTED_DIFFERENCES);
+	auto choice = QMessageBox::question(0, "Target memory contents mismatch",
+			      QString("The target memory contents are different from the memory contents of file:\n\n"
+				      "%1\n\n"
+				      "%2 bytes differ, in the address ranges:\n\n"
+				      "%3\n"
+				      "It is recommended that you update (reflash) the target memory.\n"
+				      "Do you want to update (reflash) the target now?"
+				      ).arg(settings->value(SETTINGS_LAST_LOADED_EXECUTABLE_FILE, "???").toString())
+					.arg(differentBytes).arg(s),
+					    QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+	if (choice == QMessageBox::Yes)
+		ui->actionLoadProgramIntoTarget->trigger();
+}
+
 bool MainWindow::handleTargetScanResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
 {
 	const struct GdbTokenContext::GdbResponseContext * context = gdbTokenContext.contextForTokenNumber(tokenNumber);
@@ -2232,20 +2550,99 @@ bool MainWindow::handleTargetScanResponse(GdbMiParser::RESULT_CLASS_ENUM parseRe
 bool MainWindow::handleMemoryResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
 {
 	const struct GdbTokenContext::GdbResponseContext * context = gdbTokenContext.contextForTokenNumber(tokenNumber);
+	bool isFrontendRead = context && (context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_DATA_READ_MEMORY
+			|| context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_READ
+			|| context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_REGISTER_READ
+			|| context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_SNAPSHOT_READ
+			|| context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VERIFY_BLOCK_READ);
 	if (parseResult == GdbMiParser::ERROR)
 	{
-		/* If there is an error reading the target memory, disable the auto update of the memory view. */
-		if (context && context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_DATA_READ_MEMORY)
-			ui->checkBoxMemoryDumpAutoUpdate->setChecked(false);
+		/* Failed reads are reported by the views that requested them, do not report them as gdb errors. */
+		if (isFrontendRead)
+			completeTargetMemoryRead(* context, QByteArray());
+		return isFrontendRead;
+	}
+	uint32_t address;
+	QByteArray data;
+	if (parseResult != GdbMiParser::DONE || !parseMemoryResponse(results, address, data))
 		return false;
+	/* Also cache the results of memory reads not requested by the frontend, e.g. reads entered in the gdb command line. */
+	targetMemoryCache.insert(address, data);
+	if (isFrontendRead)
+		completeTargetMemoryRead(* context, data);
+	return true;
+}
+
+void MainWindow::readTargetMemory(uint32_t address, uint32_t length, const GdbTokenContext::GdbResponseContext & context)
+{
+	QByteArray data;
+	if (targetMemoryCache.lookup(address, length, data))
+	{
+		/* Complete cached reads asynchronously, the same way as reads through gdb are completed. */
+		QTimer::singleShot(0, this, [=] { completeTargetMemoryRead(context, data); });
+		return;
+	}
+	unsigned t = gdbTokenContext.insertContext(context);
+	sendDataToGdbProcess(QString("%1-data-read-memory-bytes 0x%2 %3\n").arg(t).arg(address, 0, 16).arg(length));
+}
+
+void MainWindow::completeTargetMemoryRead(const GdbTokenContext::GdbResponseContext & context, const QByteArray & data)
+{
+	switch (context.gdbResponseCode)
+	{
+	case GdbTokenContext::GdbResponseContext::GDB_RESPONSE_DATA_READ_MEMORY:
+		memoryDumpModel.readCompleted(context.s.toUInt(), data);
+		break;
+	case GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_READ:
+		liveWatchEngine.memoryReadCompleted(context.s.toUInt(), data);
+		break;
+	case GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_REGISTER_READ:
+	{
+		QStringList range = context.s.split(' ');
+		uint32_t address = range.at(0).toUInt(), length = range.at(1).toUInt();
+		if (!data.isEmpty())
+		{
+			updateSvdRegisterViews(address, data);
+			break;
+		}
+		/* If reading a range of registers failed, retry by reading the registers one by one, so that
+		 * an inaccessible register does not prevent the other registers from being displayed. */
+		QSet<uint32_t> registerAddresses;
+		for (const auto & view : svdViews)
+			if (view.address >= address && view.address - address < length)
+				registerAddresses.insert(view.address);
+		if (registerAddresses.size() < 2)
+			break;
+		for (const auto & view : svdViews)
+			if (registerAddresses.remove(view.address))
+				readTargetMemory(view.address, view.size, GdbTokenContext::GdbResponseContext(
+							 GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_REGISTER_READ, QString("%1 %2").arg(view.address).arg(view.size)));
+		break;
+	}
+	case GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_SNAPSHOT_READ:
+	{
+		QStringList range = context.s.split(' ');
+		completeSvdSnapshotRead(range.at(0).toUInt(), range.at(1).toUInt(), data);
+		break;
 	}
+	case GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VERIFY_BLOCK_READ:
+		if (targetMemoryVerifier.isActive() && targetMemoryVerifier.readBackCompleted(context.s.toInt(), data))
+			reportTargetMemoryVerification();
+		break;
+	default:
+		break;
+	}
+}
+
+bool MainWindow::parseMemoryResponse(const std::vector<GdbMiParser::MIResult> & results, uint32_t & address, QByteArray & data)
+{
 	const GdbMiParser::MIList * l;
 	const GdbMiParser::MITuple * t;
-	if (parseResult != GdbMiParser::DONE || !results.size() || results.at(0).variable != "memory"
+	if (!results.size() || results.at(0).variable != "memory"
 		|| !results.at(0).value || !(l = results.at(0).value->asList()) || !l->values.size() || !(t = l->values.at(0)->asTuple()))
 		return false;
-	uint32_t address = 0;
-	QByteArray data;
+	address = 0;
+	data.clear();
 	for (const auto & x : t->map)
 	{
 		if (x.first == "begin")
@@ -2255,25 +2652,114 @@ bool MainWindow::handleMemoryResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult
 		if (x.first == "contents")
 			data += QByteArray::fromHex(QString::fromStdString(x.second->asConstant()->constant()).toLocal8Bit());
 	}
-	if (data.length() == 4)
+	return true;
+}
+
+bool MainWindow::handleLiveWatchResponse(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
+{
+	const struct GdbTokenContext::GdbResponseContext * context = gdbTokenContext.contextForTokenNumber(tokenNumber);
+	if (!context)
+		return false;
+	if (context->gdbResponseCode != GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_ADDRESS
+			&& context->gdbResponseCode != GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_SIZE)
+		return false;
+	int id = context->s.toInt();
+	if (parseResult == GdbMiParser::ERROR)
 	{
-		uint32_t d = data.at(0) | (data.at(1) << 8) | (data.at(2) << 16) | (data.at(3) << 24);
-		/* Update any svd register views. */
-		for (const auto & r : svdViews)
-			if (r.address == address)
-				for (auto & f : r.fields)
-					f.spinbox->setValue((d >> f.bitoffset) & ((1 << f.bitwidth) - 1));
+		/* Both the address and the size evaluation of an invalid expression fail, only report the first error. */
+		if (!liveWatchEngine.hasWatch(id))
+			return true;
+		liveWatchEngine.removeWatch(id);
+		updateLiveWatchView();
+		return false;
 	}
-	/* Check if the memory dump view should be updated. */
-	if (context && context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_DATA_READ_MEMORY)
+	if (parseResult != GdbMiParser::DONE || results.size() != 1 || results.at(0).variable != "value" || !results.at(0).value->asConstant())
+		return false;
+	bool ok;
+	uint32_t value = QString::fromStdString(results.at(0).value->asConstant()->constant()).toUInt(& ok, 0);
+	if (ok)
 	{
-		ui->plainTextEditMemoryDump->clear();
-		ui->plainTextEditMemoryDump->appendPlainText(data.toHex());
+		if (context->gdbResponseCode == GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_ADDRESS)
+			liveWatchEngine.setWatchAddress(id, value);
+		else
+			liveWatchEngine.setWatchSize(id, value);
 	}
-
+	updateLiveWatchView();
 	return true;
 }
 
+void MainWindow::addLiveWatch(const QString & expression)
+{
+	QString e = expression.trimmed();
+	if (e.isEmpty())
+		return;
+	int id = liveWatchEngine.addWatch(e);
+	/* Plain target memory addresses, optionally followed by a size, are watched without evaluating them by gdb. */
+	QRegularExpression rx("^(0x[0-9a-fA-F]+|\\d+)\\s*(,\\s*(0x[0-9a-fA-F]+|\\d+))?$");
+	QRegularExpressionMatch match = rx.match(e);
+	if (match.hasMatch())
+	{
+		liveWatchEngine.setWatchAddress(id, match.captured(1).toUInt(0, 0));
+		liveWatchEngine.setWatchSize(id, match.captured(3).isEmpty() ? sizeof(uint32_t) : match.captured(3).toUInt(0, 0));
+	}
+	else
+	{
+		QString quotedExpression = QString(e).replace('\\', "\\\\").replace('"', "\\\"");
+		unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
+								   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_ADDRESS, QString::number(id)));
+		sendDataToGdbProcess(QString("%1-data-evaluate-expression \"(unsigned) &(%2)\"\n").arg(t).arg(quotedExpression));
+		t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
+							  GdbTokenContext::GdbResponseContext::GDB_RESPONSE_LIVE_WATCH_SIZE, QString::number(id)));
+		sendDataToGdbProcess(QString("%1-data-evaluate-expression \"sizeof(%2)\"\n").arg(t).arg(quotedExpression));
+	}
+	updateLiveWatchView();
+}
+
+void MainWindow::updateLiveWatchView(void)
+{
+	const std::vector<LiveWatchEngine::Watch> & watches = liveWatchEngine.watches();
+	if (ui->treeWidgetLiveWatch->topLevelItemCount() != (int) watches.size())
+	{
+		ui->treeWidgetLiveWatch->clear();
+		for (const auto & w : watches)
+		{
+			QTreeWidgetItem * item = new QTreeWidgetItem(QStringList() << w.expression);
+			item->setData(0, Qt::UserRole, w.id);
+			ui->treeWidgetLiveWatch->addTopLevelItem(item);
+		}
+	}
+	for (size_t i = 0; i < watches.size(); i ++)
+	{
+		const LiveWatchEngine::Watch & w = watches.at(i);
+		QTreeWidgetItem * item = ui->treeWidgetLiveWatch->topLevelItem(i);
+		if (!w.isResolved())
+		{
+			item->setText(1, "<evaluating...>");
+			continue;
+		}
+		item->setText(1, QString("0x%1, %2 bytes").arg(w.address, 8, 16, QChar('0')).arg(w.size));
+		item->setText(3, QString::number(w.samples.size()));
+		if (!w.samples.size())
+			continue;
+		const QByteArray & data = w.samples.latest().data;
+		QString value;
+		if (w.size == 1 || w.size == 2 || w.size == 4 || w.size == 8)
+		{
+			/* Assume a little endian target. */
+			uint64_t x = 0;
+			for (int b = data.size() - 1; b >= 0; b --)
+				x = (x << 8) | (uint8_t) data.at(b);
+			value = QString("0x%1 (%2)").arg(x, w.size * 2, 16, QChar('0')).arg(x);
+		}
+		else
+			value = data.toHex(' ');
+		item->setText(2, value);
+	}
+	const LiveWatchEngine::Statistics & s = liveWatchEngine.statistics();
+	ui->labelLiveWatchStatus->setText(QString("%1 reads per sample, %2 samples taken, %3 samples skipped, %4 reads failed")
+					  .arg(s.readsPerRound).arg(s.completedRounds).arg(s.skippedRounds).arg(s.failedReads));
+}
+
 void MainWindow::handleGdbError(GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> &results, unsigned tokenNumber)
 {
 	if (parseResult != GdbMiParser::ERROR)
@@ -2399,11 +2885,27 @@ void MainWindow::sendDataToGdbProcess(const QString & data, bool isFrontendIssue
 	else
 		appendLineToGdbLog("gdb process not running!!! Cannot send data to gdb");
 }
-void MainWindow::readGdbVarObjectChildren(const QString varObjectName)
+void MainWindow::readGdbVarObjectChildren(const QString varObjectName, int from, int to)
 {
 	unsigned n = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
 							   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_NUMCHILD, varObjectName));
-	sendDataToGdbProcess((QString("%1-var-list-children --all-values ").arg(n) + varObjectName + "\n"));
+	sendDataToGdbProcess((QString("%1-var-list-children --all-values ").arg(n) + varObjectName + QString(" %1 %2\n").arg(from).arg(to)));
+}
+
+void MainWindow::scanVisibleVarObjects()
+{
+	QTreeView * view = ui->treeViewDataObjects;
+	int viewportHeight = view->viewport()->height();
+	for (QModelIndex index = view->indexAt(QPoint(0, 0)); index.isValid() && view->visualRect(index).top() < viewportHeight; index = view->indexBelow(index))
+		varObjectTreeItemModel.markIndexAsVisible(index);
+}
+
+void MainWindow::evictVarObjectPages()
+{
+	/* Take into account the items that are visible right now. */
+	scanVisibleVarObjects();
+	for (const auto & miName : varObjectTreeItemModel.evictStalePages(VAR_OBJECT_PAGE_EVICTION_TIME_MS))
+		sendDataToGdbProcess(QString("-var-delete %1\n").arg(miName));
 }
 
 bool MainWindow::showSourceCode(const QTreeWidgetItem *item)
@@ -2423,6 +2925,24 @@ bool MainWindow::showSourceCode(const QTreeWidgetItem *item)
 	return displaySourceCodeFile(SourceCodeLocation(sourceFileName, lineNumber), true, true);
 }
 
+bool MainWindow::showSourceCode(const QModelIndex & index)
+{
+	if (!index.isValid())
+		return false;
+	if (index.data(SourceFileData::DISABLE_SOURCE_CODE_NAVIGATION).toBool())
+		return false;
+	QVariant v = index.data(SourceFileData::FILE_NAME);
+	bool ok;
+	if (v.type() != QMetaType::QString)
+		return false;
+	int lineNumber = index.data(SourceFileData::LINE_NUMBER).toInt(& ok);
+	if (!ok)
+		return false;
+	if (lineNumber == 0)
+		lineNumber = 1;
+	return displaySourceCodeFile(SourceCodeLocation(v.toString(), lineNumber), true, true);
+}
+
 void MainWindow::breakpointsContextMenuRequested(QPoint p)
 {
 	QTreeWidgetItem * w = ui->treeWidgetBreakpoints->itemAt(p);
@@ -2462,10 +2982,24 @@ void MainWindow::breakpointsContextMenuRequested(QPoint p)
 
 void MainWindow::svdContextMenuRequested(QPoint p)
 {
-	QTreeWidgetItem * w = ui->treeWidgetSvd->itemAt(p);
-	if (w)
+	QModelIndex w = ui->treeViewSvd->indexAt(p);
+	if (w.isValid())
 	{
-		if (w->data(0, SVD_REGISTER_POINTER).isNull())
+		w = w.sibling(w.row(), 0);
+		if (!w.data(SvdTreeModel::SVD_PERIPHERAL_INDEX).isNull())
+		{
+			QMenu menu(this);
+			QAction * snapshotAction = menu.addAction("Take peripheral snapshot");
+			QAction * compareAction = menu.addAction("Compare snapshots...");
+			menu.addAction("Cancel");
+			QAction * selection = menu.exec(ui->treeViewSvd->viewport()->mapToGlobal(p));
+			if (selection == snapshotAction)
+				takeSvdPeripheralSnapshot(w.data(SvdTreeModel::SVD_PERIPHERAL_INDEX).toUInt());
+			else if (selection == compareAction)
+				compareSvdSnapshots();
+			return;
+		}
+		if (w.data(SvdTreeModel::SVD_REGISTER_INDEX).isNull())
 			return;
 		QMenu menu(this);
 		QAction * readRegisterAction = menu.addAction("Read register");
@@ -2474,52 +3008,54 @@ void MainWindow::svdContextMenuRequested(QPoint p)
 		/* Because of the header of the tree widget, it looks more natural to set the
 		 * menu position on the screen at point translated from the tree widget viewport,
 		 * not from the tree widget itself. */
-		QAction * selection = menu.exec(ui->treeWidgetSvd->viewport()->mapToGlobal(p));
+		QAction * selection = menu.exec(ui->treeViewSvd->viewport()->mapToGlobal(p));
 		if (selection)
 		{
 			if (selection == readRegisterAction)
 			{
-				uint32_t address = w->data(0, SVD_REGISTER_ADDRESS).toUInt();
+				uint32_t address = w.data(SvdTreeModel::SVD_REGISTER_ADDRESS).toUInt();
 				sendDataToGdbProcess(QString("-data-evaluate-expression \"*(unsigned int*)0x%1\"\n").arg(address,0, 16, QChar('0')));
 			}
 			else if (selection == createViewAction)
 			{
-				createSvdRegisterView(w, 0);
+				createSvdRegisterView(w);
 			}
 		}
 	}
 }
 
-void MainWindow::sourceItemContextMenuRequested(const QTreeWidget *treeWidget, QPoint p)
+void MainWindow::sourceItemContextMenuRequested(const QAbstractItemView *view, QPoint p)
 {
-	QTreeWidgetItem * w = treeWidget->itemAt(p);
+	/* All item data of interest is stored in the first column. */
+	QModelIndex w = view->indexAt(p);
+	w = w.sibling(w.row(), 0);
 
-	if (w)
+	if (w.isValid())
 	{
-		if (w->data(0, SourceFileData::ITEM_KIND).isNull())
+		if (w.data(SourceFileData::ITEM_KIND).isNull())
 		{
 			qDebug() << "warning: unset source item type, aborting context menu request";
 			return;
 		}
-		if (!w->data(0, SourceFileData::DISABLE_CONTEXT_MENU).isNull() && w->data(0, SourceFileData::DISABLE_CONTEXT_MENU).toBool())
+		if (!w.data(SourceFileData::DISABLE_CONTEXT_MENU).isNull() && w.data(SourceFileData::DISABLE_CONTEXT_MENU).toBool())
 			return;
-		QList<QTreeWidgetItem *> items = treeWidget->findItems(w->text(0), Qt::MatchExactly);
-		SourceFileData::SymbolData::SymbolKind itemKind = (SourceFileData::SymbolData::SymbolKind) w->data(0, SourceFileData::ITEM_KIND).toUInt();
+		QModelIndexList items = view->model()->match(view->model()->index(0, 0), Qt::DisplayRole, w.data(), -1, Qt::MatchExactly);
+		SourceFileData::SymbolData::SymbolKind itemKind = (SourceFileData::SymbolData::SymbolKind) w.data(SourceFileData::ITEM_KIND).toUInt();
 		/*! \todo	At this time, the case for multiple symbols of the same kind is not handled well.
 		 *		As a minimum, warn the user about this. */
 		int t = 0;
 		for (const auto & s : items)
 		{
-			if (s->data(0, SourceFileData::ITEM_KIND).isNull())
+			if (s.data(SourceFileData::ITEM_KIND).isNull())
 				continue;
-			if ((SourceFileData::SymbolData::SymbolKind) s->data(0, SourceFileData::ITEM_KIND).toUInt() == itemKind)
+			if ((SourceFileData::SymbolData::SymbolKind) s.data(SourceFileData::ITEM_KIND).toUInt() == itemKind)
 				t ++;
 		}
 		if (t > 1)
 			QMessageBox::warning(0, "Multiple symbols of the same kind",
 					     QString("Multiple symbols found for id:\n\n%1\n\n"
 						     "Be warned that this case is not handled properly at this time.\n"
-						     "You may experience incorrect behavior from the frontend!").arg(w->text(0)));
+						     "You may experience incorrect behavior from the frontend!").arg(w.data().toString()));
 		QMenu menu(this);
 		QAction * disassembleFile = 0, * disassembleSuprogram = 0, * insertBreakpoint = 0;
 		/* Because of the header of the tree widget, it looks more natural to set the
@@ -2543,25 +3079,25 @@ void MainWindow::sourceItemContextMenuRequested(const QTreeWidget *treeWidget, Q
 		}
 
 		menu.addAction("Cancel");
-		QAction * selection = menu.exec(treeWidget->viewport()->mapToGlobal(p));
+		QAction * selection = menu.exec(view->viewport()->mapToGlobal(p));
 		if (selection)
 		{
 			if (selection == disassembleFile)
 				/*! \todo	This does not work for disassembling whole files. It just disassembles the very first
 				 *		function in the file, if any. */
-				sendDataToGdbProcess(QString("-data-disassemble -f \"%1\" -l 1 -- 5\n").arg(w->text(0)));
+				sendDataToGdbProcess(QString("-data-disassemble -f \"%1\" -l 1 -- 5\n").arg(w.data().toString()));
 			else if (selection == disassembleSuprogram)
 			{
-				QString disassemblyTarget = QString("-a \"%1\" -- 5").arg(w->text(0));
-				QVariant v = w->data(0, SourceFileData::DISASSEMBLY_TARGET_COORDINATES);
+				QString disassemblyTarget = QString("-a \"%1\" -- 5").arg(w.data().toString());
+				QVariant v = w.data(SourceFileData::DISASSEMBLY_TARGET_COORDINATES);
 				if (v.isValid())
 					disassemblyTarget = v.toString();
 				sendDataToGdbProcess(QString("-data-disassemble %1\n").arg(disassemblyTarget));
 			}
 			else if (selection == insertBreakpoint)
 			{
-				QString breakpointTarget = QString("--function \"%1\"").arg(w->text(0));
-				QVariant v = w->data(0, SourceFileData::BREAKPOINT_TARGET_COORDINATES);
+				QString breakpointTarget = QString("--function \"%1\"").arg(w.data().toString());
+				QVariant v = w.data(SourceFileData::BREAKPOINT_TARGET_COORDINATES);
 				if (v.isValid())
 					breakpointTarget = v.toString();
 				sendDataToGdbProcess(QString("-break-insert %1\n").arg(breakpointTarget));
@@ -2621,8 +3157,9 @@ void MainWindow::varObjectContextMenuRequested(QPoint p)
 		{
 		case 1:
 			/* Delete varObject. */
-			varObjectTreeItemModel.removeTopLevelItem(index);
 			sendDataToGdbProcess(QString("-var-delete %1\n").arg(varObject->miName));
+			/* This deletes the varobject item. */
+			varObjectTreeItemModel.removeTopLevelItem(index);
 			break;
 		default:
 			break;
@@ -2645,17 +3182,39 @@ void MainWindow::breakpointViewItemChanged(QTreeWidgetItem *item, int column)
 	sendDataToGdbProcess("-break-list\n");
 }
 
-void MainWindow::stringSearchReady(const QString pattern, QSharedPointer<QVector<StringFinder::SearchResult>> results, bool resultsTruncated)
+void MainWindow::searchSourceFilesForText(const QString & text)
 {
+	/* Starting a new search generation abandons any search that is still in progress. */
+	stringSearchGeneration = stringFinder->startNewSearchGeneration();
 	ui->treeWidgetSearchResults->clear();
-	ui->lineEditSearchFilesForText->setText(pattern);
+	emit findString(text, ui->checkBoxSearchForWholeWordsOnly->isChecked() ? StringFinder::SEARCH_FOR_WHOLE_WORDS_ONLY : 0, stringSearchGeneration);
+}
+
+void MainWindow::findReferencesToIdentifier(const QString & identifier)
+{
+	stringSearchGeneration = stringFinder->startNewSearchGeneration();
+	ui->treeWidgetSearchResults->clear();
+	emit findIdentifierReferences(identifier, stringSearchGeneration);
+}
+
+void MainWindow::stringSearchResultsAvailable(unsigned generation, QSharedPointer<QVector<StringFinder::SearchResult>> results)
+{
+	if (generation != stringSearchGeneration)
+		return;
+	/* The search results are received in order, so they are not sorted here. */
 	for (const auto & result : * results)
 		ui->treeWidgetSearchResults->addTopLevelItem(createNavigationWidgetItem(
 			     QStringList() << QFileInfo(result.fullFileName).fileName() << QString("%1").arg(result.lineNumber) << result.sourceCodeLineText,
 			     result.fullFileName,
 			     result.lineNumber
 			     ));
-	ui->treeWidgetSearchResults->sortByColumn(0, Qt::AscendingOrder);
+}
+
+void MainWindow::stringSearchCompleted(unsigned generation, const QString pattern, bool resultsTruncated)
+{
+	if (generation != stringSearchGeneration)
+		return;
+	ui->lineEditSearchFilesForText->setText(pattern);
 	if (resultsTruncated)
 		ui->treeWidgetSearchResults->addTopLevelItem(new QTreeWidgetItem(QStringList() << "" << "xxx" << "Too many results - search results truncated"));
 }
@@ -2664,81 +3223,85 @@ void MainWindow::updateSourceListView()
 {
 bool showOnlySourcesWithMachineCode = ui->actionSourceFilesShowOnlyFilesWithMachineCode->isChecked();
 bool showOnlyExistingSourceFiles = ui->actionSourceFilesShowOnlyExistingFiles->isChecked();
+std::shared_ptr<QHash<FileId, SourceFileData>> sourceFiles = this->sourceFiles;
+PathResolver * pathResolver = & this->pathResolver;
 
-	std::function<bool(const SourceFileData & fileData)> shouldFileBeListed = [&] (const SourceFileData & fileData) -> bool
+	if (showOnlyExistingSourceFiles)
 	{
-		if (showOnlyExistingSourceFiles)
-		{
-			/* WARNING: this is potentially expensive! */
-			QFileInfo f(fileData.fullFileName);
-			if (!f.exists())
-				return false;
-		}
+		/* Check for the existence of the source files in the background. Files whose existence is not yet
+		 * known are shown, the view is updated again when the existence checks complete. */
+		std::vector<FileId> fileIds;
+		for (auto f = sourceFiles->cbegin(); f != sourceFiles->cend(); f ++)
+			fileIds.push_back(f.key());
+		pathResolver->checkExistence(fileIds);
+	}
+	sourceFilesModel.setFilter([=] (const SymbolIndex::Symbol & sourceFile) -> bool
+	{
+		FileId fileId = sourceFile.fileId;
+		const auto f = sourceFiles->constFind(fileId);
+		if (f == sourceFiles->cend())
+			return false;
+		const SourceFileData & fileData = f.value();
+		if (showOnlyExistingSourceFiles && pathResolver->existence(fileId) == PathResolver::DOES_NOT_EXIST)
+			return false;
 		return !showOnlySourcesWithMachineCode || /* This is a safe-catch. */ !fileData.isSourceLinesFetched || fileData.machineCodeLineNumbers.size();
-	};
-	ui->treeWidgetSourceFiles->clear();
-	for (const auto & f : sourceFiles.operator *())
-		if (shouldFileBeListed(f))
-		{
-			QTreeWidgetItem * t = createNavigationWidgetItem(QStringList() << f.fileName << f.fullFileName, f.fullFileName,
-									 0, SourceFileData::SymbolData::SOURCE_FILE_NAME, false, true);
-			ui->treeWidgetSourceFiles->addTopLevelItem(t);
-			for (const auto & s : f.subprograms)
-			{
-				QTreeWidgetItem * w;
-				t->addChild(w = createNavigationWidgetItem(QStringList() << s.description, f.fullFileName, s.line, SourceFileData::SymbolData::SUBPROGRAM));
-				/* Note - it is important that the '--function' argument is placed in quotation marks, because
-				 * gdb can report some function names as, e.g., 'foo(int, int)', and the spaces in such names
-				 * confuse gdb. */
-				w->setData(0, SourceFileData::DISASSEMBLY_TARGET_COORDINATES, QString(" -f \"%1\" -l %2 -n -1 -- 5")
-					   .arg(escapeString(f.fullFileName)).arg(s.line));
-				w->setData(0, SourceFileData::BREAKPOINT_TARGET_COORDINATES, QString(" --source \"%1\" --function \"%2\"")
-					   .arg(escapeString(f.fullFileName)).arg(s.name));
-			}
-		}
-	ui->treeWidgetSourceFiles->sortByColumn(0, Qt::AscendingOrder);
+	});
+}
+
+void MainWindow::editSourcePathRemapRules()
+{
+	QString text;
+	for (const auto & rule : pathResolver.remapRules())
+		text += rule.fromPrefix + " => " + rule.toPrefix + "\n";
+	bool ok;
+	text = QInputDialog::getMultiLineText(0, "Remap source file paths",
+					      "Enter one rule per line, in the form:\n"
+					      "<source path prefix, as reported by gdb> => <local source path prefix>\n\n"
+					      "Only the first matching rule is applied to a source file name.", text, & ok);
+	if (!ok)
+		return;
+	QList<PathResolver::RemapRule> rules;
+	for (const auto & line : text.split('\n'))
+	{
+		int i = line.indexOf("=>");
+		if (i == -1)
+			continue;
+		rules << PathResolver::RemapRule(line.left(i).trimmed(), line.mid(i + 2).trimmed());
+	}
+	pathResolver.setRemapRules(rules);
+	updateSourceListView();
+	if (!displayedSourceCodeFile.isEmpty())
+	{
+		/* Reload the displayed file, it may now be found at a different location. */
+		SourceCodeLocation l(displayedSourceCodeFile, ui->plainTextEditSourceView->textCursor().blockNumber() + 1);
+		displaySourceCodeFile(l, false);
+	}
 }
 
 void MainWindow::updateSymbolViews()
 {
-	ui->treeWidgetSubprograms->clear();
-	ui->treeWidgetStaticDataObjects->clear();
-	ui->treeWidgetDataTypes->clear();
-	for (const auto & f : sourceFiles.operator *())
+	/* Rebuild the symbol index, and all views backed by it. Only symbol indices are stored
+	 * in the view models, so this is cheap even for very large numbers of symbols. */
+	std::vector<SymbolIndex::Symbol> symbols;
+	for (auto f = sourceFiles->cbegin(); f != sourceFiles->cend(); f ++)
 	{
-		for (const auto & s : f.subprograms)
-		{
-			QTreeWidgetItem * w;
-			ui->treeWidgetSubprograms->addTopLevelItem(w = createNavigationWidgetItem(
-				   QStringList() << s.name << f.fileName << QString("%1").arg(s.line) << s.description,
-				   f.fullFileName,
-				   s.line,
-				   SourceFileData::SymbolData::SUBPROGRAM));
-			/* Note - it is important that the '--function' argument is placed in quotation marks, because
-			 * gdb can report some function names as, e.g., 'foo(int, int)', and the spaces in such names
-			 * confuse gdb. */
-			w->setData(0, SourceFileData::DISASSEMBLY_TARGET_COORDINATES, QString(" -f \"%1\" -l %2 -n -1 -- 5")
-				   .arg(escapeString(f.fullFileName)).arg(s.line));
-			w->setData(0, SourceFileData::BREAKPOINT_TARGET_COORDINATES, QString(" --source \"%1\" --function \"%2\"")
-				   .arg(escapeString(f.fullFileName)).arg(s.name));
-		}
-
-		for (const auto & s : f.variables)
-			ui->treeWidgetStaticDataObjects->addTopLevelItem(createNavigationWidgetItem(
-				   QStringList() << s.name << f.fileName << QString("%1").arg(s.line) << s.description,
-				   f.fullFileName,
-				   s.line,
-				   SourceFileData::SymbolData::DATA_OBJECT));
-		for (const auto & s : f.dataTypes)
-			ui->treeWidgetDataTypes->addTopLevelItem(createNavigationWidgetItem(
-				   QStringList() << s.name << f.fileName << QString("%1").arg(s.line),
-				   f.fullFileName,
-				   s.line,
-				   SourceFileData::SymbolData::DATA_TYPE));
-	}
-	ui->treeWidgetSubprograms->sortByColumn(0, Qt::AscendingOrder);
-	ui->treeWidgetStaticDataObjects->sortByColumn(0, Qt::AscendingOrder);
-	ui->treeWidgetDataTypes->sortByColumn(0, Qt::AscendingOrder);
+		FileId fileId = f.key();
+		uint32_t fileNameId = StringPool::global().intern(f->fileName.toStdString());
+		symbols.push_back(SymbolIndex::Symbol(SourceFileData::SymbolData::SOURCE_FILE_NAME, fileNameId, fileNameId, fileId, 0));
+		for (const auto & s : f->subprograms)
+			symbols.push_back(SymbolIndex::Symbol(SourceFileData::SymbolData::SUBPROGRAM, s.nameId, fileNameId, fileId, s.line, s.descriptionId));
+		for (const auto & s : f->variables)
+			symbols.push_back(SymbolIndex::Symbol(SourceFileData::SymbolData::DATA_OBJECT, s.nameId, fileNameId, fileId, s.line, s.descriptionId));
+		for (const auto & s : f->dataTypes)
+			symbols.push_back(SymbolIndex::Symbol(SourceFileData::SymbolData::DATA_TYPE, s.nameId, fileNameId, fileId, s.line));
+	}
+	symbolIndex.setSymbols(std::move(symbols));
+	subprogramsModel.reset();
+	staticDataObjectsModel.reset();
+	dataTypesModel.reset();
+	sourceFilesModel.reset();
+	updateSourceListView();
+	on_lineEditObjectLocator_textChanged(ui->lineEditObjectLocator->text());
 }
 
 
@@ -2758,7 +3321,7 @@ void MainWindow::updateBreakpointsView()
 						<< (b.enabled ? "yes" : "no")
 						<< QString("0x%1").arg(b.address, 8, 16, QChar('0'))
 						<< b.locationSpecifierString,
-						b.sourceCodeLocation.fullFileName,
+						b.sourceCodeLocation.fullFileName(),
 						b.sourceCodeLocation.lineNumber
 						);
 		}
@@ -2783,7 +3346,7 @@ void MainWindow::updateBreakpointsView()
 						<< (b.enabled ? "yes" : "no")
 						<< QString("0x%1").arg(b.address, 8, 16, QChar('0'))
 						<< b.locationSpecifierString,
-						b.multipleLocationBreakpoints.at(0).sourceCodeLocation.fullFileName,
+						b.multipleLocationBreakpoints.at(0).sourceCodeLocation.fullFileName(),
 						b.multipleLocationBreakpoints.at(0).sourceCodeLocation.lineNumber,
 						SourceFileData::SymbolData::INVALID,
 						disableNavigation
@@ -2801,7 +3364,7 @@ void MainWindow::updateBreakpointsView()
 						<< (m.enabled ? "yes" : "no")
 						<< QString("0x%1").arg(m.address, 8, 16, QChar('0'))
 						<< m.locationSpecifierString,
-					m.sourceCodeLocation.fullFileName,
+					m.sourceCodeLocation.fullFileName(),
 					m.sourceCodeLocation.lineNumber
 					);
 			t->setCheckState(TREE_WIDGET_BREAKPOINT_ENABLE_STATUS_COLUMN_NUMBER, m.enabled ? Qt::Checked : Qt::Unchecked);
@@ -2817,8 +3380,8 @@ void MainWindow::updateBookmarksView()
 	ui->treeWidgetBookmarks->clear();
 	for (const auto & bookmark : bookmarks)
 		ui->treeWidgetBookmarks->addTopLevelItem(createNavigationWidgetItem(
-			 QStringList() << QFileInfo(bookmark.fullFileName).fileName() << QString("%1").arg(bookmark.lineNumber),
-			 bookmark.fullFileName,
+			 QStringList() << QFileInfo(bookmark.fullFileName()).fileName() << QString("%1").arg(bookmark.lineNumber),
+			 bookmark.fullFileName(),
 			 bookmark.lineNumber
 			 ));
 }
@@ -2852,8 +3415,8 @@ void MainWindow::highlightBreakpointedLines()
 	sourceCodeViewHighlights.disabledBreakpointedLines.clear();
 	sourceCodeViewHighlights.enabledBreakpointedLines.clear();
 
-	const QSet<int /* line number */> & enabledLines = breakpointCache.enabledBreakpointLinesForFile(displayedSourceCodeFile);
-	const QSet<int /* line number */> & disabledLines = breakpointCache.disabledBreakpointLinesForFile(displayedSourceCodeFile);
+	const QSet<int /* line number */> & enabledLines = breakpointCache.enabledBreakpointLinesForFile(displayedSourceCodeFileId);
+	const QSet<int /* line number */> & disabledLines = breakpointCache.disabledBreakpointLinesForFile(displayedSourceCodeFileId);
 
 	QTextEdit::ExtraSelection selection;
 
@@ -2886,7 +3449,7 @@ void MainWindow::highlightBookmarks()
 	selection.format = highlightFormats.bookmark;
 	for (const auto & bookmark : bookmarks)
 	{
-		if (bookmark.fullFileName != displayedSourceCodeFile)
+		if (bookmark.fileId() != displayedSourceCodeFileId)
 			continue;
 		c.movePosition(QTextCursor::Start);
 		c.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, bookmark.lineNumber - 1);
@@ -2919,100 +3482,116 @@ void MainWindow::navigateToSymbolAtCursor(void)
 	c.select(QTextCursor::WordUnderCursor);
 	QString symbolName = c.selectedText();
 
-	QList<QTreeWidgetItem*> symbols = ui->treeWidgetSubprograms->findItems(symbolName, Qt::MatchExactly);
-	symbols += ui->treeWidgetStaticDataObjects->findItems(symbolName, Qt::MatchExactly);
-	symbols += ui->treeWidgetDataTypes->findItems(symbolName, Qt::MatchExactly);
+	std::vector<const SymbolIndex::Symbol *> symbols;
+	for (const auto & i : symbolIndex.symbolsNamed(symbolName))
+		if (symbolIndex.symbol(i).kind != SourceFileData::SymbolData::SOURCE_FILE_NAME)
+			symbols.push_back(& symbolIndex.symbol(i));
+	/* Prefer subprograms, then data objects, then data types. */
+	std::stable_sort(symbols.begin(), symbols.end(), [] (const SymbolIndex::Symbol * a, const SymbolIndex::Symbol * b) -> bool
+		{
+			auto rank = [] (enum SourceFileData::SymbolData::SymbolKind kind) -> int
+				{ return kind == SourceFileData::SymbolData::SUBPROGRAM ? 0 : kind == SourceFileData::SymbolData::DATA_OBJECT ? 1 : 2; };
+			return rank(a->kind) < rank(b->kind);
+		});
 	if (symbols.empty())
+	{
+		/* No definition is known for the symbol, e.g. because it is a local variable, or a macro - list
+		 * its references instead. */
+		if (!symbolName.isEmpty())
+			findReferencesToIdentifier(symbolName);
 		return;
+	}
 	if (symbols.size() != 1)
 		QMessageBox::information(0, "Multiple symbols found", "Multiple symbols found for id: " + symbolName + "\nNavigating to the first item in the list");
-	QString sourceFileName = symbols.at(0)->data(0, SourceFileData::FILE_NAME).toString();
-	int lineNumber = symbols.at(0)->data(0, SourceFileData::LINE_NUMBER).toInt();
-	displaySourceCodeFile(SourceCodeLocation(sourceFileName, lineNumber), true, true);
+	displaySourceCodeFile(SourceCodeLocation(symbols.at(0)->fullFileName(), symbols.at(0)->line), true, true);
 }
 
 void MainWindow::searchCurrentSourceText(const QString & pattern)
 {
 	searchData.lastSearchedText = pattern;
-	searchData.matchPositions.clear();
-	sourceCodeViewHighlights.searchedTextMatches.clear();
-	if (pattern.length() != 0)
+	unsigned generation = ++ searchData.generation;
+	if (pattern.isEmpty())
+		ui->labelSearchMatchCount->clear();
+	else
 	{
-		QString document = ui->plainTextEditSourceView->toPlainText();
-		int index = 0, position;
-		while ((position = document.indexOf(pattern, index)) != -1)
-			searchData.matchPositions.push_back(position), index = position + 1;
-
-		QTextCursor c(ui->plainTextEditSourceView->textCursor());
-		int matchLength = pattern.length();
-		for (const auto & matchPosition : searchData.matchPositions)
-		{
-			c.setPosition(matchPosition);
-			c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, matchLength);
-			QTextEdit::ExtraSelection s;
-			s.cursor = c;
-			s.format = highlightFormats.searchedText;
-			sourceCodeViewHighlights.searchedTextMatches << s;
-		}
+		/* Count the matches in a background pass over the source code text lines. */
+		ui->labelSearchMatchCount->setText("counting matches...");
+		QStringList lines = searchData.sourceCodeTextlines;
+		searchData.matchCountWatcher.setFuture(QtConcurrent::run([=] () -> QPair<unsigned, int>
+			{
+				int matchCount = 0;
+				for (const auto & line : lines)
+					for (int index = 0; (index = line.indexOf(pattern, index)) != -1; index ++)
+						matchCount ++;
+				return qMakePair(generation, matchCount);
+			}));
 	}
-	refreshSourceCodeView();
+	highlightVisibleSearchMatches();
 }
 
-void MainWindow::moveCursorToNextMatch()
+void MainWindow::highlightVisibleSearchMatches(void)
 {
-	/* Navigate to next search match, if any. */
-	if (searchData.matchPositions.empty())
-		return;
-	int l = 0, h = searchData.matchPositions.size() - 1, m;
-	int cursorPosition = ui->plainTextEditSourceView->textCursor().position();
-
-	do
+	sourceCodeViewHighlights.searchedTextMatches.clear();
+	const QString & pattern = searchData.lastSearchedText;
+	if (!pattern.isEmpty())
 	{
-		m = (l + h) >> 1;
-		if (cursorPosition == searchData.matchPositions.at(m))
-			break;
-		if (cursorPosition < searchData.matchPositions.at(m))
-			h = m - 1;
-		else
-			l = m + 1;
+		/* Only create highlights for the matches in the source code lines that are currently visible. */
+		QPlainTextEdit * sourceView = ui->plainTextEditSourceView;
+		QTextBlock block = sourceView->cursorForPosition(QPoint(0, 0)).block();
+		int lastVisibleBlockNumber = sourceView->cursorForPosition(QPoint(0, sourceView->viewport()->height() - 1)).blockNumber();
+		QTextCursor c(sourceView->document());
+		for (; block.isValid() && block.blockNumber() <= lastVisibleBlockNumber; block = block.next())
+		{
+			QString text = block.text();
+			for (int index = searchData.lineNumberPrefixLength; (index = text.indexOf(pattern, index)) != -1; index ++)
+			{
+				c.setPosition(block.position() + index);
+				c.setPosition(block.position() + index + pattern.length(), QTextCursor::KeepAnchor);
+				QTextEdit::ExtraSelection s;
+				s.cursor = c;
+				s.format = highlightFormats.searchedText;
+				sourceCodeViewHighlights.searchedTextMatches << s;
+			}
+		}
 	}
-	while (l <= h);
-	if (cursorPosition >= searchData.matchPositions.at(m))
-		m ++;
-	if (m == searchData.matchPositions.size())
-		m = 0;
-	QTextCursor c(ui->plainTextEditSourceView->textCursor());
-	c.setPosition(searchData.matchPositions.at(m));
-
-	ui->plainTextEditSourceView->setTextCursor(c);
-	ui->plainTextEditSourceView->ensureCursorVisible();
+	refreshSourceCodeView();
 }
 
-void MainWindow::moveCursorToPreviousMatch()
+void MainWindow::moveCursorToMatch(bool searchBackward)
 {
-	/* Navigate to previous search match, if any. */
-	if (searchData.matchPositions.empty())
+	/* Navigate to the next, or previous, search match, if any, wrapping around the document ends.
+	 * The document is searched directly, so this does not depend on the highlighted matches. */
+	const QString & pattern = searchData.lastSearchedText;
+	if (pattern.isEmpty())
 		return;
-	int l = 0, h = searchData.matchPositions.size() - 1, m;
-	int cursorPosition = ui->plainTextEditSourceView->textCursor().position();
-
-	do
+	QTextDocument * document = ui->plainTextEditSourceView->document();
+	QTextDocument::FindFlags flags = QTextDocument::FindCaseSensitively;
+	if (searchBackward)
+		flags |= QTextDocument::FindBackward;
+	QTextCursor c(ui->plainTextEditSourceView->textCursor());
+	c.clearSelection();
+	/* When searching forward, skip a match at the cursor position. */
+	if (!searchBackward)
+		c.movePosition(QTextCursor::NextCharacter);
+	bool isWrappedAround = false;
+	while (true)
 	{
-		m = (l + h) >> 1;
-		if (cursorPosition == searchData.matchPositions.at(m))
+		QTextCursor match = document->find(pattern, c, flags);
+		if (match.isNull())
+		{
+			if (isWrappedAround)
+				return;
+			isWrappedAround = true;
+			c = QTextCursor(document);
+			c.movePosition(searchBackward ? QTextCursor::End : QTextCursor::Start);
+			continue;
+		}
+		c = match;
+		/* Skip matches in the line number prefixes. */
+		if (match.selectionStart() - match.block().position() >= searchData.lineNumberPrefixLength)
 			break;
-		if (cursorPosition < searchData.matchPositions.at(m))
-			h = m - 1;
-		else
-			l = m + 1;
 	}
-	while (l <= h);
-	if (cursorPosition <= searchData.matchPositions.at(m))
-		m --;
-	if (m == -1)
-		m = searchData.matchPositions.size() - 1;
-	QTextCursor c(ui->plainTextEditSourceView->textCursor());
-	c.setPosition(searchData.matchPositions.at(m));
+	c.setPosition(c.selectionStart());
 
 	ui->plainTextEditSourceView->setTextCursor(c);
 	ui->plainTextEditSourceView->ensureCursorVisible();
@@ -3097,8 +3676,8 @@ bool MainWindow::displaySourceCodeFile(const SourceCodeLocation &sourceCodeLocat
 QTime ttt;
 ttt.start();
 #if KEEP_THIS_FOR_BENCHMARKING_PURPOSES
-QFile f(sourceCodeLocation.fullFileName);
-QFileInfo fi(sourceCodeLocation.fullFileName);
+QFile f(sourceCodeLocation.fullFileName());
+QFileInfo fi(sourceCodeLocation.fullFileName());
 int currentBlockNumber = ui->plainTextEditSourceView->textCursor().blockNumber();
 bool result = false;
 
@@ -3116,14 +3695,14 @@ bool result = false;
 	if (!fi.exists())
 	{
 		/* Attempt to adjust the filename path on windows systems. */
-		fi.setFile(Utils::filenameToWindowsFilename(sourceCodeLocation.fullFileName));
+		fi.setFile(Utils::filenameToWindowsFilename(sourceCodeLocation.fullFileName()));
 		f.setFileName(fi.absoluteFilePath());
 	}
 	if (!fi.exists())
-		ui->plainTextEditSourceView->appendPlainText(QString("Cannot find file \"%1\"").arg(sourceCodeLocation.fullFileName));
+		ui->plainTextEditSourceView->appendPlainText(QString("Cannot find file \"%1\"").arg(sourceCodeLocation.fullFileName()));
 	else if (!f.open(QFile::ReadOnly))
-		ui->plainTextEditSourceView->appendPlainText(QString("Failed to open file \"%1\"").arg(sourceCodeLocation.fullFileName));
-	else if (sourceCodeLocation.fullFileName == internalHelpFileName)
+		ui->plainTextEditSourceView->appendPlainText(QString("Failed to open file \"%1\"").arg(sourceCodeLocation.fullFileName()));
+	else if (sourceCodeLocation.fullFileName() == internalHelpFileName)
 	{
 		/* Special case for the internal help file - do not attempt to apply syntax highlighting on it. */
 		sourceCodeViewHighlights.navigatedSourceCodeLine.clear();
@@ -3143,19 +3722,14 @@ bool result = false;
 			selection.format = sourceCodeViewHighlightFormats.navigatedLine;
 			sourceCodeViewHighlights.navigatedSourceCodeLine << selection;
 		}
-		displayedSourceCodeFile = sourceCodeLocation.fullFileName;
+		displayedSourceCodeFile = sourceCodeLocation.fullFileName();
 		refreshSourceCodeView();
 	}
 	else
 	{
 		/*! \todo Wrap this as a function (along with an example in the 'clex.y' scanner), and simply call that function. */
-		yyscan_t scanner;
-		std::string s;
-		yylex_init_extra(& s, &scanner);
-
-		yy_scan_string((f.readAll() + '\0').constData(), scanner);
-		yylex(scanner);
-		yylex_destroy(scanner);
+		QByteArray sourceCode = f.readAll();
+		std::string s = clex::format_html(sourceCode.constData(), clex::scan_tokens(sourceCode.constData()));
 
 		/* Prepend line numbers to the source code lines. */
 		QList<QString> lines = QString::fromStdString(s).split('\n');
@@ -3174,7 +3748,7 @@ bool result = false;
 				;
 		int i = 0;
 		std::unordered_set<int> empty, * machineCodeLineNumbers = & empty;
-		const auto & f = sourceFiles.find(sourceCodeLocation.fullFileName);
+		const auto & f = sourceFiles.find(sourceCodeLocation.fullFileName());
 		if (f != sourceFiles.cend())
 			machineCodeLineNumbers = & f->machineCodeLineNumbers;
 		for (const auto & l : lines)
@@ -3217,7 +3791,8 @@ bool result = false;
 			selection.format = sourceCodeViewHighlightFormats.navigatedLine;
 			sourceCodeViewHighlights.navigatedSourceCodeLine << selection;
 		}
-		displayedSourceCodeFile = sourceCodeLocation.fullFileName;
+		displayedSourceCodeFile = sourceCodeLocation.fullFileName();
+		displayedSourceCodeFileId = sourceCodeLocation.fileId();
 		searchCurrentSourceText(searchData.lastSearchedText);
 		if (saveNewLocationToNavigationStack)
 			navigationStack.push(sourceCodeLocation);
@@ -3250,16 +3825,20 @@ bool result = false;
 		navigationStack.push(SourceCodeLocation(displayedSourceCodeFile, currentBlockNumber + 1));
 
 	displayedSourceCodeFile.clear();
+	displayedSourceCodeFileId = 0;
+	searchData.sourceCodeTextlines.clear();
+	searchData.lineNumberPrefixLength = 0;
 
 	/* Special case for internal files (e.g., the internal help file) - do not attempt to apply syntax highlighting. */
-	if (sourceCodeLocation.fullFileName.startsWith(":/"))
+	if (sourceCodeLocation.fullFileName().startsWith(":/"))
 	{
 		ui->plainTextEditSourceView->setStyleSheet(HELPVIEW_PLAINTEXTEDIT_STYLESHEET);
-		QFile f(sourceCodeLocation.fullFileName);
+		QFile f(sourceCodeLocation.fullFileName());
 		//ui->plainTextEditSourceView->setStyleSheet("");
 		f.open(QFile::ReadOnly);
 		sourceCodeViewHighlights.navigatedSourceCodeLine.clear();
 		ui->plainTextEditSourceView->appendPlainText(f.readAll());
+		searchData.sourceCodeTextlines = ui->plainTextEditSourceView->toPlainText().split('\n');
 		QTextCursor c = ui->plainTextEditSourceView->textCursor();
 		c.movePosition(QTextCursor::Start);
 		if (sourceCodeLocation.lineNumber > 0)
@@ -3275,20 +3854,24 @@ bool result = false;
 			selection.format = highlightFormats.navigatedLine;
 			sourceCodeViewHighlights.navigatedSourceCodeLine << selection;
 		}
-		displayedSourceCodeFile = sourceCodeLocation.fullFileName;
-		refreshSourceCodeView();
+		displayedSourceCodeFile = sourceCodeLocation.fullFileName();
+		displayedSourceCodeFileId = sourceCodeLocation.fileId();
+		searchCurrentSourceText(searchData.lastSearchedText);
 	}
 	else
 	{
 		QString errorMessage;
 		ui->plainTextEditSourceView->setStyleSheet(DEFAULT_PLAINTEXTEDIT_STYLESHEET);
-		auto sourceData = sourceFilesCache.getSourceFileCacheData(sourceCodeLocation.fullFileName, errorMessage);
+		auto sourceData = sourceFilesCache.getSourceFileCacheData(sourceCodeLocation.fileId(), errorMessage);
 		if (!sourceData)
 		{
 			ui->plainTextEditSourceView->setPlainText(errorMessage);
 			goto out;
 		}
 
+		searchData.sourceCodeTextlines = sourceData->sourceCodeTextlines;
+		searchData.lineNumberPrefixLength = sourceData->lineNumberPrefixLength;
+
 		QTextDocument * d = (sourceData->textDocument.operator ->()->clone());
 		QString savedStyleSheet = ui->plainTextEditSourceView->styleSheet();
 		d->setDocumentLayout(new QPlainTextDocumentLayout(d));
@@ -3321,7 +3904,8 @@ bool result = false;
 			selection.format = highlightFormats.navigatedLine;
 			sourceCodeViewHighlights.navigatedSourceCodeLine << selection;
 		}
-		displayedSourceCodeFile = sourceCodeLocation.fullFileName;
+		displayedSourceCodeFile = sourceCodeLocation.fullFileName();
+		displayedSourceCodeFileId = sourceCodeLocation.fileId();
 		searchCurrentSourceText(searchData.lastSearchedText);
 		if (saveNewLocationToNavigationStack)
 			navigationStack.push(sourceCodeLocation);
@@ -3351,31 +3935,34 @@ public:
 	~xbtn(){qDebug() << "xbtn deleted";}
 };
 
-void MainWindow::createSvdRegisterView(QTreeWidgetItem *item, int column)
+void MainWindow::createSvdRegisterView(const QModelIndex & index)
 {
-	if (item->data(0, SVD_REGISTER_POINTER).isNull())
+	QModelIndex item = index.sibling(index.row(), 0);
+	if (item.data(SvdTreeModel::SVD_REGISTER_INDEX).isNull())
 		return;
-	SvdFileParser::SvdRegisterOrClusterNode * svdRegister = static_cast<SvdFileParser::SvdRegisterOrClusterNode *>(item->data(0, SVD_REGISTER_POINTER).value<void *>());
+	const SvdImage::Register & svdRegister = svdImage.svdRegister(item.data(SvdTreeModel::SVD_REGISTER_INDEX).toUInt());
 
 	QDialog * dialog = new QDialog(0, Qt::WindowTitleHint | Qt::WindowMinimizeButtonHint);
-	unsigned address = item->data(0, SVD_REGISTER_ADDRESS).toUInt();
-	dialog->setWindowTitle(QString("%1 @ 0x%2").arg(svdRegister->name).arg(address, 8, 16, QChar('0')));
+	unsigned address = item.data(SvdTreeModel::SVD_REGISTER_ADDRESS).toUInt();
+	dialog->setWindowTitle(QString("%1 @ 0x%2").arg(svdImage.string(svdRegister.name)).arg(address, 8, 16, QChar('0')));
 	QGroupBox * fieldsGroupBox = new QGroupBox();
-	SvdRegisterViewData view(dialog, address);
+	uint32_t registerIndex = item.data(SvdTreeModel::SVD_REGISTER_INDEX).toUInt();
+	SvdRegisterViewData view(dialog, address, registerIndex, svdImage.registerByteSize(registerIndex));
 	view.fieldsGroupBox = fieldsGroupBox;
 	dialog->setAttribute(Qt::WA_DeleteOnClose, true);
 	QVBoxLayout * fieldsLayout = new QVBoxLayout();
 	fieldsGroupBox->setLayout(fieldsLayout);
-	for (const auto & field : svdRegister->fields)
+	for (uint32_t i = svdRegister.firstField; i < svdRegister.firstField + svdRegister.fieldCount; i ++)
 	{
+		const SvdImage::Field & field = svdImage.field(i);
 		QHBoxLayout * h = new QHBoxLayout();
-		h->addWidget(new QLabel(QString("%1:@bitpos %2:%3 %4").arg(field.name)
+		h->addWidget(new QLabel(QString("%1:@bitpos %2:%3 %4").arg(svdImage.string(field.name))
 					.arg(field.bitOffset).arg(field.bitWidth)
 					.arg(field.bitWidth == 1 ? "bit" : "bits")));
 		QSpinBox * s = new QSpinBox();
 		s->setMinimum(0);
 		s->setMaximum((1 << field.bitWidth) - 1);
-		if (field.access == "read-only" || svdRegister->access == "read-only")
+		if (svdImage.string(field.access) == "read-only" || svdImage.string(svdRegister.access) == "read-only")
 			s->setEnabled(false);
 		h->addWidget(s);
 		view.fields << SvdRegisterViewData::RegField(field.bitOffset, field.bitWidth, s);
@@ -3390,17 +3977,10 @@ void MainWindow::createSvdRegisterView(QTreeWidgetItem *item, int column)
 	QPushButton * b;
 	hbox->addWidget(b = new QPushButton("Fetch"));
 	connect(b, &QPushButton::clicked, [=] {
-		for (const auto & view : svdViews)
-			if (view.dialog == dialog)
-			{
-				if (target_state == TARGET_STOPPED)
-				{
-					sendDataToGdbProcess(QString("-data-read-memory-bytes 0x%1 4\n").arg(view.address, 8, 16, QChar('0')));
-					view.fieldsGroupBox->setEnabled(true);
-				}
-				else
-					QMessageBox::information(0, "", QString("Cannot read register @$%1,\ntarget must be connected and halted.").arg(view.address, 8, 16, QChar('0')));
-			}
+		if (target_state == TARGET_STOPPED)
+			refreshSvdRegisterViews(dialog);
+		else
+			QMessageBox::information(0, "", QString("Cannot read register @$%1,\ntarget must be connected and halted.").arg(address, 8, 16, QChar('0')));
 	});
 	hbox->addWidget(b = new QPushButton("Close"));
 	connect(b, &QPushButton::clicked, [=] {
@@ -3420,73 +4000,176 @@ void MainWindow::createSvdRegisterView(QTreeWidgetItem *item, int column)
 	dialog->show();
 }
 
-void MainWindow::on_lineEditSearchFilesForText_returnPressed()
+void MainWindow::refreshSvdRegisterViews(QDialog * dialog)
 {
-	emit findString(ui->lineEditSearchFilesForText->text(),
-			ui->checkBoxSearchForWholeWordsOnly->isChecked() ? StringFinder::SEARCH_FOR_WHOLE_WORDS_ONLY : 0);
-	ui->lineEditSearchFilesForText->clear();
+	if (target_state != TARGET_STOPPED)
+		return;
+	std::map<uint32_t /* peripheral index */, QSet<uint32_t /* register index */>> peripheralRegisters;
+	for (const auto & view : svdViews)
+		if (!dialog || view.dialog == dialog)
+		{
+			view.fieldsGroupBox->setEnabled(true);
+			peripheralRegisters[svdImage.svdRegister(view.registerIndex).peripheral].insert(view.registerIndex);
+		}
+	for (const auto & p : peripheralRegisters)
+		for (const auto & range : svdImage.readRanges(p.first, [&] (uint32_t registerIndex) -> bool { return p.second.contains(registerIndex); }))
+			readTargetMemory(range.first, range.second - range.first, GdbTokenContext::GdbResponseContext(
+						 GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_REGISTER_READ, QString("%1 %2").arg(range.first).arg(range.second - range.first)));
 }
 
-void MainWindow::on_lineEditObjectLocator_textChanged(const QString &arg1)
+void MainWindow::updateSvdRegisterViews(uint32_t address, const QByteArray & data)
 {
-QString searchPattern = ui->lineEditObjectLocator->text();
+	for (const auto & view : svdViews)
+	{
+		if (view.address < address || view.address - address + view.size > (uint32_t) data.length())
+			continue;
+		uint32_t value = 0;
+		for (int i = view.size - 1; i >= 0; i --)
+			value = (value << 8) | (uint8_t) data.at(view.address - address + i);
+		for (auto & f : view.fields)
+			f.spinbox->setValue((value >> f.bitoffset) & (f.bitwidth < 32 ? (1u << f.bitwidth) - 1 : 0xffffffff));
+	}
+}
 
-	ui->treeWidgetObjectLocator->clear();
-	if (searchPattern.size() < MIN_STRING_LENGTH_FOR_OBJECT_LOCATOR)
+void MainWindow::takeSvdPeripheralSnapshot(uint32_t peripheralIndex)
+{
+	QString peripheralName = svdImage.string(svdImage.peripheral(peripheralIndex).name);
+	if (target_state != TARGET_STOPPED)
 	{
-		ui->treeWidgetObjectLocator->addTopLevelItem(new QTreeWidgetItem(QStringList() << "< enter more text to search for... >"));
+		QMessageBox::information(0, "", QString("Cannot take a snapshot of peripheral %1,\ntarget must be connected and halted.").arg(peripheralName));
 		return;
 	}
-	QList<QTreeWidgetItem *> sourceFileNames, subprograms, dataObjects, dataTypes;
-	sourceFileNames = ui->treeWidgetSourceFiles->findItems(searchPattern, Qt::MatchContains);
-	subprograms = ui->treeWidgetSubprograms->findItems(searchPattern, Qt::MatchContains);
-	dataObjects = ui->treeWidgetStaticDataObjects->findItems(searchPattern, Qt::MatchContains);
-	dataTypes = ui->treeWidgetDataTypes->findItems(searchPattern, Qt::MatchContains);
-	/* Make sure that the items are sorted alphabetically. */
-	static auto compare = [](const QTreeWidgetItem * a, const QTreeWidgetItem * b) -> bool { return a->text(0) < b->text(0); };
-	/* Make sure to *copy* the tree widget items, as the locator tree widget will take
-	 * ownership of the items added. */
-	QTreeWidgetItem * headerItem;
-
-	if (sourceFileNames.size() + subprograms.size() + dataObjects.size() + dataTypes.size() == 0)
-	{
-		ui->treeWidgetObjectLocator->addTopLevelItem(headerItem = new QTreeWidgetItem(QStringList() << "--- No items found ---"));
-		headerItem->setBackground(0, Qt::lightGray);
+	if (pendingSvdSnapshot)
+	{
+		QMessageBox::information(0, "", "A peripheral snapshot is already being taken, please retry when it completes.");
 		return;
 	}
+	QDateTime time = QDateTime::currentDateTime();
+	bool ok;
+	QString label = QInputDialog::getText(0, "Peripheral snapshot", "Snapshot label:", QLineEdit::Normal,
+					      QString("%1 %2").arg(peripheralName).arg(time.toString("yyyy-MM-dd hh:mm:ss")), & ok);
+	if (!ok)
+		return;
+	pendingSvdSnapshot = std::make_shared<SvdSnapshot>();
+	pendingSvdSnapshot->label = label;
+	pendingSvdSnapshot->time = time;
+	pendingSvdSnapshot->deviceName = svdImage.deviceName();
+	std::vector<std::pair<uint32_t, uint32_t>> ranges = pendingSvdSnapshot->addPeripheral(svdImage, peripheralIndex);
+	pendingSvdSnapshotReads = ranges.size();
+	if (ranges.empty())
+		/* Nothing to read, complete the snapshot right away. */
+		pendingSvdSnapshotReads = 1, completeSvdSnapshotRead(0, 0, QByteArray());
+	for (const auto & range : ranges)
+		readTargetMemory(range.first, range.second - range.first, GdbTokenContext::GdbResponseContext(
+					 GdbTokenContext::GdbResponseContext::GDB_RESPONSE_SVD_SNAPSHOT_READ, QString("%1 %2").arg(range.first).arg(range.second - range.first)));
+}
 
-	if (sourceFileNames.size())
+void MainWindow::completeSvdSnapshotRead(uint32_t address, uint32_t length, const QByteArray & data)
+{
+	if (!pendingSvdSnapshot)
+		return;
+	pendingSvdSnapshot->memoryRead(address, length, data);
+	if (-- pendingSvdSnapshotReads)
+		return;
+	std::shared_ptr<SvdSnapshot> snapshot = pendingSvdSnapshot;
+	pendingSvdSnapshot.reset();
+	QDir().mkpath(svdSnapshotsDirectory);
+	QString fileName = QDir(svdSnapshotsDirectory).filePath(snapshot->time.toString("yyyyMMdd-hhmmss-zzz") + ".json");
+	if (!snapshot->save(fileName))
 	{
-		std::sort(sourceFileNames.begin(), sourceFileNames.end(), compare);
-		ui->treeWidgetObjectLocator->addTopLevelItem(headerItem = new QTreeWidgetItem(QStringList() << "--- File Names ---"));
-		headerItem->setBackground(0, Qt::lightGray);
-		for (const auto & s : sourceFileNames)
-			ui->treeWidgetObjectLocator->addTopLevelItem(new QTreeWidgetItem(* s));
+		QMessageBox::critical(0, "Failed to save peripheral snapshot", QString("Failed to save peripheral snapshot to file:\n%1").arg(fileName));
+		return;
 	}
-	if (subprograms.size())
+	int skippedRegisters = 0, failedRegisters = 0;
+	for (const auto & p : snapshot->peripherals)
+		for (const auto & r : p.registers)
+			if (r.state == SvdSnapshot::SKIPPED)
+				skippedRegisters ++;
+			else if (r.state != SvdSnapshot::READ)
+				failedRegisters ++;
+	appendLineToGdbLog(QString("Peripheral snapshot '%1' saved to file %2").arg(snapshot->label).arg(fileName));
+	if (skippedRegisters || failedRegisters)
+		appendLineToGdbLog(QString("%1 registers with read side effects skipped, %2 registers could not be read").arg(skippedRegisters).arg(failedRegisters));
+}
+
+void MainWindow::compareSvdSnapshots(void)
+{
+	/* Newest snapshots first. */
+	QFileInfoList files = QDir(svdSnapshotsDirectory).entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Name | QDir::Reversed);
+	auto snapshots = std::make_shared<std::vector<SvdSnapshot>>();
+	for (const auto & f : files)
+	{
+		SvdSnapshot s;
+		if (s.load(f.filePath()))
+			snapshots->push_back(s);
+	}
+	if (snapshots->size() < 2)
 	{
-		std::sort(subprograms.begin(), subprograms.end(), compare);
-		ui->treeWidgetObjectLocator->addTopLevelItem(headerItem = new QTreeWidgetItem(QStringList() << "--- Subprograms ---"));
-		headerItem->setBackground(0, Qt::lightGray);
-		for (const auto & s : subprograms)
-			ui->treeWidgetObjectLocator->addTopLevelItem(new QTreeWidgetItem(* s));
+		QMessageBox::information(0, "", "At least two peripheral snapshots are needed for a comparison.\n"
+					 "You can take peripheral snapshots from the context menu of peripherals in the SVD view.");
+		return;
 	}
-	if (dataObjects.size())
+
+	QDialog * dialog = new QDialog(this);
+	dialog->setWindowTitle("Compare peripheral snapshots");
+	dialog->setAttribute(Qt::WA_DeleteOnClose, true);
+	QVBoxLayout * l = new QVBoxLayout(dialog);
+	QHBoxLayout * hbox = new QHBoxLayout;
+	QComboBox * fromComboBox = new QComboBox, * toComboBox = new QComboBox;
+	for (const auto & s : * snapshots)
 	{
-		std::sort(dataObjects.begin(), dataObjects.end());
-		ui->treeWidgetObjectLocator->addTopLevelItem(headerItem = new QTreeWidgetItem(QStringList() << "--- Data Objects ---"));
-		headerItem->setBackground(0, Qt::lightGray);
-		for (const auto & s : dataObjects)
-			ui->treeWidgetObjectLocator->addTopLevelItem(new QTreeWidgetItem(* s));
+		QString text = QString("%1 (%2)").arg(s.label).arg(s.time.toString("yyyy-MM-dd hh:mm:ss"));
+		fromComboBox->addItem(text);
+		toComboBox->addItem(text);
 	}
-	if (dataTypes.size())
+	/* By default, compare the two most recent snapshots. */
+	fromComboBox->setCurrentIndex(1);
+	toComboBox->setCurrentIndex(0);
+	hbox->addWidget(new QLabel("Compare"));
+	hbox->addWidget(fromComboBox, 1);
+	hbox->addWidget(new QLabel("to"));
+	hbox->addWidget(toComboBox, 1);
+	l->addLayout(hbox);
+	QTreeWidget * differences = new QTreeWidget;
+	differences->setHeaderLabels(QStringList() << "Register/Field" << "Address" << "Old value" << "New value");
+	differences->setRootIsDecorated(false);
+	l->addWidget(differences);
+
+	auto compare = [=] (void) -> void
+	{
+		differences->clear();
+		const SvdSnapshot & from = snapshots->at(fromComboBox->currentIndex()), & to = snapshots->at(toComboBox->currentIndex());
+		for (const auto & d : SvdSnapshot::compare(from, to))
+			new QTreeWidgetItem(differences, QStringList() << d.name << QString("0x%1").arg(d.address, 8, 16, QChar('0')) << d.oldValue << d.newValue);
+		if (!differences->topLevelItemCount())
+			new QTreeWidgetItem(differences, QStringList() << "--- No differences ---");
+		for (int i = 0; i < differences->columnCount(); i ++)
+			differences->resizeColumnToContents(i);
+	};
+	connect(fromComboBox, static_cast<void (QComboBox::*)(int)>(& QComboBox::currentIndexChanged), compare);
+	connect(toComboBox, static_cast<void (QComboBox::*)(int)>(& QComboBox::currentIndexChanged), compare);
+	compare();
+	dialog->resize(800, 500);
+	dialog->show();
+}
+
+void MainWindow::on_lineEditSearchFilesForText_returnPressed()
+{
+	searchSourceFilesForText(ui->lineEditSearchFilesForText->text());
+	ui->lineEditSearchFilesForText->clear();
+}
+
+void MainWindow::on_lineEditObjectLocator_textChanged(const QString &arg1)
+{
+QString searchPattern = ui->lineEditObjectLocator->text();
+
+	if (searchPattern.size() < MIN_STRING_LENGTH_FOR_OBJECT_LOCATOR)
 	{
-		std::sort(dataTypes.begin(), dataTypes.end());
-		ui->treeWidgetObjectLocator->addTopLevelItem(headerItem = new QTreeWidgetItem(QStringList() << "--- Data Types ---"));
-		headerItem->setBackground(0, Qt::lightGray);
-		for (const auto & s : dataTypes)
-			ui->treeWidgetObjectLocator->addTopLevelItem(new QTreeWidgetItem(* s));
+		objectLocatorModel.setMessage("< enter more text to search for... >");
+		return;
 	}
+	objectLocatorModel.setMatches(symbolIndex.search(searchPattern, MAX_OBJECT_LOCATOR_RESULTS), "--- No items found ---");
+	ui->treeViewObjectLocator->scrollToTop();
 }
 
 void MainWindow::on_pushButtonDeleteAllBookmarks_clicked()
@@ -3532,9 +4215,79 @@ void MainWindow::requestTargetHalt(void)
 
 void MainWindow::on_pushButtonLoadProgramToTarget_clicked()
 {
+	loadProgramIntoTarget();
+}
+
+void MainWindow::loadProgramIntoTarget()
+{
+	targetMemoryCache.invalidate();
+	if (incrementalFlasher.isActive())
+		return;
+	/* If the executable has been rebuilt since it was loaded in gdb, first load it again in gdb. Otherwise, the
+	 * gdb symbols would not match the programmed image, and the incremental flasher, which works on the
+	 * executable loaded in the frontend, could program a different image than gdb. */
+	QString executableFileName = settings->value(SETTINGS_LAST_LOADED_EXECUTABLE_FILE, QString()).toString();
+	QFileInfo fi(executableFileName);
+	if (fi.exists() && fi.lastModified() != executableFileLastModified)
+	{
+		appendLineToGdbLog("The executable file has changed, reloading it in gdb");
+		unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
+								   GdbTokenContext::GdbResponseContext::GDB_RESPONSE_EXECUTABLE_RELOADED_FOR_PROGRAMMING,
+								   executableFileName));
+		sendDataToGdbProcess(QString("%1-file-exec-and-symbols \"%2\"\n").arg(t).arg(Utils::escapeString(executableFileName)));
+		return;
+	}
+	programTarget();
+}
+
+void MainWindow::programTarget()
+{
+	if (elfReader && isBlackmagicProbeConnected && target_state == TARGET_STOPPED
+			&& settings->value(SETTINGS_CHECKBOX_ENABLE_INCREMENTAL_FLASHING_STATE, true).toBool())
+	{
+		QVector<QByteArray> packets = incrementalFlasher.start(* elfReader);
+		if (!packets.isEmpty() && blackMagicProbeServer.injectPackets(0, packets, INCREMENTAL_FLASHING_PACKET_TIMEOUT_MS))
+		{
+			appendLineToGdbLog("Comparing target flash sectors...");
+			return;
+		}
+		incrementalFlasher.cancel();
+	}
 	sendDataToGdbProcess("-target-download\n");
 }
 
+void MainWindow::continueIncrementalFlashing(const QVector<QByteArray> & replies)
+{
+	if (!incrementalFlasher.isActive())
+		return;
+	QVector<QByteArray> packets = incrementalFlasher.repliesReceived(replies);
+	if (!packets.isEmpty())
+	{
+		if (incrementalFlasher.state() == IncrementalFlasher::PROGRAMMING_SECTORS)
+			appendLineToGdbLog(QString("Programming %1 of %2 target flash sectors (%3 bytes)...")
+					   .arg(incrementalFlasher.changedSectorCount()).arg(incrementalFlasher.sectorCount()).arg(incrementalFlasher.changedByteCount()));
+		if (blackMagicProbeServer.injectPackets(0, packets, INCREMENTAL_FLASHING_PACKET_TIMEOUT_MS))
+			return;
+		incrementalFlasher.cancel();
+		appendLineToGdbLog("Incremental flashing failed, loading the whole program");
+		sendDataToGdbProcess("-target-download\n");
+		return;
+	}
+	if (incrementalFlasher.state() == IncrementalFlasher::FAILED)
+	{
+		appendLineToGdbLog(incrementalFlasher.errorString() + ", loading the whole program");
+		sendDataToGdbProcess("-target-download\n");
+		return;
+	}
+	if (incrementalFlasher.changedSectorCount())
+		appendLineToGdbLog("Target flash programming complete");
+	else
+		appendLineToGdbLog("Target flash contents are up to date, nothing to program");
+	/* The target memory has been changed behind the back of gdb, drop any target memory contents cached in the frontend. */
+	targetMemoryCache.invalidate();
+	memoryDumpModel.invalidate();
+}
+
 void MainWindow::on_comboBoxSelectLayout_activated(int index)
 {
 	if (!index)
@@ -3611,86 +4364,30 @@ void MainWindow::loadSVDFile(void)
 		ui->pushButtonSettings->click();
 		return;
 	}
-	svdParser.parse(targetSVDFileName);
-	ui->treeWidgetSvd->clear();
-
-	/* Note: if the device tree node is not added to the tree widget here, but at a later time instead, the
-	 * tree node sorting routines below may not work. */
-	QTreeWidgetItem * device = new QTreeWidgetItem(ui->treeWidgetSvd, QStringList() << svdParser.device.name << svdParser.device.cpu.name << svdParser.device.description);
-	if (!svdParser.device.peripherals.size())
+	/* Register views refer to registers of the previously loaded SVD file, close them. */
+	for (const auto & v : svdViews)
+		v.dialog->done(QDialog::Accepted);
+	svdViews.clear();
+	QElapsedTimer t;
+	t.start();
+	if (!svdImage.load(targetSVDFileName))
 	{
-		ui->treeWidgetSvd->addTopLevelItem(device);
+		svdTreeModel.reset();
+		QMessageBox::critical(0, "Failed to load target SVD file", QString("Failed to read target SVD file:\n%1").arg(targetSVDFileName));
 		return;
 	}
-	QTreeWidgetItem * peripherals = new QTreeWidgetItem(device, QStringList() << "Peripherals");
-
-	std::unordered_map<QString, const SvdFileParser::SvdPeripheralNode *> peripheralNodes;
-	std::map<QString, std::vector<const SvdFileParser::SvdPeripheralNode *>> peripheralGroups;
-	for (const auto & p : svdParser.device.peripherals)
+	appendLineToGdbLog(QString("SVD file loaded%1 in %2 milliseconds").arg(svdImage.isLoadedFromCache() ? " from its cache file" : "").arg(t.elapsed()));
+	/* Never cache the contents of peripheral registers. */
+	targetMemoryCache.resetVolatileRanges();
+	for (uint32_t i = 0; i < svdImage.peripheralCount(); i ++)
 	{
-		peripheralNodes.operator [](p.name) = & p;
-		if (p.groupName.length())
-			peripheralGroups.operator [](p.groupName).push_back(& p);
+		const SvdImage::Peripheral & p = svdImage.peripheral(i);
+		for (uint32_t b = p.firstAddressBlock; b < p.firstAddressBlock + p.addressBlockCount; b ++)
+			targetMemoryCache.addVolatileRange(p.baseAddress + svdImage.addressBlock(b).offset, svdImage.addressBlock(b).size);
 	}
-	/* This is used to remove any excessive whitespace in description strings. */
-	QRegularExpression rx("\\s\\s+");
-	std::function<void(QTreeWidgetItem * parent, const SvdFileParser::SvdRegisterOrClusterNode & rc, uint32_t baseAddress)> populateRegisterOrCluster =
-		[&] (QTreeWidgetItem * parent, const SvdFileParser::SvdRegisterOrClusterNode & rc, uint32_t baseAddress) -> void
-	{
-		if (rc.isRegisterNode)
-		{
-			/* Create a register node. */
-			uint32_t address = rc.addressOffset + baseAddress;
-			QTreeWidgetItem * r = new QTreeWidgetItem(parent, QStringList() << rc.name << QString("0x%1").arg(address, 8, 16, QChar('0'))
-								  << QString(rc.description).replace(rx, " "));
-			r->setData(0, SVD_REGISTER_POINTER, QVariant::fromValue((void *) & rc));
-			r->setData(0, SVD_REGISTER_ADDRESS, address);
-			for (const auto & f : rc.fields)
-			{
-				QStringList fieldHeaders;
-				fieldHeaders << f.name;
-				fieldHeaders << QString("%1").arg(f.bitOffset);
-				if (f.bitWidth > 1)
-					fieldHeaders.last().append(QString(":%1").arg(f.bitOffset + f.bitWidth - 1));
-				fieldHeaders << QString(f.description).replace(rx, " ");
-				new QTreeWidgetItem(r, fieldHeaders);
-			}
-		}
-		else
-		{
-			/* Create a cluster node. */
-			QTreeWidgetItem * cluster = new QTreeWidgetItem(parent, QStringList() << rc.name << "<cluster lorem ipsum>" << rc.description);
-			for (const auto & r : rc.children)
-				populateRegisterOrCluster(cluster, r, baseAddress + rc.addressOffset);
-		}
-
-	};
-	auto populatePeripheral = [&] (QTreeWidgetItem * parent, const SvdFileParser::SvdPeripheralNode * peripheral) -> void
-	{
-		QTreeWidgetItem * p = new QTreeWidgetItem(parent, QStringList() << peripheral->name << QString("0x%1").arg(peripheral->baseAddress, 8, 16, QChar('0')) << peripheral->description);
-		const std::list<SvdFileParser::SvdRegisterOrClusterNode> & registers = peripheral->registersAndClusters;
 
-		for (const auto & r : registers)
-			populateRegisterOrCluster(p, r, peripheral->baseAddress);
-	};
-	/* First, populate peripheral groups. */
-	for (const auto & p : peripheralGroups)
-	{
-		QTreeWidgetItem * group = new QTreeWidgetItem(peripherals, QStringList() << p.first);
-		for (const auto & peripheral : p.second)
-			populatePeripheral(group, peripheral);
-		group->sortChildren(0, Qt::AscendingOrder);
-	}
-	peripherals->sortChildren(0, Qt::AscendingOrder);
-	/* Also, add any peripherals that are not part of a peripheral group. */
-	for (const auto & p : svdParser.device.peripherals)
-	{
-		if (p.groupName.length())
-			continue;
-		QTreeWidgetItem * peripheral = new QTreeWidgetItem(peripherals, QStringList() << p.name << QString("0x%1").arg(p.baseAddress, 8, 16, QChar('0')) << p.description);
-		for (const auto & r : p.registersAndClusters)
-			populateRegisterOrCluster(peripheral, r, p.baseAddress);
-	}
+	svdTreeModel.reset();
+	ui->treeViewSvd->expand(svdTreeModel.deviceIndex());
 }
 
 void MainWindow::displayHelp()
@@ -3715,31 +4412,30 @@ void MainWindow::scanForTargets(void)
 
 void MainWindow::compareTargetMemory()
 {
-	targetMemorySectionsTempFileNames.clear();
 	if (!elfReader)
 	{
 		QMessageBox::critical(0, "ELF file unavailable", "ELF file unavailable, cannot perform target memory verification");
 		return;
 	}
-	/*! \todo	Create proper temporary files, this is just a quick hack. */
-	auto x = QDateTime::currentMSecsSinceEpoch();
+	if (targetMemoryVerifier.isActive())
+		return;
+	if (!targetMemoryVerifier.start(* elfReader))
+	{
+		QMessageBox::information(0, "Nothing to verify", "The ELF file contains no loadable segments, there is nothing to verify");
+		return;
+	}
+	/* There is no machine interface command for computing target memory checksums, so use the 'maint packet'
+	 * command to send 'qCRC' remote protocol packets to the gdb server directly. The gdb server replies
+	 * are printed on the console. */
+	consoleDataCapture.startCapture();
 	QString gdbRequest;
-	int i = 0;
-	for (const auto & segment : elfReader->segments)
+	for (int i = 0; i < (int) targetMemoryVerifier.blocks().size(); i ++)
 	{
-		if (!segment->get_file_size())
-			continue;
-		targetMemorySectionsTempFileNames << QString("section-%1-%2.bin").arg(i).arg(x);
-		/* There is no machine interface command for dumping target memory to files, so use the regular gdb commands. */
-		gdbRequest += QString("dump binary memory %1 0x%2 0x%3\n")
-				.arg(targetMemorySectionsTempFileNames.back())
-				.arg(segment->get_physical_address(), 8, 16, QChar('0'))
-				.arg(segment->get_physical_address() + segment->get_file_size(), 8, 16, QChar('0'));
-		i ++;
-	}
-	/* As regular gdb commands are being used, insert a sequence point to know when to check the retrieved target memory areas. */
-	unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
-			   GdbTokenContext::GdbResponseContext::GDB_SEQUENCE_POINT_CHECK_MEMORY_CONTENTS));
-	gdbRequest += QString("%1\n").arg(t);
+		const TargetMemoryVerifier::Block & b = targetMemoryVerifier.blocks().at(i);
+		unsigned t = gdbTokenContext.insertContext(GdbTokenContext::GdbResponseContext(
+				GdbTokenContext::GdbResponseContext::GDB_RESPONSE_VERIFY_BLOCK_CRC, QString::number(i)));
+		gdbRequest += QString("%1-interpreter-exec console \"maint packet qCRC:%2,%3\"\n")
+				.arg(t).arg(b.address, 0, 16).arg(b.expectedData.length(), 0, 16);
+	}
 	sendDataToGdbProcess(gdbRequest);
 }
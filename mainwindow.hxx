@@ -44,14 +44,25 @@
 
 #include <QDebug>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QTime>
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 #include <QSpinBox>
 #include <QGroupBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QToolButton>
 
 #include <memory>
 #include <unordered_set>
 #include <set>
+#include <atomic>
+#include <string.h>
+#include <ctype.h>
 
 #include <elfio/elfio.hpp>
 
@@ -61,7 +72,9 @@
 #include "gdbserver.hxx"
 #include "gdb-remote.hxx"
 
-#include "svdfileparser.hxx"
+#include "svd-image.hxx"
+#include "svd-tree-model.hxx"
+#include "svd-snapshot.hxx"
 
 #include <functional>
 
@@ -69,11 +82,23 @@
 
 #include "bmpdetect.hxx"
 #include "source-files-cache.hxx"
+#include "path-resolver.hxx"
+#include "incremental-job.hxx"
+#include "live-watch.hxx"
+#include "memory-dump-model.hxx"
+#include "target-memory-cache.hxx"
+#include "target-memory-verifier.hxx"
+#include "incremental-flasher.hxx"
+#include "trigram-index.hxx"
+#include "literal-search.hxx"
+#include "gdb-value.hxx"
+#include "identifier-index.hxx"
 #include "utils.hxx"
 #include "ui_settings-dialog.h"
 
 #include "breakpoint-cache.hxx"
 #include "source-file-data.hxx"
+#include "symbol-item-models.hxx"
 #include "ui_select-debug-executable-file-dialog.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
@@ -108,6 +133,282 @@ private:
 	QTcpSocket	* gdb_client_socket = 0;
 
 	static const int DEFAULT_GDB_SERVER_PORT	= 1122;
+	/* If the target cannot be halted, or the probe does not reply to an injected memory read in this time,
+	 * it is assumed that target memory cannot be read while the target is running. */
+	static const int INJECTED_READ_TIMEOUT_MS	= 500;
+	/* If the probe does not reply to an injected request packet in time, the request fails, but the probe
+	 * may still send the reply later. The late reply is waited for this long, so that it is not passed to
+	 * gdb. If it does not arrive, the replies from the probe can no longer be reliably matched to the
+	 * requests from gdb, and the connection is dropped. */
+	static const int INJECTED_REPLY_DRAIN_TIMEOUT_MS	= 5000;
+
+	/* Remote protocol requests can be injected in the data stream between gdb and the probe. This is used
+	 * for sampling target memory while the target is running, which is not possible through gdb when it is
+	 * in all-stop mode, and for programming only parts of the target flash, which gdb cannot do.
+	 *
+	 * In all-stop mode, the probe ignores everything but interrupt requests while the target is running.
+	 * So, if the target is running when a request is started, the target is first halted, by sending an
+	 * interrupt request to the probe, the request packets are sent after the stop reply is received,
+	 * and the target is then resumed. The stop reply is not passed to gdb, unless gdb itself requests
+	 * an interrupt in the meantime, in which case the target is not resumed. If the target stops by
+	 * itself before the interrupt request takes effect, the stop reply is passed to gdb, and the request fails.
+	 *
+	 * While an injected request is pending, packets sent by gdb are held back, so that the first replies
+	 * from the probe, that are not stop reply or console output packets, are the replies to the injected
+	 * request packets. Acknowledgements and interrupt requests from gdb are passed through immediately.
+	 * The packets of a request are sent one after another, each packet is sent after the reply to the
+	 * previous packet has been received. Only one injected request can be pending at any time.
+	 *
+	 * If the probe does not reply to a packet in time, the request fails, but packets from gdb are held back
+	 * until the late reply is received and discarded, so that the data stream stays synchronized. */
+	struct
+	{
+		bool		isPending = false;
+		bool		isMemoryRead = false;
+		unsigned	requestNumber = 0;
+		QVector<QByteArray>	packets;
+		QVector<QByteArray>	replies;
+		bool		isAcknowledged = false;
+		/* Data received from the probe, that has not yet been processed. */
+		QByteArray	probeData;
+		QByteArray	heldGdbData;
+		/* Set when a request packet has timed out. The failure of the request has already been reported,
+		 * and the late reply to the packet is awaited, in order to discard it. */
+		bool		isDraining = false;
+		enum
+		{
+			TARGET_NOT_HALTED,
+			HALT_REQUESTED,
+			TARGET_HALTED,
+		}
+		haltState = TARGET_NOT_HALTED;
+		/* The stop reply received after halting the target for the request. */
+		QByteArray	stopReply;
+		/* Set if gdb requests an interrupt, while the target is halted for the request. */
+		bool		isInterruptRequested = false;
+	}
+	injectedRequest;
+	QTimer		injectedRequestTimer;
+	bool		isInjectedReadSupported = true;
+	/* The target run state and the acknowledgement mode, as seen in the remote protocol data stream. */
+	bool		isTargetRunning = false;
+	bool		isTargetStepping = false;
+	bool		isNoAckModeRequested = false;
+	bool		isNoAckMode = false;
+	/* True if gdb has sent a packet, and the reply to it has not yet been received. */
+	bool		isGdbReplyPending = false;
+	/* True if the target has been resumed after an injected request, and the acknowledgement of the
+	 * resumption request is yet to be received from the probe. It must not be passed to gdb. */
+	bool		isResumptionAcknowledgementPending = false;
+	/* Data from the probe, that is to be passed to gdb. */
+	QByteArray	probeDataForGdb;
+	/* Used for tracking the remote protocol state, by scanning the packets passed between gdb and the probe. */
+	GdbRemotePacketFramer	gdbPacketFramer;
+	GdbRemotePacketFramer	probePacketFramer;
+
+	/* Returns true for packets sent by the probe, that are not replies to requests, i.e. stop replies and
+	 * console output packets. Stop replies are replies to resumption requests, and they are only sent
+	 * to gdb, because injected requests are never resumption requests. */
+	static bool isAsynchronousProbePacket(const QByteArray & payload)
+	{
+		return payload.size() && (strchr("TSWX", payload.at(0)) || (payload.at(0) == 'O' && payload != "OK"));
+	}
+	static bool isStopReply(const QByteArray & payload) { return payload.size() && strchr("TSWX", payload.at(0)); }
+	/* Returns true for the stop reply sent by the probe, when the target has been halted by an interrupt request. */
+	static bool isInterruptStopReply(const QByteArray & payload) { return payload.startsWith("T02") || payload.startsWith("S02"); }
+	void scanGdbPacket(const QByteArray & payload)
+	{
+		if (payload.startsWith("vCont;c") || payload.startsWith("vCont;C") || (payload.size() && strchr("cC", payload.at(0))))
+			isTargetRunning = true, isTargetStepping = false;
+		else if (payload.startsWith("vCont;s") || payload.startsWith("vCont;S") || payload.startsWith("vCont;r")
+				|| (payload.size() && strchr("sS", payload.at(0))))
+			isTargetRunning = isTargetStepping = true;
+		else if (payload == "QStartNoAckMode")
+			isNoAckModeRequested = true;
+		isGdbReplyPending = true;
+	}
+	void scanProbePacket(const QByteArray & payload)
+	{
+		if (payload.size() && strchr("TSWX", payload.at(0)))
+			isTargetRunning = false;
+		if (isNoAckModeRequested)
+			isNoAckMode = (payload == "OK"), isNoAckModeRequested = false;
+		if (!isAsynchronousProbePacket(payload) || strchr("TSWX", payload.at(0)))
+			isGdbReplyPending = false;
+	}
+	/* Passes the data from the probe, that has been queued for gdb, to gdb. */
+	void flushProbeDataForGdb(void)
+	{
+		QByteArray data = probeDataForGdb;
+		probeDataForGdb.clear();
+		probePacketFramer.append(data);
+		while (probePacketFramer.nextPacket())
+			scanProbePacket(probePacketFramer.payload());
+		if (!gdb_client_socket || !gdb_client_socket->isValid() || !gdb_client_socket->isOpen())
+			qDebug() << "WARNING: blackmagic probe data received, but no gdb client connected; discarding blackmagic data:" << data;
+		else if (data.size())
+			gdb_client_socket->write(data);
+	}
+	void sendInjectedPacket(void)
+	{
+		injectedRequest.isAcknowledged = isNoAckMode;
+		bmport.write(injectedRequest.packets.at(injectedRequest.replies.size()));
+		injectedRequestTimer.start();
+	}
+	/* Removes the replies to the pending injected request from the data received from the probe.
+	 * The data that should be passed to gdb is queued for gdb. */
+	void extractInjectedRequestReplies(void)
+	{
+		QByteArray & gdbData = probeDataForGdb;
+		QByteArray & d = injectedRequest.probeData;
+		while (injectedRequest.isPending && d.size())
+		{
+			char c = d.at(0);
+			if (!injectedRequest.isAcknowledged && (c == '+' || c == '-'))
+			{
+				d.remove(0, 1);
+				if (c == '+')
+					injectedRequest.isAcknowledged = true;
+				else
+					bmport.write(injectedRequest.packets.at(injectedRequest.replies.size()));
+				continue;
+			}
+			if (c != '$')
+			{
+				gdbData += c;
+				d.remove(0, 1);
+				continue;
+			}
+			int end = d.indexOf('#');
+			if (end == -1 || d.size() < end + 3)
+				break;
+			QByteArray packet = d.left(end + 3), payload;
+			d.remove(0, end + 3);
+			if (!GdbRemote::decodePacket(packet, payload) && !isNoAckMode)
+			{
+				/* Request retransmission of the corrupted packet. */
+				bmport.write("-");
+				continue;
+			}
+			if (injectedRequest.haltState == injectedRequest.HALT_REQUESTED && isStopReply(payload))
+			{
+				if (!isNoAckMode)
+					bmport.write("+");
+				if (isInterruptStopReply(payload))
+				{
+					injectedRequest.haltState = injectedRequest.TARGET_HALTED;
+					injectedRequest.stopReply = packet;
+					if (injectedRequest.isDraining)
+						/* The target has been halted after the request has timed out, resume it. */
+						completeInjectedRequest();
+					else
+						sendInjectedPacket();
+				}
+				else
+				{
+					/* The target has stopped by itself, pass the stop reply to gdb, and fail the request. */
+					injectedRequest.haltState = injectedRequest.TARGET_NOT_HALTED;
+					gdbData += packet;
+					completeInjectedRequest();
+				}
+				continue;
+			}
+			if (!injectedRequest.isAcknowledged || isAsynchronousProbePacket(payload))
+			{
+				gdbData += packet;
+				continue;
+			}
+			if (!isNoAckMode)
+				bmport.write("+");
+			if (injectedRequest.isDraining)
+			{
+				/* This is the late reply to the packet that has timed out, the data stream is now synchronized. */
+				completeInjectedRequest();
+				continue;
+			}
+			injectedRequest.replies << packet;
+			if (injectedRequest.replies.size() < injectedRequest.packets.size())
+				sendInjectedPacket();
+			else
+				completeInjectedRequest();
+		}
+		if (!injectedRequest.isPending)
+			gdbData += d, d.clear();
+	}
+	void completeInjectedRequest(void)
+	{
+		bool isResultReported = injectedRequest.isDraining;
+		injectedRequest.isPending = injectedRequest.isDraining = false;
+		injectedRequestTimer.stop();
+		if (injectedRequest.haltState == injectedRequest.TARGET_HALTED)
+		{
+			if (injectedRequest.isInterruptRequested)
+				/* Gdb has requested an interrupt in the meantime, report the target halt to it. */
+				probeDataForGdb += injectedRequest.stopReply;
+			else if (bmport.isOpen())
+			{
+				bmport.write(GdbRemote::continueRequest());
+				isResumptionAcknowledgementPending = !isNoAckMode;
+			}
+		}
+		injectedRequest.haltState = injectedRequest.TARGET_NOT_HALTED;
+		if (bmport.isOpen() && injectedRequest.heldGdbData.size())
+			bmport.write(injectedRequest.heldGdbData);
+		injectedRequest.heldGdbData.clear();
+		if (!isResultReported)
+			reportInjectedRequestResult();
+	}
+	void reportInjectedRequestResult(void)
+	{
+		if (!injectedRequest.isMemoryRead)
+			emit injectedPacketsCompleted(injectedRequest.requestNumber, injectedRequest.replies);
+		else
+		{
+			QByteArray reply = injectedRequest.replies.isEmpty() ? QByteArray() : injectedRequest.replies.at(0), payload;
+			emit injectedMemoryReadCompleted(injectedRequest.requestNumber, (GdbRemote::decodePacket(reply, payload) && !GdbRemote::isErrorResponse(reply))
+							 ? QByteArray::fromHex(payload) : QByteArray());
+		}
+	}
+	bool startInjectedRequest(unsigned requestNumber, const QVector<QByteArray> & packets, bool isMemoryRead, int timeoutMs)
+	{
+		if (!bmport.isOpen() || !gdb_client_socket || injectedRequest.isPending || packets.isEmpty())
+			return false;
+		injectedRequest.isPending = true;
+		injectedRequest.isMemoryRead = isMemoryRead;
+		injectedRequest.requestNumber = requestNumber;
+		injectedRequest.packets = packets;
+		injectedRequest.replies.clear();
+		injectedRequest.isInterruptRequested = false;
+		injectedRequestTimer.setInterval(timeoutMs);
+		if (!isTargetRunning)
+		{
+			injectedRequest.haltState = injectedRequest.TARGET_NOT_HALTED;
+			sendInjectedPacket();
+		}
+		else
+		{
+			/* No acknowledgement is sent for interrupt requests. */
+			injectedRequest.haltState = injectedRequest.HALT_REQUESTED;
+			injectedRequest.isAcknowledged = true;
+			bmport.write("\003", 1);
+			injectedRequestTimer.start();
+		}
+		return true;
+	}
+	void resetRemoteProtocolState(void)
+	{
+		isTargetRunning = isTargetStepping = isNoAckModeRequested = isNoAckMode = isGdbReplyPending = isResumptionAcknowledgementPending = false;
+		isInjectedReadSupported = true;
+		gdbPacketFramer.reset();
+		probePacketFramer.reset();
+		if (injectedRequest.isPending)
+		{
+			injectedRequest.probeData.clear();
+			injectedRequest.haltState = injectedRequest.TARGET_NOT_HALTED;
+			completeInjectedRequest();
+		}
+		probeDataForGdb.clear();
+	}
 
 	void shutdown(void)
 	{
@@ -138,6 +439,7 @@ private:
 		}
 
 		gdb_tcpserver.close();
+		resetRemoteProtocolState();
 
 		bmport.blockSignals(false);
 		emit BlackMagicProbeDisconnected();
@@ -146,6 +448,13 @@ signals:
 	void BlackMagicProbeConnected(void);
 	void GdbClientDisconnected(void);
 	void BlackMagicProbeDisconnected(void);
+	/* Emitted when an injected memory read completes. An empty data array means that the read has failed. */
+	void injectedMemoryReadCompleted(unsigned requestNumber, const QByteArray data);
+	/* Emitted when the target cannot be halted, or the probe does not reply to injected memory reads. */
+	void injectedMemoryReadsNotSupported(void);
+	/* Emitted when an injected request completes. If the probe did not reply to some of the request
+	 * packets, there are less replies than request packets. */
+	void injectedPacketsCompleted(unsigned requestNumber, const QVector<QByteArray> replies);
 private slots:
 	void probeErrorOccurred(QSerialPort::SerialPortError error)
 	{
@@ -167,21 +476,44 @@ private slots:
 		if (!bmport.isOpen())
 			qDebug() << "WARNING: gdb data received, but no blackmagic probe connected; discarding gdb data:" << gdb_client_socket->readAll();
 		else
-			bmport.write(gdb_client_socket->readAll());
+		{
+			QByteArray data = gdb_client_socket->readAll();
+			gdbPacketFramer.append(data);
+			while (gdbPacketFramer.nextPacket())
+				scanGdbPacket(gdbPacketFramer.payload());
+			if (!injectedRequest.isPending)
+				bmport.write(data);
+			else for (const auto & c : data)
+				if (c == '\003' && injectedRequest.haltState != injectedRequest.TARGET_NOT_HALTED)
+					/* The target is being halted for the injected request, do not resume it afterwards. */
+					injectedRequest.isInterruptRequested = true;
+				else if (injectedRequest.heldGdbData.isEmpty() && (c == '+' || c == '-' || c == '\003'))
+					bmport.write(& c, 1);
+				else
+					injectedRequest.heldGdbData += c;
+		}
 	}
 
 	void bmportReadyRead(void)
 	{
-		if (!gdb_client_socket || !gdb_client_socket->isValid() || !gdb_client_socket->isOpen())
-			qDebug() << "WARNING: blackmagic probe data received, but no gdb client connected; discarding blackmagic data:" << bmport.readAll();
+		QByteArray data = bmport.readAll();
+		if (isResumptionAcknowledgementPending && data.startsWith('+'))
+			data.remove(0, 1), isResumptionAcknowledgementPending = false;
+		if (!injectedRequest.isPending)
+			probeDataForGdb += data;
 		else
-			gdb_client_socket->write(bmport.readAll());
+		{
+			injectedRequest.probeData += data;
+			extractInjectedRequestReplies();
+		}
+		flushProbeDataForGdb();
 	}
 
 	void newGdbConnection(void)
 	{
 		qDebug() << "gdb client connected";
 		gdb_client_socket = gdb_tcpserver.nextPendingConnection();
+		resetRemoteProtocolState();
 		connect(gdb_client_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(gdbSocketErrorOccurred(QAbstractSocket::SocketError)));
 		connect(gdb_client_socket, SIGNAL(readyRead()), this, SLOT(gdbSocketReadyRead()));
 		connect(gdb_client_socket, &QTcpSocket::disconnected, [&] { shutdown(); });
@@ -192,6 +524,27 @@ public:
 		connect(& bmport, SIGNAL(errorOccurred(QSerialPort::SerialPortError)), this, SLOT(probeErrorOccurred(QSerialPort::SerialPortError)));
 		connect(& bmport, SIGNAL(readyRead()), this, SLOT(bmportReadyRead()));
 		connect(& gdb_tcpserver, SIGNAL(newConnection()), this, SLOT(newGdbConnection()));
+		injectedRequestTimer.setSingleShot(true);
+		connect(& injectedRequestTimer, & QTimer::timeout, [&] {
+			if (injectedRequest.isDraining)
+			{
+				qDebug() << "no late reply received for a timed out injected request, dropping the gdb connection";
+				QMessageBox::critical(0, "Blackmagic probe not responding",
+						      "The blackmagic probe did not reply to a request sent by the frontend,\n"
+						      "the connection to the probe will be closed.\n\n"
+						      "Please, reconnect to the probe.");
+				shutdown();
+				return;
+			}
+			/* Report the failure now, but keep holding back packets from gdb, until the late reply is received. */
+			injectedRequest.isDraining = true;
+			injectedRequestTimer.start(INJECTED_REPLY_DRAIN_TIMEOUT_MS);
+			if (injectedRequest.isMemoryRead)
+				isInjectedReadSupported = false;
+			reportInjectedRequestResult();
+			if (injectedRequest.isMemoryRead)
+				emit injectedMemoryReadsNotSupported();
+		});
 	}
 	~BlackMagicProbeServer(void)
 	{
@@ -258,6 +611,26 @@ public:
 		else
 			qDebug() << "WARNING: tried to send data to the blackmagic probe, and no probe is connected; data:" << packet;
 	}
+	/* Starts reading target memory while the target is running. The target is briefly halted for the read.
+	 * Returns false if the read cannot be started, otherwise signal 'injectedMemoryReadCompleted()'
+	 * is emitted when the read completes. */
+	bool injectMemoryRead(unsigned requestNumber, uint32_t address, uint32_t length)
+	{
+		/* Do not interfere with single stepping. */
+		if (!isTargetRunning || isTargetStepping || !isInjectedReadSupported)
+			return false;
+		return startInjectedRequest(requestNumber, GdbRemote::readMemoryRequest(address, length, length), true, INJECTED_READ_TIMEOUT_MS);
+	}
+	/* Sends remote protocol request packets to the probe, while the target is halted, and gdb is not waiting
+	 * for a reply from the probe. Returns false if the packets cannot be sent, otherwise signal
+	 * 'injectedPacketsCompleted()' is emitted when the replies to all packets are received, or when
+	 * the probe does not reply to a packet in the timeout passed. */
+	bool injectPackets(unsigned requestNumber, const QVector<QByteArray> & packets, int timeoutMs)
+	{
+		if (isTargetRunning || isGdbReplyPending)
+			return false;
+		return startInjectedRequest(requestNumber, packets, false, timeoutMs);
+	}
 };
 
 
@@ -268,6 +641,9 @@ public:
 	enum
 	{
 		MAX_RETURNED_SEARCH_RESULTS	= 1000,
+		/* The number of files that are searched in parallel, before the search results for these files are
+		 * reported. Files in a shard are searched in parallel, but their results are reported in order. */
+		FILES_PER_SEARCH_SHARD		= 64,
 	};
 	struct SearchResult
 	{
@@ -278,66 +654,268 @@ public:
 		SearchResult(const QString & fullFileName, const QString & sourceCodeLineText, int lineNumber) :
 			fullFileName(fullFileName), sourceCodeLineText(sourceCodeLineText), lineNumber(lineNumber) {}
 	};
-	StringFinder() {}
+	StringFinder(SourceCorpus & sourceCorpus) : sourceCorpus(sourceCorpus) {}
 
 	enum SEARCH_FLAGS_ENUM
 	{
 		SEARCH_FOR_WHOLE_WORDS_ONLY = 1 << 0,
 	};
+	/* Starts a new search generation, and returns its number. Any search in progress, that belongs to a previous
+	 * generation, is abandoned as soon as possible. This can be called from any thread. */
+	unsigned startNewSearchGeneration(void) { return ++ searchGeneration; }
+
+private:
+	std::atomic<unsigned> searchGeneration { 0 };
+	QThreadPool threadPool;
+
+	struct FileSearchResult
+	{
+		bool isFileRead = false;
+		QVector<SearchResult> results;
+	};
+	struct SearchPattern
+	{
+		/* The searched string, encoded in UTF-8. */
+		QByteArray literal;
+		/* The regular expression pattern, used when the literal string search cannot be applied. */
+		QString regularExpression;
+		bool isLiteralSearch = false;
+		bool isWholeWordsOnlySearch = false;
+	};
+	/* Scans the contents of a file for a literal string, directly over the UTF-8 encoded file bytes. */
+	static void searchLiteral(const QString & fileName, const QByteArray & contents, const SearchPattern & pattern,
+				  FileSearchResult & result, const std::atomic<unsigned> * searchGeneration, unsigned generation)
+	{
+		LiteralSearch::findLines(contents, pattern.literal, pattern.isWholeWordsOnlySearch,
+					 [&] (int lineNumber, const char * lineStart, const char * lineEnd) -> bool
+		{
+			result.results << SearchResult(fileName, QString::fromUtf8(lineStart, lineEnd - lineStart), lineNumber);
+			return result.results.size() < MAX_RETURNED_SEARCH_RESULTS && * searchGeneration == generation;
+		});
+	}
+	/* Searches a single file. This is run in the thread pool, so it must not access the string finder data,
+	 * except for the source corpus, which is thread safe. */
+	static FileSearchResult searchFile(SourceCorpus * sourceCorpus, const QString & fileName, const SearchPattern & pattern, const std::atomic<unsigned> * searchGeneration, unsigned generation)
+	{
+		FileSearchResult result;
+		if (* searchGeneration != generation)
+			return result;
+		std::shared_ptr<const SourceFileContents> contents = sourceCorpus->fileContents(fileName);
+		if (!contents)
+			return result;
+		result.isFileRead = true;
+		if (pattern.isLiteralSearch)
+		{
+			searchLiteral(fileName, contents->bytes, pattern, result, searchGeneration, generation);
+			return result;
+		}
+		QRegularExpression rx(pattern.regularExpression);
+		for (int i = 0; i < contents->lineCount(); i ++)
+		{
+			QByteArray line = contents->line(i);
+			if (rx.match(line).lastCapturedIndex() != -1)
+			{
+				result.results << SearchResult(fileName, line, i + 1);
+				if (result.results.size() >= MAX_RETURNED_SEARCH_RESULTS || * searchGeneration != generation)
+					break;
+			}
+		}
+		return result;
+	}
 
 public slots:
-	void findString(const QString & str, unsigned flags = 0)
+	void findString(const QString & str, unsigned flags, unsigned generation)
 	{
-		int fileCount = 0;
-		QSharedPointer<QVector<SearchResult>> results(QSharedPointer<QVector<SearchResult>>::create());
+		/* Do not bother starting searches that have already been superseded. */
+		if (searchGeneration != generation)
+			return;
+		int fileCount = 0, resultCount = 0;
 		/*! \todo	Properly escape all regular expression special characters. I am not sure all of them are
 		 *		escaped at this moment. */
-		QString pattern = str;
+		SearchPattern pattern;
+		QString & rx = pattern.regularExpression;
+		rx = str;
 		const QString specialCharacters = "\\^$.[]|()?*+";
 		for (const QChar & c : specialCharacters)
-			pattern.replace(c, QString("\\") + c);
+			rx.replace(c, QString("\\") + c);
 		if (flags & SEARCH_FOR_WHOLE_WORDS_ONLY)
-			pattern = QString("\\b") + pattern + "\\b";
-		QRegularExpression rx;
-		rx.setPattern(pattern);
-		for (const auto & fileName : sourceCodeFiles)
+			rx = QString("\\b") + rx + "\\b";
+		/* The searched string is always taken literally, so the literal search is used whenever possible. The
+		 * regular expression search is only used for empty strings, and for whole word searches of strings that
+		 * start or end with non-ASCII characters, for which the word boundaries cannot be determined at byte level. */
+		pattern.literal = str.toUtf8();
+		pattern.isWholeWordsOnlySearch = flags & SEARCH_FOR_WHOLE_WORDS_ONLY;
+		pattern.isLiteralSearch = !pattern.literal.isEmpty() && (!pattern.isWholeWordsOnlySearch
+			|| !((pattern.literal.at(0) & 0x80) || (pattern.literal.at(pattern.literal.length() - 1) & 0x80)));
+
+		/* Only scan the files that may contain the searched string, according to the trigram index. */
+		std::vector<int> candidates;
+		trigramIndex.candidateFiles(pattern.literal, candidates);
+		std::vector<int> orderedCandidates = orderFileIds(candidates);
+
+		for (size_t shardStart = 0; shardStart < orderedCandidates.size(); shardStart += FILES_PER_SEARCH_SHARD)
 		{
-			QFile f(fileName);
-			if (!QFileInfo(fileName).exists())
-			{
-				/* Attempt to adjust the filename path on windows systems. */
-				f.setFileName(Utils::filenameToWindowsFilename(fileName));
-			}
-			if (!f.open(QFile::ReadOnly))
-				continue;
-			fileCount ++;
-			int i = 1;
-			QList<QByteArray> lines = f.readAll().split('\n');
-			for (const auto & line : lines)
+			size_t shardEnd = std::min(shardStart + FILES_PER_SEARCH_SHARD, orderedCandidates.size());
+			QVector<QFuture<FileSearchResult>> shard;
+			for (size_t i = shardStart; i < shardEnd; i ++)
+				shard << QtConcurrent::run(& threadPool, & StringFinder::searchFile, & sourceCorpus, trigramIndex.fileName(orderedCandidates.at(i)),
+							   pattern, (const std::atomic<unsigned> *) & searchGeneration, generation);
+			QSharedPointer<QVector<SearchResult>> results(QSharedPointer<QVector<SearchResult>>::create());
+			bool isTruncated = false;
+			for (int i = 0; i < shard.size(); i ++)
 			{
-				if (rx.match(line).lastCapturedIndex() != -1)
-					* results.get() << SearchResult(fileName, line, i);
-				i ++;
-				if (results.get()->size() >= MAX_RETURNED_SEARCH_RESULTS)
+				const FileSearchResult & fileResult = shard[i].result();
+				if (isTruncated)
+					continue;
+				int fileId = orderedCandidates.at(shardStart + i);
+				if (fileResult.isFileRead)
 				{
-					emit searchReady(str, results, true);
-					return;
+					fileCount ++;
+					/* Files that could not be indexed before, e.g. because they did not exist at that time, are always
+					 * searched. Index such files now, if they have become available. */
+					if (!trigramIndex.isFileIndexed(fileId))
+						indexFile(fileId);
 				}
+				for (const auto & r : fileResult.results)
+				{
+					if (resultCount == MAX_RETURNED_SEARCH_RESULTS)
+					{
+						isTruncated = true;
+						break;
+					}
+					* results.get() << r;
+					resultCount ++;
+				}
+			}
+			if (searchGeneration != generation)
+				return;
+			if (!results->isEmpty())
+				emit searchResultsAvailable(generation, results);
+			if (isTruncated)
+			{
+				emit searchCompleted(generation, str, true);
+				return;
 			}
 		}
-		qDebug() << "files searched:" << fileCount;
-		emit searchReady(str, results, false);
+		qDebug() << "files searched:" << fileCount << "of" << trigramIndex.fileCount();
+		emit searchCompleted(generation, str, false);
 	}
 	void addFilesToSearchSet(const QStringList & sourceCodeFiles)
 	{
+		if (!fileWatcher)
+		{
+			fileWatcher = new QFileSystemWatcher(this);
+			connect(fileWatcher, & QFileSystemWatcher::fileChanged, this, & StringFinder::sourceFileChanged);
+		}
+		/* Index any newly registered files. This runs in the string searching thread, so that building
+		 * the index does not block the user interface. */
 		for (const auto & f : sourceCodeFiles)
-			this->sourceCodeFiles.insert(f);
+		{
+			FileId fileId = PathTable::global().fileId(f);
+			if (trigramIndex.registerFile(fileId, f))
+				indexFile(fileId);
+		}
+	}
+	void findIdentifierReferences(const QString & identifier, unsigned generation)
+	{
+		if (searchGeneration != generation)
+			return;
+		for (int fileId = 0; fileId < trigramIndex.fileIdLimit(); fileId ++)
+			if (trigramIndex.isFileRegistered(fileId) && !trigramIndex.isFileIndexed(fileId))
+				indexFile(fileId);
+		/* Only report occurrences of the identifier in code, skipping comments and strings.
+		 * Only one result is reported per source code line. */
+		std::vector<IdentifierIndex::Occurrence> occurrences = identifierIndex.occurrences(identifier.toStdString(), true);
+		std::vector<int> fileIds;
+		for (const auto & o : occurrences)
+			fileIds.push_back(o.fileId);
+		std::sort(fileIds.begin(), fileIds.end());
+		fileIds.erase(std::unique(fileIds.begin(), fileIds.end()), fileIds.end());
+		fileIds = orderFileIds(fileIds);
+		std::unordered_map<int /* file id */, int /* file order */> fileOrder;
+		for (int i = 0; i < (int) fileIds.size(); i ++)
+			fileOrder[fileIds.at(i)] = i;
+		std::sort(occurrences.begin(), occurrences.end(), [&] (const IdentifierIndex::Occurrence & a, const IdentifierIndex::Occurrence & b) -> bool
+			{ return fileOrder.at(a.fileId) < fileOrder.at(b.fileId) || (a.fileId == b.fileId && a.lineNumber < b.lineNumber); });
+
+		QSharedPointer<QVector<SearchResult>> results(QSharedPointer<QVector<SearchResult>>::create());
+		std::shared_ptr<const SourceFileContents> contents;
+		int fileId = -1, lineNumber = -1;
+		for (const auto & o : occurrences)
+		{
+			if (o.fileId == fileId && o.lineNumber == lineNumber)
+				continue;
+			if (o.fileId != fileId)
+				contents = sourceCorpus.fileContents((FileId) o.fileId);
+			fileId = o.fileId, lineNumber = o.lineNumber;
+			if (!contents || lineNumber > contents->lineCount())
+				continue;
+			if (results->size() == MAX_RETURNED_SEARCH_RESULTS)
+			{
+				emit searchResultsAvailable(generation, results);
+				emit searchCompleted(generation, identifier, true);
+				return;
+			}
+			* results.get() << SearchResult(trigramIndex.fileName(fileId), QString::fromUtf8(contents->line(lineNumber - 1)), lineNumber);
+		}
+		if (!results->isEmpty())
+			emit searchResultsAvailable(generation, results);
+		emit searchCompleted(generation, identifier, false);
+	}
+	void sourceFileChanged(const QString & filesystemFileName)
+	{
+		/* Files may get replaced when saved, instead of being modified in place. In this case,
+		 * the file is no longer watched, and needs to be added again to the file watcher. */
+		auto id = watchedFileIds.find(filesystemFileName);
+		if (id == watchedFileIds.end())
+			return;
+		int fileId = id.value();
+		watchedFileIds.erase(id);
+		fileWatcher->removePath(filesystemFileName);
+		indexFile(fileId);
 	}
 
 signals:
-	void searchReady(const QString pattern, const QSharedPointer<QVector<StringFinder::SearchResult>> results, bool resultsTruncated);
+	/* Search results are reported incrementally, as they become available, and in order. */
+	void searchResultsAvailable(unsigned generation, const QSharedPointer<QVector<StringFinder::SearchResult>> results);
+	void searchCompleted(unsigned generation, const QString pattern, bool resultsTruncated);
 private:
-	std::set<QString> sourceCodeFiles;
+	TrigramIndex trigramIndex;
+	/* Both indices use the global file ids. */
+	IdentifierIndex identifierIndex;
+	QFileSystemWatcher * fileWatcher = 0;
+	QHash<QString /* filesystem file name */, int /* file id */> watchedFileIds;
+
+	SourceCorpus & sourceCorpus;
+
+	/* Orders files by their names, and then by their full names. Search results are reported
+	 * in this order, so that the order of the search results is deterministic. */
+	std::vector<int> orderFileIds(const std::vector<int> & fileIds) const
+	{
+		std::vector<std::pair<QString /* file name */, int /* file id */>> files;
+		for (const auto & fileId : fileIds)
+			files.push_back(std::pair<QString, int>(QFileInfo(trigramIndex.fileName(fileId)).fileName(), fileId));
+		std::sort(files.begin(), files.end(), [&] (const std::pair<QString, int> & a, const std::pair<QString, int> & b) -> bool
+			{ return a.first < b.first || (a.first == b.first && trigramIndex.fileName(a.second) < trigramIndex.fileName(b.second)); });
+		std::vector<int> result;
+		for (const auto & f : files)
+			result.push_back(f.second);
+		return result;
+	}
+	void indexFile(int fileId)
+	{
+		std::shared_ptr<const SourceFileContents> contents = sourceCorpus.fileContents((FileId) fileId);
+		if (!contents)
+		{
+			trigramIndex.removeFile(fileId);
+			identifierIndex.removeFile(fileId);
+			return;
+		}
+		trigramIndex.indexFile(fileId, contents->bytes);
+		identifierIndex.indexFile(fileId, contents->bytes, contents->tokens());
+		if (!watchedFileIds.contains(contents->filesystemFileName) && fileWatcher->addPath(contents->filesystemFileName))
+			watchedFileIds.insert(contents->filesystemFileName, fileId);
+	}
 };
 
 Q_DECLARE_METATYPE(QSharedPointer<QVector<StringFinder::SearchResult>>)
@@ -347,6 +925,8 @@ struct GdbVarObjectTreeItem
 private:
 	QList<GdbVarObjectTreeItem *> children;
 	GdbVarObjectTreeItem	* parent = 0;
+	/* The index of this item in the list of children of its parent. */
+	int rowNumber = 0;
 	/* This is the 'numchild' value as reported by the gdb mi varobject report. */
 	int reportedChildCount = 0;
 public:
@@ -356,10 +936,25 @@ public:
 	QString value;
 	bool isChildrenFetchingInProgress = false;
 	bool isInScope = true;
+	/* Children are fetched from gdb in pages. If not all children of an item have been fetched, a placeholder
+	 * item is shown after the fetched children, and the next page is fetched when the placeholder becomes visible.
+	 * Placeholder items do not correspond to gdb varobjects. */
+	bool isPlaceholder = false;
+	/* The last times at which the pages of fetched children were visible, indexed by page number. */
+	std::vector<qint64> pageVisibleTimes;
+	bool hasPlaceholder(void) const { return !children.isEmpty() && children.last()->isPlaceholder; }
+	int fetchedChildCount(void) const { return children.count() - (hasPlaceholder() ? 1 : 0); }
 	int getReportedChildCount(void) const { return isInScope ? reportedChildCount : 0; }
 	void setReportedChildCount(int reportedChildCount) { this->reportedChildCount = reportedChildCount; }
-	void deleteChildren(void) { qDeleteAll(children); children.clear(); }
-	void deleteChildAtRow(int row) { if (row < children.size()) children.removeAt(row); }
+	void deleteChildren(void) { qDeleteAll(children); children.clear(); pageVisibleTimes.clear(); }
+	void deleteChildAtRow(int row)
+	{
+		if (row >= children.size())
+			return;
+		delete children.takeAt(row);
+		for (; row < children.size(); row ++)
+			children.at(row)->rowNumber = row;
+	}
 
 	~GdbVarObjectTreeItem() { deleteChildren(); }
 
@@ -367,7 +962,14 @@ public:
 	int childCount(void) const { return children.count(); }
 	int columnCount(void) const { return 4; }
 
-	void appendChild(GdbVarObjectTreeItem * child) { children.push_back(child); child->parent = this; }
+	void appendChild(GdbVarObjectTreeItem * child) { child->rowNumber = children.size(); children.push_back(child); child->parent = this; }
+	void insertChild(int row, GdbVarObjectTreeItem * child)
+	{
+		children.insert(row, child);
+		child->parent = this;
+		for (; row < children.size(); row ++)
+			children.at(row)->rowNumber = row;
+	}
 	GdbVarObjectTreeItem * child(int row) const { return children.at(row); }
 	QVariant data(int column) const
 	{
@@ -379,6 +981,8 @@ public:
 		case 3: /* Special case - if the 'value' string is recognized to be a decimal number,
 			 * return the hexadecimal representation of this number. */
 		{
+			if (isPlaceholder)
+				return QVariant();
 			bool ok;
 			unsigned long long v = value.toULongLong(& ok);
 			if (!ok)
@@ -388,8 +992,7 @@ public:
 		default: return "<<< bad column number >>>";
 		}
 	}
-	/*! \todo	I don't understand why the 'const_cast' is needed here. */
-	int row() const { if (parent) return parent->children.indexOf(const_cast<GdbVarObjectTreeItem *>(this)); return 0; }
+	int row() const { return parent ? rowNumber : 0; }
 	void dump(int indentationLevel = 0)
 	{
 		qDebug() << QString(indentationLevel, ' ') << miName << ":" << name;
@@ -403,20 +1006,76 @@ class GdbVarObjectTreeItemModel : public QAbstractItemModel
 /* The 'Editable Tree Model' Qt example was very useful when making this customized
  * item model class. */
 	Q_OBJECT
+public:
+	/* The number of children fetched from gdb at a time. */
+	static const int CHILD_PAGE_SIZE = 100;
 private:
+	/* Used for timestamping the visibility of pages of children. */
+	QElapsedTimer clock;
 	/* Dummy root node. */
 	/*! \todo	THIS CURRENTLY LEAKS MEMORY */
 	GdbVarObjectTreeItem root;
 	/*! \todo	This is very evil... */
 	QSet<const QString> highlightedVarObjectNames;
+	/* All items in the tree, so that items can be found by their gdb machine interface names
+	 * without scanning the tree, when processing gdb varobject change lists. */
+	QHash<QString /* miName */, GdbVarObjectTreeItem *> itemsByMiName;
 
-	void markIndexAsChanged(const QModelIndex & nodeIndex, const GdbVarObjectTreeItem * item)
+	void registerItem(GdbVarObjectTreeItem * item)
+	{
+		if (!item->isPlaceholder)
+			itemsByMiName.insert(item->miName, item);
+		for (int i = 0; i < item->childCount(); i ++)
+			registerItem(item->child(i));
+	}
+	void unregisterChildren(const GdbVarObjectTreeItem * item)
+	{
+		for (int i = 0; i < item->childCount(); i ++)
+		{
+			GdbVarObjectTreeItem * c = item->child(i);
+			unregisterChildren(c);
+			if (itemsByMiName.value(c->miName) == c)
+				itemsByMiName.remove(c->miName);
+		}
+	}
+	/* Shows, updates or removes the placeholder item for the children of an item which have not yet been fetched. */
+	void updatePlaceholder(const QModelIndex & parentIndex, GdbVarObjectTreeItem * item)
+	{
+		int remainingChildCount = item->getReportedChildCount() - item->fetchedChildCount();
+		if (remainingChildCount > 0)
+		{
+			GdbVarObjectTreeItem * placeholder;
+			if (!item->hasPlaceholder())
+			{
+				beginInsertRows(parentIndex, item->childCount(), item->childCount());
+				placeholder = new GdbVarObjectTreeItem;
+				placeholder->isPlaceholder = true;
+				placeholder->name = "more...";
+				item->appendChild(placeholder);
+				endInsertRows();
+			}
+			placeholder = item->child(item->childCount() - 1);
+			placeholder->value = QString("<<< %1 more children, scroll down to fetch them >>>").arg(remainingChildCount);
+			emitItemDataChanged(placeholder);
+		}
+		else if (item->hasPlaceholder())
+		{
+			beginRemoveRows(parentIndex, item->childCount() - 1, item->childCount() - 1);
+			item->deleteChildAtRow(item->childCount() - 1);
+			endRemoveRows();
+		}
+	}
+	void emitItemDataChanged(GdbVarObjectTreeItem * item)
+	{
+		int row = item->row();
+		emit dataChanged(createIndex(row, 0, item), createIndex(row, item->columnCount() - 1, item));
+	}
+	void markIndexAsChanged(const QModelIndex & nodeIndex, GdbVarObjectTreeItem * item)
 	{
 		if (!nodeIndex.isValid())
 			return;
-		int row = item->row();
 		highlightedVarObjectNames.insert(item->miName);
-		emit dataChanged(index(row, 0, nodeIndex.parent()), index(row, item->columnCount() - 1, nodeIndex.parent()));
+		emitItemDataChanged(item);
 	}
 public:
 	GdbVarObjectTreeItemModel(QObject * parent = 0) : QAbstractItemModel(parent)
@@ -424,9 +1083,21 @@ public:
 		root.name = "Name";
 		root.value = "Value";
 		root.type = "Type";
+		clock.start();
 	}
 	~GdbVarObjectTreeItemModel() { /*! \todo WRITE THIS */ }
-	void clearHighlightedVarObjectNames(void) { highlightedVarObjectNames.clear(); }
+	void clearHighlightedVarObjectNames(void)
+	{
+		QSet<const QString> names;
+		names.swap(highlightedVarObjectNames);
+		/* Only the previously highlighted items need to be repainted. */
+		for (const auto & name : names)
+		{
+			auto i = itemsByMiName.constFind(name);
+			if (i != itemsByMiName.cend())
+				emitItemDataChanged(i.value());
+		}
+	}
 	void dumpTree()
 	{
 		root.dump();
@@ -436,6 +1107,7 @@ public:
 	{
 		emit beginInsertRows(QModelIndex(), root.childCount(), root.childCount());
 		root.appendChild(item);
+		registerItem(item);
 		emit endInsertRows();
 	}
 
@@ -527,27 +1199,103 @@ public:
 		if (!parent.isValid())
 			return false;
 		GdbVarObjectTreeItem * t = static_cast<GdbVarObjectTreeItem *>(parent.internalPointer());
-		return (t->getReportedChildCount() != t->childCount()) && !t->isChildrenFetchingInProgress;
+		return (t->getReportedChildCount() > t->fetchedChildCount()) && !t->isChildrenFetchingInProgress && !t->isPlaceholder;
 	}
-	void fetchMore(const QModelIndex &parent)
+	/* Requests the next page of children of an item. */
+	void fetchMore(const QModelIndex &parent) override
 	{
-		if (!parent.isValid())
+		if (!canFetchMore(parent))
 			return;
 		GdbVarObjectTreeItem * t = static_cast<GdbVarObjectTreeItem *>(parent.internalPointer());
 		t->isChildrenFetchingInProgress = true;
-		if (t->getReportedChildCount() && !t->childCount())
-			emit readGdbVarObjectChildren(t->miName);
+		int from = t->fetchedChildCount();
+		emit readGdbVarObjectChildren(t->miName, from, std::min(from + CHILD_PAGE_SIZE, t->getReportedChildCount()));
 	}
+	/* Appends a page of children, fetched from gdb, to the children of an item. */
 	void childrenFetched(const QModelIndex &parent, const std::vector<GdbVarObjectTreeItem *>& children)
 	{
 		if (!parent.isValid())
 			return;
-		emit beginInsertRows(parent, 0, children.size() - 1);
 		GdbVarObjectTreeItem * t = static_cast<GdbVarObjectTreeItem *>(parent.internalPointer());
 		t->isChildrenFetchingInProgress = false;
+		if (children.empty())
+		{
+			/* Do not attempt to fetch children over and over again, if gdb does not return any. */
+			t->setReportedChildCount(t->fetchedChildCount());
+			updatePlaceholder(parent, t);
+			return;
+		}
+		int row = t->fetchedChildCount();
+		beginInsertRows(parent, row, row + children.size() - 1);
 		for (const auto & c : children)
-			t->appendChild(c);
-		emit endInsertRows();
+		{
+			t->insertChild(row ++, c);
+			registerItem(c);
+		}
+		endInsertRows();
+		/* Consider the fetched children visible, so that they are not evicted right away. */
+		t->pageVisibleTimes.resize((row + CHILD_PAGE_SIZE - 1) / CHILD_PAGE_SIZE, clock.elapsed());
+		updatePlaceholder(parent, t);
+	}
+	/* Records that an item is visible in a view. If the item is a placeholder, the next page of children is fetched. */
+	void markIndexAsVisible(const QModelIndex & index)
+	{
+		if (!index.isValid())
+			return;
+		GdbVarObjectTreeItem * t = static_cast<GdbVarObjectTreeItem *>(index.internalPointer());
+		GdbVarObjectTreeItem * parent = t->parentItem();
+		if (parent == & root)
+			return;
+		if (t->isPlaceholder)
+		{
+			fetchMore(index.parent());
+			return;
+		}
+		unsigned page = t->row() / CHILD_PAGE_SIZE;
+		if (page < parent->pageVisibleTimes.size())
+			parent->pageVisibleTimes.at(page) = clock.elapsed();
+	}
+	/* Removes the trailing pages of children that have not been visible for the time passed. Only trailing pages
+	 * are removed, so that the fetched children of an item are always the first children of the item.
+	 * The first page of children is never removed. Returns the names of the gdb varobjects for the removed
+	 * children, these should be deleted in gdb. */
+	QStringList evictStalePages(qint64 maxInvisibleTimeMs)
+	{
+		QStringList evictedMiNames;
+		qint64 now = clock.elapsed();
+		std::vector<std::pair<QString /* miName */, GdbVarObjectTreeItem *>> candidates;
+		for (auto i = itemsByMiName.cbegin(); i != itemsByMiName.cend(); i ++)
+			if (i.value()->pageVisibleTimes.size() > 1 && !i.value()->isChildrenFetchingInProgress)
+				candidates.push_back(std::make_pair(i.key(), i.value()));
+		for (const auto & c : candidates)
+		{
+			/* Items may have been removed when evicting pages of their parents. */
+			if (itemsByMiName.value(c.first) != c.second)
+				continue;
+			GdbVarObjectTreeItem * t = c.second;
+			QModelIndex parentIndex = createIndex(t->row(), 0, t);
+			bool isEvicted = false;
+			while (t->pageVisibleTimes.size() > 1 && now - t->pageVisibleTimes.back() > maxInvisibleTimeMs)
+			{
+				int first = (t->pageVisibleTimes.size() - 1) * CHILD_PAGE_SIZE, last = t->fetchedChildCount() - 1;
+				beginRemoveRows(parentIndex, first, last);
+				for (int row = first; row <= last; row ++)
+				{
+					GdbVarObjectTreeItem * child = t->child(first);
+					evictedMiNames << child->miName;
+					unregisterChildren(child);
+					if (itemsByMiName.value(child->miName) == child)
+						itemsByMiName.remove(child->miName);
+					t->deleteChildAtRow(first);
+				}
+				endRemoveRows();
+				t->pageVisibleTimes.pop_back();
+				isEvicted = true;
+			}
+			if (isEvicted)
+				updatePlaceholder(parentIndex, t);
+		}
+		return evictedMiNames;
 	}
 	void updateNodeValue(const QModelIndex & nodeIndex, const QString & newValue)
 	{
@@ -573,6 +1321,7 @@ public:
 		if (t->childCount())
 		{
 			beginRemoveRows(nodeIndex, 0, t->childCount() - 1);
+			unregisterChildren(t);
 			t->deleteChildren();
 			endRemoveRows();
 		}
@@ -581,6 +1330,15 @@ public:
 		t->setReportedChildCount(newNumChildren);
 		markIndexAsChanged(nodeIndex, t);
 	}
+	/* Sets the value of an item, without highlighting the item as changed. */
+	void setNodeValue(const QModelIndex & nodeIndex, const QString & value)
+	{
+		if (!nodeIndex.isValid())
+			return;
+		GdbVarObjectTreeItem * t = static_cast<GdbVarObjectTreeItem *>(nodeIndex.internalPointer());
+		t->value = value;
+		emitItemDataChanged(t);
+	}
 	void markNodeAsOutOfScope(const QModelIndex & nodeIndex)
 	{
 		if (!nodeIndex.isValid())
@@ -592,6 +1350,7 @@ public:
 		if (t->childCount())
 		{
 			beginRemoveRows(nodeIndex, 0, t->childCount() - 1);
+			unregisterChildren(t);
 			t->deleteChildren();
 			endRemoveRows();
 		}
@@ -611,27 +1370,12 @@ public:
 		/*! \todo DON'T JUST WIPE OUT THE TYPE STRING: t->type = "???"; */
 		markIndexAsChanged(nodeIndex, t);
 	}
-	QModelIndex indexForMiVariableName(const QString & miName)
+	QModelIndex indexForMiVariableName(const QString & miName) const
 	{
-		std::function<QModelIndex(const QModelIndex & root)> scan = [&](const QModelIndex & root) -> QModelIndex
-		{
-			GdbVarObjectTreeItem * t = static_cast<GdbVarObjectTreeItem *>(root.internalPointer());
-			if (t->miName == miName)
-				return root;
-			int i = 0;
-			QModelIndex x;
-			while ((x = index(i ++, 0, root)).isValid())
-				if ((x = scan(x)).isValid())
-					break;
-			return x;
-		};
-
-		int i = 0;
-		QModelIndex x, invalid = QModelIndex();
-		while ((x = index(i ++, 0, invalid)).isValid())
-			if ((x = scan(x)).isValid())
-				break;
-		return x;
+		auto i = itemsByMiName.constFind(miName);
+		if (i == itemsByMiName.cend())
+			return QModelIndex();
+		return createIndex(i.value()->row(), 0, i.value());
 	}
 
 	void removeTopLevelItem(const QModelIndex & index)
@@ -639,6 +1383,10 @@ public:
 		if (!index.parent().isValid())
 		{
 			beginRemoveRows(QModelIndex(), index.row(), index.row());
+			GdbVarObjectTreeItem * t = root.child(index.row());
+			unregisterChildren(t);
+			if (itemsByMiName.value(t->miName) == t)
+				itemsByMiName.remove(t->miName);
 			root.deleteChildAtRow(index.row());
 			endRemoveRows();
 		}
@@ -649,7 +1397,8 @@ public:
 		int i = root.childCount();
 		if (i)
 		{
-			beginRemoveRows(QModelIndex(), 0, 0);
+			beginRemoveRows(QModelIndex(), 0, i - 1);
+			itemsByMiName.clear();
 			do root.deleteChildAtRow(0); while (--i);
 			endRemoveRows();
 		}
@@ -663,7 +1412,7 @@ public:
 			return static_cast<GdbVarObjectTreeItem *>(index.internalPointer());
 	}
 signals:
-	void readGdbVarObjectChildren(const QString varObjectName);
+	void readGdbVarObjectChildren(const QString varObjectName, int from, int to);
 };
 
 class MainWindow : public QMainWindow
@@ -673,14 +1422,54 @@ class MainWindow : public QMainWindow
 private:
 	/* The minimum string length that needs to be entered so that the object locator performs a search for the text entered. */
 	const int MIN_STRING_LENGTH_FOR_OBJECT_LOCATOR = 3;
+	/* The maximum number of best matching items that the object locator displays. */
+	const int MAX_OBJECT_LOCATOR_RESULTS = 1000;
 	const int MAX_LINE_LENGTH_IN_GDB_LOG_LIMITING_MODE = 1 * 1024;
 	const int MAX_GDB_LINE_COUNT_IN_GDB_LIMITING_MODE = 1 * 1024;
 
 	/* This is the number of maximum kept sessions, saved in the frontend settings file. */
 	const int MAX_KEPT_SESSIONS	= 10;
 
+	/* The maximum number of elements of arrays and strings that gdb prints in values. Only a preview of large values
+	 * is retrieved when the target halts, full values are retrieved on demand, for the selected items. */
+	const int VALUE_PREVIEW_MAX_ELEMENTS = 200;
+	/* Runs of repeated elements longer than this are printed by gdb as '<repeats N times>'. */
+	const int VALUE_PREVIEW_REPEAT_THRESHOLD = 10;
+	/* The number of bytes of data object values received from gdb since the target last halted,
+	 * counted in the UTF-8 encoding in which gdb sends them. */
+	qint64 valueBytesReceivedSinceStop = 0;
+	QLabel * labelValueBytesReceived;
+
+	/* Large gdb responses are applied by incremental jobs, so that the user interface remains responsive. */
+	IncrementalJobRunner incrementalJobRunner;
+	QProgressBar * progressBarIncrementalJobs;
+	QToolButton * toolButtonCancelIncrementalJobs;
+	const QString SYMBOLS_JOB_KIND = "symbols";
+	const QString STACK_VARIABLES_JOB_KIND = "stack-variables";
+	/* The number of items processed in a single step of an incremental job. This should be small enough,
+	 * so that a step takes much less time than the time slice of the incremental job runner. */
+	const unsigned SYMBOLS_PER_JOB_STEP = 64;
+	const int STACK_VARIABLES_PER_JOB_STEP = 64;
+	void countReceivedValueBytes(int byteCount);
+
+	/* Live watches are sampled periodically while the target is running, by injecting memory reads in the
+	 * remote protocol data stream to the blackmagic probe. When the target halts, live watches are sampled
+	 * through gdb. */
+	LiveWatchEngine liveWatchEngine;
+	void addLiveWatch(const QString & expression);
+	void updateLiveWatchView(void);
+
+	/* Target memory contents read while the target is halted. */
+	TargetMemoryCache targetMemoryCache;
+	/* Target memory is displayed in the memory dump view in pages, read only when displayed, and cached until the target is resumed. */
+	MemoryDumpModel memoryDumpModel;
+
 	/* Settings-related data. */
 	const QString SETTINGS_FILE_NAME					= "turbo.rc";
+	/* Peripheral snapshots are saved in a directory with this name, next to the settings file. */
+	const QString SVD_SNAPSHOTS_DIRECTORY_NAME				= "svd-snapshots";
+	/* The absolute path of the peripheral snapshots directory, determined when the settings file is opened. */
+	QString svdSnapshotsDirectory;
 
 	const QString SETTINGS_MAINWINDOW_STATE					= "mainwindows-state";
 	const QString SETTINGS_MAINWINDOW_GEOMETRY				= "mainwindows-geometry";
@@ -701,6 +1490,7 @@ private:
 	const QString SETTINGS_BOOL_SHOW_ONLY_SOURCES_WITH_MACHINE_CODE_STATE	= "setting-show-only-sources-with-machine-code-state";
 	const QString SETTINGS_BOOL_SHOW_ONLY_EXISTING_SOURCE_FILES		= "setting-show-only-existing-source-files";
 	const QString SETTINGS_CHECKBOX_ENABLE_NATIVE_DEBUGGING_STATE		= "checkbox-enable-native-debugging";
+	const QString SETTINGS_CHECKBOX_ENABLE_INCREMENTAL_FLASHING_STATE	= "checkbox-enable-incremental-flashing";
 
 	const QString SETTINGS_SCRATCHPAD_TEXT_CONTENTS				= "scratchpad-text-contents";
 
@@ -729,6 +1519,8 @@ private:
 		QString		targetSVDFileName;
 		QStringList	breakpoints;
 		QStringList	bookmarks;
+		/* Source path remapping rules, see 'PathResolver::RemapRule::toString()'. */
+		QStringList	sourcePathRemapRules;
 		static SessionState fromQVariant(const QVariant & v)
 		{
 			struct SessionState s;
@@ -741,6 +1533,8 @@ private:
 				s.breakpoints = l.at(2).toStringList();
 			if (l.size() > 3)
 				s.bookmarks = l.at(3).toStringList();
+			if (l.size() > 4)
+				s.sourcePathRemapRules = l.at(4).toStringList();
 			return s;
 		}
 		QVariant toVariant(void) const
@@ -750,6 +1544,7 @@ private:
 			v << targetSVDFileName;
 			v << breakpoints;
 			v << bookmarks;
+			v << sourcePathRemapRules;
 			return v;
 		}
 		const bool operator ==(const struct SessionState & rhs) const { return executableFileName == rhs.executableFileName; }
@@ -775,6 +1570,7 @@ private:
 		uiSettings.lineEditExternalEditorOptions->setText(settings->value(SETTINGS_EXTERNAL_EDITOR_COMMAND_LINE_OPTIONS, "").toString());
 		uiSettings.lineEditTargetSVDFileName->setText(targetSVDFileName);
 		uiSettings.checkBoxEnableNativeDebugging->setChecked(settings->value(SETTINGS_CHECKBOX_ENABLE_NATIVE_DEBUGGING_STATE, false).toBool());
+		uiSettings.checkBoxEnableIncrementalFlashing->setChecked(settings->value(SETTINGS_CHECKBOX_ENABLE_INCREMENTAL_FLASHING_STATE, true).toBool());
 		uiSettings.checkBoxHideLessUsedUiItems->setChecked(settings->value(SETTINGS_CHECKBOX_HIDE_LESS_USED_UI_ITEMS, false).toBool());
 	}
 
@@ -790,18 +1586,21 @@ private slots:
 	void gdbProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
 	void sendDataToGdbProcess(const QString &data, bool isFrontendIssuedCommand = true);
 
-	void readGdbVarObjectChildren(const QString varObjectName);
+	void readGdbVarObjectChildren(const QString varObjectName, int from, int to);
 	/* Returns true, if the source code file was successfully displayed, false otherwise. */
 	bool showSourceCode(const QTreeWidgetItem * item);
+	bool showSourceCode(const QModelIndex & index);
 	void breakpointsContextMenuRequested(QPoint p);
 	void svdContextMenuRequested(QPoint p);
 	void bookmarksContextMenuRequested(QPoint p);
 	void varObjectContextMenuRequested(QPoint p);
 	void breakpointViewItemChanged(QTreeWidgetItem * item, int column);
-	void stringSearchReady(const QString pattern, QSharedPointer<QVector<StringFinder::SearchResult>> results, bool resultsTruncated);
-	void createSvdRegisterView(QTreeWidgetItem *item, int column);
+	void stringSearchResultsAvailable(unsigned generation, QSharedPointer<QVector<StringFinder::SearchResult>> results);
+	void stringSearchCompleted(unsigned generation, const QString pattern, bool resultsTruncated);
+	void createSvdRegisterView(const QModelIndex & index);
 
 	void updateSourceListView(void);
+	void editSourcePathRemapRules(void);
 	void updateSymbolViews(void);
 	void updateBreakpointsView(void);
 	void updateBookmarksView(void);
@@ -840,7 +1639,7 @@ private:
 		void dump(void) const {
 			qDebug() << "navigation stack dump, index" << index << "size" << locations.size();
 			for (const auto & l : locations)
-				qDebug() << l.fullFileName << l.lineNumber;
+				qDebug() << l.fullFileName() << l.lineNumber;
 			qDebug() << "------------- navigation stack dump end";
 		}
 		void push(const struct SourceCodeLocation & location)
@@ -864,7 +1663,7 @@ private:
 				GDB_RESPONSE_INVALID = 0,
 				/* Response to the "-var-create - @ \"<expression>\"" machine interface gdb command. */
 				GDB_RESPONSE_NAME,
-				/* Response to the "-var-list-children --all-values <varobject>" machine interface gdb command. */
+				/* Response to the "-var-list-children --all-values <varobject> <from> <to>" machine interface gdb command. */
 				GDB_RESPONSE_NUMCHILD,
 				/* Response to the "-file-list-exec-source-files" machine interface gdb command. */
 				GDB_RESPONSE_FILES,
@@ -872,6 +1671,9 @@ private:
 				GDB_RESPONSE_LINES,
 				/* Annotated response to the "-file-exec-and-symbols <filename>" machine interface gdb command. */
 				GDB_RESPONSE_EXECUTABLE_SYMBOL_FILE_LOADED,
+				/* Annotated response to the "-file-exec-and-symbols <filename>" machine interface gdb command, sent
+				 * when the executable file has been rebuilt since it was loaded, before programming it into the target. */
+				GDB_RESPONSE_EXECUTABLE_RELOADED_FOR_PROGRAMMING,
 				/* Annotated response to the "-symbol-info-functions" machine interface gdb command. */
 				GDB_RESPONSE_FUNCTION_SYMBOLS,
 				/* Annotated response to the "-symbol-info-variables" machine interface gdb command. */
@@ -884,9 +1686,37 @@ private:
 				GDB_RESPONSE_TARGET_SCAN_COMPLETE,
 				/* Response to the '-data-read-memory-bytes' command, used to know when to update the memory dump view. */
 				GDB_RESPONSE_DATA_READ_MEMORY,
+				/* Response to the '-data-evaluate-expression' command, used to evaluate the start address of the memory
+				 * dump view, when it is not a number. The length of the memory dump is stored in the context string. */
+				GDB_RESPONSE_MEMORY_DUMP_ADDRESS,
+				/* Response to the '-data-read-memory-bytes' command, used to update the svd register views.
+				 * The address and the length of the range read, separated by a space, are stored in the context string. */
+				GDB_RESPONSE_SVD_REGISTER_READ,
+				/* Response to the '-data-read-memory-bytes' command, used for taking peripheral snapshots.
+				 * The address and the length of the range read, separated by a space, are stored in the context string. */
+				GDB_RESPONSE_SVD_SNAPSHOT_READ,
 				/* Response to the '-data-evaluate-expression' command, used to know when to update the value of the
 				 * last known program counter. */
 				GDB_RESPONSE_UPDATE_LAST_KNOWN_PROGRAM_COUNTER,
+				/* Response to the '-var-evaluate-expression' command, used to retrieve the full value of a varobject. */
+				GDB_RESPONSE_VAR_OBJECT_FULL_VALUE,
+				/* Response to the '-data-evaluate-expression' command, used to retrieve the full value of a stack variable. */
+				GDB_RESPONSE_STACK_VARIABLE_FULL_VALUE,
+				/* Responses to the '-data-evaluate-expression' command, used to retrieve the address and size
+				 * of a live watch expression. The live watch id is stored in the context string. */
+				GDB_RESPONSE_LIVE_WATCH_ADDRESS,
+				GDB_RESPONSE_LIVE_WATCH_SIZE,
+				/* Response to the '-data-read-memory-bytes' command, used for sampling live watches when the target
+				 * is halted. The read request number of the live watch engine is stored in the context string. */
+				GDB_RESPONSE_LIVE_WATCH_READ,
+				/* Response to the 'maint packet qCRC:...' console command, used to retrieve the target side checksum
+				 * of a block of target memory, when verifying the target memory contents. The index of the
+				 * verified block is stored in the context string. */
+				GDB_RESPONSE_VERIFY_BLOCK_CRC,
+				/* Response to the '-data-read-memory-bytes' command, used to read back a block of target memory
+				 * whose checksum does not match the ELF file. The index of the verified block is stored in the
+				 * context string. */
+				GDB_RESPONSE_VERIFY_BLOCK_READ,
 
 				/*******************************************************
 				 * The codes below are not really responses from gdb.
@@ -916,10 +1746,6 @@ private:
 				 * (of only those source files that actually contain any
 				 * machine code) can be built. */
 				GDB_SEQUENCE_POINT_SOURCE_CODE_ADDRESSES_RETRIEVED,
-				/* This response code is expected after the target non-volatile memory
-				 * contents have been retrieved, and a verification of the target memory
-				 * contents against the ELF file should be performed. */
-				GDB_SEQUENCE_POINT_CHECK_MEMORY_CONTENTS,
 			};
 			enum GDB_RESPONSE_ENUM gdbResponseCode = GDB_RESPONSE_INVALID;
 			QString		s;
@@ -989,6 +1815,9 @@ private:
 		uint8_t gdbTokenPool[GDB_TOKEN_POOL_SIZE_BYTES] = { 1, };
 	}
 	gdbTokenContext;
+	/* Retrieves the full value of an expression, ignoring the value size limit. The value is
+	 * only retrieved if the value passed has been truncated by gdb. */
+	void fetchFullValue(const QString & currentValue, const QString & gdbCommand, enum GdbTokenContext::GdbResponseContext::GDB_RESPONSE_ENUM responseCode, const QString & name);
 
 	enum
 	{
@@ -1024,10 +1853,17 @@ private:
 	{
 		/* Last searched text in the current source code document. */
 		QString lastSearchedText;
-		/* The matching positions for the text that has been last serched in the
-		 * currently displayed source code document. This is used for highlighting matching text
-		 * in the current document, and for navigating between matches. */
-		std::vector<int /* Absolute position in document. */> matchPositions;
+		/* The text lines of the currently displayed source code document, and the number of
+		 * characters (line number and machine code marker) prepended to each line in the source
+		 * code view. Matches inside the prepended characters are ignored. */
+		QStringList sourceCodeTextlines;
+		int lineNumberPrefixLength = 0;
+		/* Highlighting is only applied to the matches in the visible part of the source code view,
+		 * and it is updated when the view is scrolled. The total number of matches is computed
+		 * in a background pass over the source code text lines. The generation number is used to
+		 * discard stale match counts, when a new search is started before a previous count completes. */
+		unsigned generation = 0;
+		QFutureWatcher<QPair<unsigned /* generation */, int /* match count */>> matchCountWatcher;
 	}
 	searchData;
 
@@ -1044,8 +1880,9 @@ private:
 	target_state = GDB_NOT_RUNNING;
 	bool isBlackmagicProbeConnected = false;
 
-	/* This structure captures target output data, e.g., the target responses
-	 * for 'monitor swdp_scan' and 'monitor jtag_scan' commands. */
+	/* These structures capture target output data, e.g., the target responses
+	 * for 'monitor swdp_scan' and 'monitor jtag_scan' commands, and console output
+	 * data, e.g., the gdb server replies for 'maint packet' commands. */
 	struct
 	{
 	private:
@@ -1057,7 +1894,7 @@ private:
 		void stopCapture(void) { isCapturing = false; }
 		void captureLine(const QString & dataLine) { if (isCapturing) capturedDataLines << dataLine; }
 	}
-	targetDataCapture;
+	targetDataCapture, consoleDataCapture;
 
 	struct
 	{
@@ -1166,18 +2003,30 @@ private:
 	targetStateDependentWidgets;
 
 	std::shared_ptr<ELFIO::elfio> elfReader;
-	/* This list contains the set of temporary file names used when verifying target memory area
-	 * contents.
-	 *
-	 * The file names are constructed, one for each program segment in the ELF file that is being
-	 * used for debugging. These file names are used in requests to gdb, to read the target memory
-	 * areas corresponding to the program segments. When the target memory areas are read, the files
-	 * are checked against the contents of the program segments from the ELF file. */
-	QStringList targetMemorySectionsTempFileNames;
+	/* The modification time of the executable file, when it was last loaded in gdb. */
+	QDateTime executableFileLastModified;
+	TargetMemoryVerifier targetMemoryVerifier;
+	/* When the blackmagic probe is used, only the changed target flash sectors are programmed when loading the
+	 * program into the target. The probe is accessed directly for this, bypassing gdb, which can only program
+	 * whole executables. If incremental flashing fails, the whole executable is loaded by gdb. */
+	IncrementalFlasher incrementalFlasher;
+	enum
+	{
+		/* The timeout for a single incremental flashing request packet, erasing large flash sectors can be slow. */
+		INCREMENTAL_FLASHING_PACKET_TIMEOUT_MS	= 10000,
+	};
+	void loadProgramIntoTarget(void);
+	void programTarget(void);
+	void continueIncrementalFlashing(const QVector<QByteArray> & replies);
 
 	QFileSystemWatcher sourceFileWatcher;
 	QString displayedSourceCodeFile;
-	SourceFilesCache	sourceFilesCache;
+	FileId displayedSourceCodeFileId = 0;
+	/* Maps the source file names reported by gdb to filesystem file names, and caches the existence of source files. */
+	PathResolver		pathResolver;
+	/* The contents of the source code files, shared by the source code view and the string search engine. */
+	SourceCorpus		sourceCorpus { pathResolver };
+	SourceFilesCache	sourceFilesCache { sourceCorpus };
 
 	void highlightBreakpointedLines(void);
 	void highlightBookmarks(void);
@@ -1186,12 +2035,13 @@ private:
 	bool displaySourceCodeFile(const SourceCodeLocation & sourceCodeLocation, bool saveCurrentLocationToNavigationStack = true, bool saveNewLocationToNavigationStack = false);
 	void parseGdbCreateVarObjectResponse(const QString & variableExpression, const QString response, struct GdbVarObjectTreeItem & node);
 	void navigateToSymbolAtCursor(void);
-	QString escapeString(const QString & s) { QString t = s; return t.replace('\\', "\\\\").replace('\"', "\\\""); }
-	void sourceItemContextMenuRequested(const QTreeWidget * treeWidget, QPoint p);
+	void sourceItemContextMenuRequested(const QAbstractItemView * view, QPoint p);
 
 	void searchCurrentSourceText(const QString &pattern);
-	void moveCursorToNextMatch(void);
-	void moveCursorToPreviousMatch(void);
+	void highlightVisibleSearchMatches(void);
+	void moveCursorToMatch(bool searchBackward);
+	void moveCursorToNextMatch(void) { moveCursorToMatch(false); }
+	void moveCursorToPreviousMatch(void) { moveCursorToMatch(true); }
 
 	void scanForTargets(void);
 
@@ -1223,7 +2073,7 @@ private:
 	 * manually issuing the '-symbol-list-lines' requests. A bug report has been
 	 * submitted here:
 	 * https://sourceware.org/bugzilla/show_bug.cgi?id=26735 */
-	std::shared_ptr<QHash<QString /* gdb reported full file name */, SourceFileData>> sourceFiles = std::make_shared<QHash<QString /* gdb reported full file name */, SourceFileData>>();
+	std::shared_ptr<QHash<FileId /* of the gdb reported full file name */, SourceFileData>> sourceFiles = std::make_shared<QHash<FileId, SourceFileData>>();
 
 	QList<struct SourceCodeLocation> bookmarks;
 
@@ -1234,15 +2084,27 @@ private:
 	struct SvdRegisterViewData
 	{
 		uint32_t address;
+		/* The index of the register in the SVD image. */
+		uint32_t registerIndex;
+		/* The size of the register, in bytes. */
+		int size;
 		QDialog * dialog;
 		QGroupBox * fieldsGroupBox;
-		SvdRegisterViewData(QDialog * dialog = 0, uint32_t address = -1) : address(address), dialog(dialog) {}
+		SvdRegisterViewData(QDialog * dialog = 0, uint32_t address = -1, uint32_t registerIndex = SvdImage::NO_INDEX, int size = 4) :
+			address(address), registerIndex(registerIndex), size(size), dialog(dialog) {}
 		struct RegField { int bitoffset, bitwidth; QSpinBox * spinbox;
 				RegField(int bitoffset, int bitwidth, QSpinBox * spinbox) :
 					bitoffset(bitoffset), bitwidth(bitwidth), spinbox(spinbox) {}};
 		QList<RegField> fields;
 	};
 	QVector<SvdRegisterViewData> svdViews;
+	/* The peripheral snapshot being taken, if any, and the number of its target memory reads not yet completed. */
+	std::shared_ptr<SvdSnapshot> pendingSvdSnapshot;
+	int pendingSvdSnapshotReads = 0;
+	void takeSvdPeripheralSnapshot(uint32_t peripheralIndex);
+	void completeSvdSnapshotRead(uint32_t address, uint32_t length, const QByteArray & data);
+	/* Displays a dialog for selecting two of the saved peripheral snapshots, and displaying the differences between them. */
+	void compareSvdSnapshots(void);
 
 private:
 	struct
@@ -1270,6 +2132,17 @@ private slots:
 	void compareTargetMemory();
 
 private:
+	/* The data objects view is scanned for visible items shortly after it has been scrolled, expanded or changed,
+	 * so that pages of varobject children are fetched as they are scrolled into view. */
+	QTimer varObjectViewScanTimer;
+	/* Pages of varobject children that have not been visible for some time are periodically deleted, to reduce
+	 * the memory used by gdb, and the cost of updating all varobjects when the target halts. */
+	QTimer varObjectPageEvictionTimer;
+	const int VAR_OBJECT_PAGE_EVICTION_CHECK_INTERVAL_MS = 5000;
+	const int VAR_OBJECT_PAGE_EVICTION_TIME_MS = 30000;
+	void scanVisibleVarObjects(void);
+	void evictVarObjectPages(void);
+
 	QTimer controlKeyPressTimer;
 	const int controlKeyPressLockTimeMs = 400;
 	QTime controlKeyPressTime;
@@ -1277,14 +2150,8 @@ private:
 	void flashHighlightDockWidget(QDockWidget * w);
 	QList<QAction *> highlightWidgetActions;
 
-	/* Enumeration constants used as a 'role' parameter in the treeview widget used for displaying
-	 * svd device information. */
-	enum
-	{
-		SVD_REGISTER_POINTER = Qt::UserRole,
-		SVD_REGISTER_ADDRESS,
-	};
-	SvdFileParser svdParser;
+	SvdImage svdImage;
+	SvdTreeModel svdTreeModel { svdImage };
 	BlackMagicProbeServer blackMagicProbeServer;
 	Ui::MainWindow *ui;
 	std::shared_ptr<QProcess> gdbProcess;
@@ -1299,6 +2166,12 @@ private:
 	QThread gdbMiReceiverThread;
 	QThread fileSearchThread;
 	StringFinder * stringFinder;
+	/* The generation number of the most recently started string search. Search results from
+	 * other generations are stale, and are discarded. */
+	unsigned stringSearchGeneration = 0;
+	void searchSourceFilesForText(const QString & text);
+	/* Lists the occurrences of an identifier in code, skipping comments and strings, in the search results view. */
+	void findReferencesToIdentifier(const QString & identifier);
 	GdbMiReceiver			* gdbMiReceiver;
 	/* This vector contains the mapping between gdb register number, and register indices in the register view widget. */
 	QVector<int> targetRegisterIndices;
@@ -1323,11 +2196,19 @@ private:
 	void appendLineToGdbLog(const QString & data);
 
 	GdbVarObjectTreeItemModel varObjectTreeItemModel;
+	/* The index of all known symbols, which backs the symbol views, and the object locator.
+	 * Rebuilt when the symbol views are updated. */
+	SymbolIndex symbolIndex;
+	SymbolListModel subprogramsModel { symbolIndex, SourceFileData::SymbolData::SUBPROGRAM };
+	SymbolListModel staticDataObjectsModel { symbolIndex, SourceFileData::SymbolData::DATA_OBJECT };
+	SymbolListModel dataTypesModel { symbolIndex, SourceFileData::SymbolData::DATA_TYPE };
+	SourceFilesModel sourceFilesModel { symbolIndex };
+	ObjectLocatorModel objectLocatorModel { symbolIndex };
 
 	/* Functions for handling different response packets from gdb. */
 	/* Handle the response to the "-var-create - @ \"<expression>\"" machine interface gdb command. */
 	bool handleNameResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
-	/* Handle the response to the "-var-list-children --all-values <varobject>" machine interface gdb command. */
+	/* Handle the response to the "-var-list-children --all-values <varobject> <from> <to>" machine interface gdb command. */
 	bool handleNumchildResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
 	/* Handle the response to the "-file-list-exec-source-files" machine interface gdb command. */
 	bool handleFilesResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
@@ -1360,11 +2241,26 @@ private:
 	/*! \todo	Handle sequence points in separate functions. Rework and rename this function. */
 	bool handleSequencePoints(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
 	/* Handle sequence point response for vrtifying target memory area contents. */
-	bool handleVerifyTargetMemoryContentsSeqPoint(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
+	bool handleVerifyTargetMemoryResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
+	void reportTargetMemoryVerification(void);
 	/* Handle target scan ('monitor swdp_scan' and 'monitor jtag_scan') response. */
 	bool handleTargetScanResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
 	/* Handle the response to the "-data-read-memory-bytes" machine interface gdb command. */
 	bool handleMemoryResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
+	/* All target memory reads by the frontend are done through these functions, so that they can be served from the target memory cache. */
+	void readTargetMemory(uint32_t address, uint32_t length, const GdbTokenContext::GdbResponseContext & context);
+	void completeTargetMemoryRead(const GdbTokenContext::GdbResponseContext & context, const QByteArray & data);
+	/* Reads the registers displayed in SVD register views from the target. If 'dialog' is null, all open register views
+	 * are refreshed, otherwise only the register view for the dialog passed is refreshed. The registers of all views
+	 * that lie in the same address block of the same peripheral are read with a single memory read, unless there are
+	 * registers with read side effects between them. */
+	void refreshSvdRegisterViews(QDialog * dialog = 0);
+	/* Updates the SVD register views, for registers in a target memory range read from the target. */
+	void updateSvdRegisterViews(uint32_t address, const QByteArray & data);
+	/* Extracts the start address and the contents from a "-data-read-memory-bytes" response. */
+	static bool parseMemoryResponse(const std::vector<GdbMiParser::MIResult> & results, uint32_t & address, QByteArray & data);
+	/* Handle the responses to live watch expression evaluation and memory read commands. */
+	bool handleLiveWatchResponse(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
 
 	/* Generic error handler. */
 	void handleGdbError(enum GdbMiParser::RESULT_CLASS_ENUM parseResult, const std::vector<GdbMiParser::MIResult> & results, unsigned tokenNumber);
@@ -1375,7 +2271,8 @@ protected:
 	bool eventFilter(QObject *watched, QEvent *event) override;
 signals:
 	void readyReadGdbProcess(const QByteArray data);
-	void findString(const QString & str, unsigned flags);
+	void findString(const QString & str, unsigned flags, unsigned generation);
+	void findIdentifierReferences(const QString & identifier, unsigned generation);
 	void targetCallStackFrameChanged(void);
 	void addFilesToSearchSet(const QStringList sourceCodeFiles);
 
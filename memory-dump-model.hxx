@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+#include <algorithm>
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QBrush>
+#include <QColor>
+#include <QByteArray>
+
+/* An item model for a hex dump of a target memory range, displayed in rows of 16 bytes.
+ *
+ * Target memory is read in aligned pages, and only the pages that are actually displayed by a view are read,
+ * when the view first asks for their data. Pages are kept until the target is resumed. The contents of the
+ * pages at the time the target is resumed are kept, so that bytes which have changed since then are
+ * highlighted when the pages are read again, after the target halts. */
+class MemoryDumpModel : public QAbstractTableModel
+{
+	Q_OBJECT
+public:
+	enum
+	{
+		BYTES_PER_ROW	= 16,
+		PAGE_SIZE	= 256,
+		ASCII_COLUMN	= BYTES_PER_ROW,
+	};
+private:
+	struct Page
+	{
+		/* Pages at the start and at the end of the dumped range may be partial, only the bytes in the dumped
+		 * range are read, so that reading a page does not fail because of inaccessible memory outside
+		 * of the dumped range. */
+		uint32_t	address = 0;
+		QByteArray	data;
+		Page(uint32_t address = 0, const QByteArray & data = QByteArray()) : address(address), data(data) {}
+		bool contains(uint32_t a) const { return a >= address && a - address < (uint32_t) data.size(); }
+		uint8_t at(uint32_t a) const { return data.at(a - address); }
+	};
+	uint32_t startAddress = 0;
+	/* The dumped range is [startAddress, endAddress). */
+	uint64_t endAddress = 0;
+	bool isFetchingEnabled = false;
+	/* Pages read since the target was last resumed. */
+	QHash<uint32_t /* page address */, struct Page> pages;
+	/* The last known page contents, before the target was last resumed. */
+	QHash<uint32_t /* page address */, struct Page> previousPages;
+	/* Pages that have been requested, but have not yet been received. */
+	mutable QSet<uint32_t /* page address */> pendingPages;
+	/* Pages that could not be read. */
+	QSet<uint32_t /* page address */> failedPages;
+
+	static uint32_t pageAddress(uint32_t address) { return address & ~(PAGE_SIZE - 1); }
+	uint32_t firstRowAddress(void) const { return startAddress & ~(BYTES_PER_ROW - 1); }
+	/* Returns the address of the byte displayed in a cell, or false if the cell is outside of the dumped range. */
+	bool cellAddress(const QModelIndex & index, uint32_t & address) const
+	{
+		uint64_t a = (uint64_t) firstRowAddress() + (uint64_t) index.row() * BYTES_PER_ROW + index.column();
+		if (index.column() >= BYTES_PER_ROW || a < startAddress || a >= endAddress)
+			return false;
+		address = a;
+		return true;
+	}
+	/* Returns the page containing an address, requesting it from the target if it is not yet available. */
+	const struct Page * page(uint32_t address) const
+	{
+		uint32_t p = pageAddress(address);
+		auto i = pages.constFind(p);
+		if (i != pages.cend())
+			return & i.value();
+		if (isFetchingEnabled && !pendingPages.contains(p) && !failedPages.contains(p))
+		{
+			uint32_t first = std::max(p, startAddress);
+			uint64_t last = std::min((uint64_t) p + PAGE_SIZE, endAddress);
+			pendingPages.insert(p);
+			emit const_cast<MemoryDumpModel *>(this)->readMemory(first, last - first);
+		}
+		return 0;
+	}
+	void emitAllDataChanged(void)
+	{
+		if (rowCount())
+			emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+	}
+public:
+	MemoryDumpModel(QObject * parent = 0) : QAbstractTableModel(parent) {}
+	void setRange(uint32_t startAddress, uint32_t length)
+	{
+		beginResetModel();
+		this->startAddress = startAddress;
+		endAddress = (uint64_t) startAddress + length;
+		pages.clear();
+		previousPages.clear();
+		pendingPages.clear();
+		failedPages.clear();
+		endResetModel();
+	}
+	/* When fetching is disabled, pages not yet read are not requested from the target. */
+	void setFetchingEnabled(bool isEnabled)
+	{
+		if ((isFetchingEnabled = isEnabled))
+			/* Make the views request the data for the displayed pages. */
+			emitAllDataChanged();
+	}
+	/* Completes a read requested by signal 'readMemory()'. An empty data array means that the read has failed. */
+	void readCompleted(uint32_t address, const QByteArray & data)
+	{
+		uint32_t p = pageAddress(address);
+		if (!pendingPages.remove(p))
+			return;
+		if (data.isEmpty())
+			failedPages.insert(p);
+		else
+			pages.insert(p, Page(address, data));
+		uint64_t firstRow = ((uint64_t) std::max(p, firstRowAddress()) - firstRowAddress()) / BYTES_PER_ROW;
+		uint64_t lastRow = std::min(((uint64_t) p + PAGE_SIZE - 1 - firstRowAddress()) / BYTES_PER_ROW, (uint64_t) rowCount() - 1);
+		if (firstRow <= lastRow)
+			emit dataChanged(index(firstRow, 0), index(lastRow, columnCount() - 1));
+	}
+	/* Drops all pages read, as the target memory contents may change once the target is resumed. */
+	void targetResumed(void) { invalidate(); }
+	/* Drops all pages read, the pages displayed are read again, and any changed bytes are highlighted. */
+	void invalidate(void)
+	{
+		for (auto p = pages.cbegin(); p != pages.cend(); p ++)
+			previousPages.insert(p.key(), p.value());
+		pages.clear();
+		pendingPages.clear();
+		failedPages.clear();
+		emitAllDataChanged();
+	}
+
+	int rowCount(const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (parent.isValid() || endAddress <= startAddress)
+			return 0;
+		return std::min((endAddress - firstRowAddress() + BYTES_PER_ROW - 1) / BYTES_PER_ROW, (uint64_t) INT_MAX);
+	}
+	int columnCount(const QModelIndex & = QModelIndex()) const override { return BYTES_PER_ROW + 1; }
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+	{
+		if (role != Qt::DisplayRole)
+			return QVariant();
+		if (orientation == Qt::Vertical)
+			return QString("%1").arg(firstRowAddress() + (uint32_t) section * BYTES_PER_ROW, 8, 16, QChar('0'));
+		return section == ASCII_COLUMN ? QString("ascii") : QString("%1").arg(section, 0, 16);
+	}
+	QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override
+	{
+		if (!index.isValid())
+			return QVariant();
+		uint32_t address;
+		if (index.column() == ASCII_COLUMN && role == Qt::DisplayRole)
+		{
+			QString s;
+			for (int i = 0; i < BYTES_PER_ROW; i ++)
+			{
+				const struct Page * p;
+				if (!cellAddress(this->index(index.row(), i), address))
+					s += ' ';
+				else if (!(p = page(address)) || !p->contains(address))
+					s += '.';
+				else
+					s += isprint(p->at(address)) ? QChar(p->at(address)) : QChar('.');
+			}
+			return s;
+		}
+		if (!cellAddress(index, address))
+			return QVariant();
+		const struct Page * p = page(address);
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			if (p && p->contains(address))
+				return QString("%1").arg(p->at(address), 2, 16, QChar('0'));
+			return failedPages.contains(pageAddress(address)) ? "--" : "??";
+		case Qt::BackgroundRole:
+		{
+			auto previous = previousPages.constFind(pageAddress(address));
+			if (p && p->contains(address) && previous != previousPages.cend() && previous.value().contains(address)
+					&& previous.value().at(address) != p->at(address))
+				return QBrush(Qt::yellow);
+			return QVariant();
+		}
+		case Qt::TextAlignmentRole:
+			return Qt::AlignCenter;
+		default:
+			return QVariant();
+		}
+	}
+signals:
+	void readMemory(uint32_t address, uint32_t length);
+};
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <QFileInfo>
+#include <QDir>
+#include <QtConcurrent>
+
+#include "path-resolver.hxx"
+#include "utils.hxx"
+
+PathResolver::PathResolver(QObject * parent) : QObject(parent)
+{
+	connect(& statWatcher, & QFutureWatcher<StatResults>::finished, this, & PathResolver::statFilesCompleted);
+}
+
+void PathResolver::setRemapRules(const QList<RemapRule> & rules)
+{
+	QMutexLocker locker(& mutex);
+	this->rules.clear();
+	for (const auto & r : rules)
+		if (r.isValid())
+			this->rules << RemapRule(QDir::fromNativeSeparators(r.fromPrefix), QDir::fromNativeSeparators(r.toPrefix));
+	rulesGeneration ++;
+	resolvedFileNames.clear();
+	existenceCache.clear();
+	pendingStatRequests.clear();
+}
+
+QString PathResolver::applyRemapRules(const QString & fileName) const
+{
+	QString t = QDir::fromNativeSeparators(fileName);
+	for (const auto & r : rules)
+	{
+		QString from = r.fromPrefix;
+		while (from.length() > 1 && from.endsWith('/'))
+			from.chop(1);
+		if (!t.startsWith(from) || (t.length() > from.length() && t.at(from.length()) != '/' && !from.endsWith('/')))
+			continue;
+		QString rest = t.mid(from.length());
+		QString to = r.toPrefix;
+		if (to.endsWith('/') && rest.startsWith('/'))
+			to.chop(1);
+		return to + rest;
+	}
+	return fileName;
+}
+
+QString PathResolver::resolvedFileName(FileId fileId)
+{
+	QMutexLocker locker(& mutex);
+	auto i = resolvedFileNames.constFind(fileId);
+	if (i != resolvedFileNames.cend())
+		return i.value();
+	QString resolvedFileName = applyRemapRules(PathTable::global().path(fileId));
+	resolvedFileNames.insert(fileId, resolvedFileName);
+	return resolvedFileName;
+}
+
+PathResolver::ExistenceData PathResolver::statFile(const QString & resolvedFileName)
+{
+	struct ExistenceData result;
+	QFileInfo fi(resolvedFileName);
+	if (!fi.exists())
+		/* Attempt to adjust the filename path on windows systems. */
+		fi.setFile(Utils::filenameToWindowsFilename(resolvedFileName));
+	if (fi.exists())
+		result.existence = EXISTS, result.filesystemFileName = fi.absoluteFilePath();
+	else
+		result.existence = DOES_NOT_EXIST;
+	return result;
+}
+
+PathResolver::StatResults PathResolver::statFiles(const QStringList & resolvedFileNames)
+{
+	StatResults results;
+	for (const auto & f : resolvedFileNames)
+		results.push_back(std::make_pair(f, statFile(f)));
+	return results;
+}
+
+QString PathResolver::filesystemFileName(FileId fileId)
+{
+	QString fileName = resolvedFileName(fileId);
+	{
+		QMutexLocker locker(& mutex);
+		auto i = existenceCache.constFind(fileName);
+		if (i != existenceCache.cend())
+			return i.value().filesystemFileName;
+	}
+	struct ExistenceData e = statFile(fileName);
+	QMutexLocker locker(& mutex);
+	existenceCache.insert(fileName, e);
+	return e.filesystemFileName;
+}
+
+enum PathResolver::EXISTENCE PathResolver::existence(FileId fileId)
+{
+	QString fileName = resolvedFileName(fileId);
+	QMutexLocker locker(& mutex);
+	auto i = existenceCache.constFind(fileName);
+	return i != existenceCache.cend() ? i.value().existence : EXISTENCE_UNKNOWN;
+}
+
+void PathResolver::updateExistence(FileId fileId, const QString & filesystemFileName)
+{
+	QString fileName = resolvedFileName(fileId);
+	struct ExistenceData e;
+	e.existence = filesystemFileName.isEmpty() ? DOES_NOT_EXIST : EXISTS;
+	e.filesystemFileName = filesystemFileName;
+	QMutexLocker locker(& mutex);
+	existenceCache.insert(fileName, e);
+}
+
+void PathResolver::invalidate(const QString & fileName)
+{
+	QMutexLocker locker(& mutex);
+	for (auto i = existenceCache.begin(); i != existenceCache.end();)
+		if (i.key() == fileName || i.value().filesystemFileName == fileName)
+			i = existenceCache.erase(i);
+		else
+			i ++;
+}
+
+void PathResolver::invalidateAll()
+{
+	QMutexLocker locker(& mutex);
+	existenceCache.clear();
+}
+
+void PathResolver::checkExistence(const std::vector<FileId> & fileIds)
+{
+	for (const auto & fileId : fileIds)
+	{
+		QString fileName = resolvedFileName(fileId);
+		QMutexLocker locker(& mutex);
+		if (!existenceCache.contains(fileName))
+			pendingStatRequests.insert(fileName);
+	}
+	startPendingStatRequests();
+}
+
+void PathResolver::startPendingStatRequests()
+{
+	if (statWatcher.isRunning())
+		return;
+	QStringList fileNames;
+	{
+		QMutexLocker locker(& mutex);
+		if (pendingStatRequests.isEmpty())
+			return;
+		fileNames = pendingStatRequests.values();
+		pendingStatRequests.clear();
+		statGeneration = rulesGeneration;
+	}
+	statWatcher.setFuture(QtConcurrent::run(PathResolver::statFiles, fileNames));
+}
+
+void PathResolver::statFilesCompleted()
+{
+	bool isUpdated = false;
+	{
+		QMutexLocker locker(& mutex);
+		/* Discard the results, if the remapping rules changed while the files were being checked. */
+		if (statGeneration == rulesGeneration)
+			for (const auto & r : statWatcher.result())
+				if (!existenceCache.contains(r.first))
+					existenceCache.insert(r.first, r.second), isUpdated = true;
+	}
+	startPendingStatRequests();
+	if (isUpdated)
+		emit existenceUpdated();
+}
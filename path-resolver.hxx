@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QFutureWatcher>
+
+#include "file-id.hxx"
+
+/* Maps the source file names reported by gdb to the names by which the files can be accessed in the local
+ * filesystem, and keeps track of which files exist.
+ *
+ * Executables are often built on other machines (e.g., on build servers), and the source file names
+ * recorded in the debug information do not match the local source code tree. Source path remapping rules
+ * replace a prefix of a file name with another prefix. The rules are ordered, and only the first rule that
+ * matches a file name is applied. A rule matches only at path component boundaries, so that a rule for
+ * '/build/src' does not match '/build/src2/main.c'.
+ *
+ * Checking if a file exists is done by accessing the filesystem, which can be slow, especially for large
+ * numbers of files, or for files on network filesystems. So, the results of existence checks are cached,
+ * and existence checks for batches of files can be run in a background thread.
+ *
+ * This class is thread safe, except for starting background existence checks, which must be done from the
+ * thread owning the path resolver object (normally, the main gui thread). */
+class PathResolver : public QObject
+{
+	Q_OBJECT
+public:
+	struct RemapRule
+	{
+		QString	fromPrefix;
+		QString	toPrefix;
+		RemapRule(const QString & fromPrefix = QString(), const QString & toPrefix = QString()) : fromPrefix(fromPrefix), toPrefix(toPrefix) {}
+		/* Rules are stored in sessions as strings, in the form "<from prefix>\n<to prefix>". */
+		QString toString(void) const { return fromPrefix + '\n' + toPrefix; }
+		static RemapRule fromString(const QString & s)
+		{ QStringList t = s.split('\n'); return t.size() == 2 ? RemapRule(t.at(0), t.at(1)) : RemapRule(); }
+		bool isValid(void) const { return !fromPrefix.isEmpty(); }
+	};
+	enum EXISTENCE
+	{
+		EXISTENCE_UNKNOWN = 0,
+		EXISTS,
+		DOES_NOT_EXIST,
+	};
+
+	PathResolver(QObject * parent = 0);
+	void setRemapRules(const QList<struct RemapRule> & rules);
+	QList<struct RemapRule> remapRules(void) const { QMutexLocker locker(& mutex); return rules; }
+
+	/* Returns the file name after applying the remapping rules. This does not access the filesystem. */
+	QString resolvedFileName(FileId fileId);
+	QString resolvedFileName(const QString & fileName) { return resolvedFileName(PathTable::global().fileId(fileName)); }
+	/* Returns the name by which a file can be accessed in the filesystem, or an empty string if the file does not exist.
+	 * If the existence of the file is not known, this checks the filesystem. */
+	QString filesystemFileName(FileId fileId);
+	/* Returns the cached existence of a file. This never accesses the filesystem. */
+	enum EXISTENCE existence(FileId fileId);
+	/* Schedules a background existence check for all files passed, whose existence is not known.
+	 * Signal 'existenceUpdated()' is emitted when the results are available. */
+	void checkExistence(const std::vector<FileId> & fileIds);
+	/* Records the result of an existence check for a file, performed by some other means (e.g., when reading the file). */
+	void updateExistence(FileId fileId, const QString & filesystemFileName);
+	/* Drops the cached existence of a file, given either its resolved name, or its filesystem name. */
+	void invalidate(const QString & fileName);
+	void invalidateAll(void);
+signals:
+	void existenceUpdated(void);
+private:
+	struct ExistenceData
+	{
+		enum EXISTENCE	existence = EXISTENCE_UNKNOWN;
+		QString		filesystemFileName;
+	};
+	typedef std::vector<std::pair<QString /* resolved file name */, struct ExistenceData>> StatResults;
+
+	mutable QMutex mutex;
+	QList<struct RemapRule> rules;
+	/* Incremented each time the remapping rules change, so that results of background checks
+	 * started before the change are discarded. */
+	unsigned rulesGeneration = 0;
+	QHash<FileId, QString /* resolved file name */> resolvedFileNames;
+	QHash<QString /* resolved file name */, struct ExistenceData> existenceCache;
+
+	/* At most one background existence check is run at a time. Requests made while a check is running are
+	 * collected, and are checked when the running check completes. */
+	QFutureWatcher<StatResults> statWatcher;
+	unsigned statGeneration = 0;
+	QSet<QString /* resolved file name */> pendingStatRequests;
+
+	QString applyRemapRules(const QString & fileName) const;
+	static struct ExistenceData statFile(const QString & resolvedFileName);
+	static StatResults statFiles(const QStringList & resolvedFileNames);
+	void startPendingStatRequests(void);
+	void statFilesCompleted(void);
+};
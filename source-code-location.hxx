@@ -24,14 +24,25 @@
 
 #include <QString>
 
+#include "file-id.hxx"
+
 struct SourceCodeLocation
 {
-	QString	fullFileName;
+private:
+	QString	locationFullFileName;
+	/* The file id of the full file name above, it is always updated along with the file name. */
+	FileId	locationFileId = 0;
+public:
 	int	lineNumber = -1;
 	SourceCodeLocation(const QString & fullFileName = QString(), int lineNumber = -1) :
-		fullFileName(fullFileName), lineNumber(lineNumber) {}
+		locationFullFileName(fullFileName), locationFileId(PathTable::global().fileId(fullFileName)), lineNumber(lineNumber) {}
+	const QString & fullFileName(void) const { return locationFullFileName; }
+	/* Locations are compared by their file ids. */
+	FileId fileId(void) const { return locationFileId; }
+	void setFullFileName(const QString & fullFileName)
+	{ locationFullFileName = fullFileName, locationFileId = PathTable::global().fileId(fullFileName); }
 	bool operator ==(const SourceCodeLocation & other) const
-	{ return other.lineNumber == lineNumber && other.fullFileName == fullFileName; }
+	{ return other.lineNumber == lineNumber && other.locationFileId == locationFileId; }
 	bool operator !=(const SourceCodeLocation & other) const
 	{ return ! operator ==(other); }
 };
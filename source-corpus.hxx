@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "utils.hxx"
+#include "file-id.hxx"
+#include "path-resolver.hxx"
+#include "clex.hxx"
+
+/* The contents of a source code file, as read from the filesystem, along with a table of the
+ * offsets of the starts of the lines in the file. Instances are immutable, and are shared between
+ * all users of the source corpus. The tokens of the file are only scanned on first use, but are
+ * then also shared, so that a file is scanned only once both for syntax highlighting and for
+ * indexing its identifiers. */
+struct SourceFileContents
+{
+	/* The name of the source file, by which it can be accessed in the filesystem. This may be
+	 * different from the filename initially supplied, e.g., in an MSYS2 environment. */
+	QString			filesystemFileName;
+	QDateTime		lastModifiedDateTime;
+	QByteArray		bytes;
+	/* The offsets of the starts of the lines in the file contents. There is always at least one line. */
+	std::vector<int>	lineOffsets;
+
+	int lineCount(void) const { return lineOffsets.size(); }
+	/* Returns the text of a line, without the terminating newline character. Line indices are zero-based. */
+	QByteArray line(int lineIndex) const
+	{
+		int start = lineOffsets.at(lineIndex);
+		int end = (lineIndex + 1 < (int) lineOffsets.size()) ? lineOffsets.at(lineIndex + 1) - 1 : bytes.size();
+		return bytes.mid(start, end - start);
+	}
+	QStringList textLines(void) const { return QString::fromUtf8(bytes).split('\n'); }
+	/* Returns the tokens of the file, as recognized by the 'clex' scanner. This is thread safe. */
+	const std::vector<clex::Token> & tokens(void) const
+	{
+		std::call_once(tokensScanned, [this] (void) -> void { scannedTokens = clex::scan_tokens(bytes.constData()); });
+		return scannedTokens;
+	}
+private:
+	mutable std::once_flag		tokensScanned;
+	mutable std::vector<clex::Token>	scannedTokens;
+};
+
+/* A store for the contents of source code files, which is shared by all parts of the frontend that
+ * need to read source code files - the source code view and its cache, and the string search engine.
+ * Each file is read from the filesystem only once, and is reread only when its modification time changes.
+ * Source file names are mapped to filesystem file names by the path resolver.
+ *
+ * This class is thread safe. Files are read without holding the store lock, so that multiple files
+ * can be read in parallel. */
+class SourceCorpus
+{
+private:
+	QMutex mutex;
+	QHash<FileId, std::shared_ptr<const SourceFileContents>> files;
+	PathResolver & pathResolver;
+public:
+	SourceCorpus(PathResolver & pathResolver) : pathResolver(pathResolver) {}
+	std::shared_ptr<const SourceFileContents> fileContents(const QString & sourceFileName, QString * errorMessage = 0)
+	{ return fileContents(PathTable::global().fileId(sourceFileName), errorMessage); }
+	/* Returns the contents of a source file, reading it from the filesystem if necessary.
+	 * Returns a null pointer, and sets the error message passed, if the file cannot be read. */
+	std::shared_ptr<const SourceFileContents> fileContents(FileId fileId, QString * errorMessage = 0)
+	{
+		QString sourceFileName = pathResolver.resolvedFileName(fileId);
+		QFileInfo fi(sourceFileName);
+		if (!fi.exists())
+			/* Attempt to adjust the filename path on windows systems. */
+			fi.setFile(Utils::filenameToWindowsFilename(sourceFileName));
+		/* The filesystem has been accessed anyway, so refresh the existence cache of the path resolver. */
+		pathResolver.updateExistence(fileId, fi.exists() ? fi.absoluteFilePath() : QString());
+		if (!fi.exists())
+		{
+			if (errorMessage)
+				* errorMessage = QString("Cannot find file \"%1\"").arg(sourceFileName);
+			QMutexLocker locker(& mutex);
+			files.remove(fileId);
+			return 0;
+		}
+		QDateTime lastModifiedDateTime = fi.lastModified();
+		{
+			QMutexLocker locker(& mutex);
+			auto f = files.find(fileId);
+			/* The file name may differ, if the source path remapping rules have changed. */
+			if (f != files.end() && f.value()->lastModifiedDateTime == lastModifiedDateTime && f.value()->filesystemFileName == fi.absoluteFilePath())
+				return f.value();
+		}
+
+		QFile f(fi.absoluteFilePath());
+		if (!f.open(QFile::ReadOnly))
+		{
+			if (errorMessage)
+				* errorMessage = QString("Failed to open file \"%1\"").arg(sourceFileName);
+			return 0;
+		}
+		std::shared_ptr<SourceFileContents> contents = std::make_shared<SourceFileContents>();
+		contents->filesystemFileName = f.fileName();
+		contents->lastModifiedDateTime = lastModifiedDateTime;
+		contents->bytes = f.readAll();
+		contents->lineOffsets.push_back(0);
+		for (int i = 0; (i = contents->bytes.indexOf('\n', i)) != -1; contents->lineOffsets.push_back(++ i))
+			;
+
+		QMutexLocker locker(& mutex);
+		files.insert(fileId, contents);
+		return contents;
+	}
+	/* Drops a file from the store. The file contents remain valid for users still referencing them. */
+	void removeFile(FileId fileId) { QMutexLocker locker(& mutex); files.remove(fileId); }
+};
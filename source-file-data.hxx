@@ -23,6 +23,8 @@
 #pragma once
 #include <unordered_set>
 
+#include "string-pool.hxx"
+
 struct SourceFileData {
 	/* Enumeration constants used as a 'role' parameter in treeview item widgets, contained in
 	 * the different treeview widgets (subprograms, data objects, breakpoints, bookmarks, etc.). */
@@ -74,17 +76,25 @@ struct SourceFileData {
 			SOURCE_FILE_NAME,
 		};
 		int line = -1;
-		QString	name, type, description;
+		/* The symbol strings are interned in the global string pool, many symbols share the same type strings. */
+		uint32_t nameId = 0, typeId = 0, descriptionId = 0;
+		QString name(void) const { return StringPool::global().string(nameId); }
+		QString type(void) const { return StringPool::global().string(typeId); }
+		QString description(void) const { return StringPool::global().string(descriptionId); }
 		bool operator ==(const SymbolData & other) const
 		{
-			return name == other.name && type == other.type && description == other.description && line == other.line;
+			return nameId == other.nameId && typeId == other.typeId && descriptionId == other.descriptionId && line == other.line;
 		}
 	};
 	struct SymbolHash
 	{
 		size_t operator ()(const SourceFileData::SymbolData & t) const
 		{
-			return std::hash<std::string>()(QString("%1:%2:%3:%4").arg(t.name).arg(t.type).arg(t.description).arg(t.line).toStdString());
+			uint64_t h = t.nameId;
+			h = h * 0x9e3779b97f4a7c15ULL + t.typeId;
+			h = h * 0x9e3779b97f4a7c15ULL + t.descriptionId;
+			h = h * 0x9e3779b97f4a7c15ULL + (uint32_t) t.line;
+			return h ^ (h >> 32);
 		}
 	};
 
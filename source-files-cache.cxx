@@ -22,47 +22,29 @@
 
 #include "source-files-cache.hxx"
 #include "utils.hxx"
-#include "cscanner.hxx"
+#include "clex.hxx"
 
-std::shared_ptr<const struct SourceFilesCache::SourceFileCacheData> SourceFilesCache::getSourceFileCacheData(const QString &sourceFileName, QString & errorMessage)
+std::shared_ptr<const struct SourceFilesCache::SourceFileCacheData> SourceFilesCache::getSourceFileCacheData(FileId fileId, QString & errorMessage)
 {
 	errorMessage.clear();
-	QFileInfo fi(sourceFileName);
-	QFile f(sourceFileName);
-	if (!fi.exists())
+	std::shared_ptr<const SourceFileContents> contents = sourceCorpus.fileContents(fileId, & errorMessage);
+	if (!contents)
 	{
-		/* Attempt to adjust the filename path on windows systems. */
-		fi.setFile(Utils::filenameToWindowsFilename(sourceFileName));
-		f.setFileName(fi.absoluteFilePath());
-	}
-	if (fi.exists())
-	{
-		auto sourceData = sourceFileCacheData.find(sourceFileName);
-		if (sourceData != sourceFileCacheData.end())
-			if (sourceData.operator *()->lastModifiedDateTime == fi.lastModified())
-				return sourceData.operator *();
-		/* File was found, but it was probably modified. Attempt to reload the file */
-		sourceFileCacheData.erase(sourceData);
-	}
-
-	if (!fi.exists())
-	{
-		errorMessage = QString("Cannot find file \"%1\"").arg(sourceFileName);
+		sourceFileCacheData.remove(fileId);
 		return 0;
 	}
-	else if (!f.open(QFile::ReadOnly))
+	auto cachedData = sourceFileCacheData.find(fileId);
+	if (cachedData != sourceFileCacheData.end())
 	{
-		errorMessage = QString("Failed to open file \"%1\"").arg(sourceFileName);
-		return 0;
+		if (cachedData.operator *()->lastModifiedDateTime == contents->lastModifiedDateTime
+				&& cachedData.operator *()->filesystemFileName == contents->filesystemFileName)
+			return cachedData.operator *();
+		/* File was found, but it was modified. Regenerate the cached data for the file. */
+		sourceFileCacheData.erase(cachedData);
 	}
 
-	yyscan_t scanner;
-	std::string s;
-	yylex_init_extra(& s, &scanner);
-
-	yy_scan_string((f.readAll() + '\0').constData(), scanner);
-	yylex(scanner);
-	yylex_destroy(scanner);
+	/* The tokens of the file are shared with the identifier index, and the file is scanned here only if it has not been indexed yet. */
+	std::string s = clex::format_html(contents->bytes.constData(), contents->tokens());
 
 	/* Prepend line numbers to the source code lines. */
 	QList<QString> lines = QString::fromStdString(s).split('\n');
@@ -81,15 +63,17 @@ std::shared_ptr<const struct SourceFilesCache::SourceFileCacheData> SourceFilesC
 			;
 
 	int lineNumber = 0;
-	if (!sourceFileData.get() || sourceFileData->find(sourceFileName) == sourceFileData->cend()
-		|| !sourceFileData->find(sourceFileName)->machineCodeLineNumbers.size())
+	int lineNumberPrefixLength = numFieldWidth + 2;
+	if (!sourceFileData.get() || sourceFileData->find(fileId) == sourceFileData->cend()
+		|| !sourceFileData->find(fileId)->machineCodeLineNumbers.size())
 		/* Do not add breakpoint markers. */
 		for (const auto & l : lines)
 			source += QString("%1 |%2\n").arg(++ lineNumber, numFieldWidth).arg(l);
 	else
 	{
+		lineNumberPrefixLength ++;
 		/* Add breakpoint markers. */
-		const auto t = sourceFileData->find(sourceFileName)->machineCodeLineNumbers;
+		const auto t = sourceFileData->find(fileId)->machineCodeLineNumbers;
 		for (const auto & l : lines)
 		{
 			lineNumber ++;
@@ -105,12 +89,13 @@ std::shared_ptr<const struct SourceFilesCache::SourceFileCacheData> SourceFilesC
 			;
 
 	std::shared_ptr<struct SourceFileCacheData> sourceData = std::make_shared<struct SourceFileCacheData>();
-	sourceData->filesystemFileName = f.fileName();
-	sourceData->lastModifiedDateTime = fi.lastModified();
+	sourceData->filesystemFileName = contents->filesystemFileName;
+	sourceData->lastModifiedDateTime = contents->lastModifiedDateTime;
 	sourceData->htmlDocument = std::make_shared<const QString>(source);
-	sourceData->sourceCodeTextlines = QString((f.seek(0), f.readAll())).split('\n');
+	sourceData->sourceCodeTextlines = contents->textLines();
+	sourceData->lineNumberPrefixLength = lineNumberPrefixLength;
 	sourceData->textDocument = std::make_shared<QTextDocument>();
 	sourceData->textDocument->setHtml(sourceData->htmlDocument.operator *());
-	sourceFileCacheData.operator [](sourceFileName) = sourceData;
+	sourceFileCacheData.operator [](fileId) = sourceData;
 	return sourceData;
 }
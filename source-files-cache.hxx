@@ -30,6 +30,7 @@
 #include <QTextDocument>
 
 #include "source-file-data.hxx"
+#include "source-corpus.hxx"
 
 /* Note: using a cache for the source code files is not really helpful for the source view, because
  * refreshing the source code view is dominated by rendering the generated html, and not by reading
@@ -38,7 +39,7 @@
 class SourceFilesCache
 {
 public:
-	SourceFilesCache(){}
+	SourceFilesCache(SourceCorpus & sourceCorpus) : sourceCorpus(sourceCorpus) {}
 	struct SourceFileCacheData
 	{
 		/* The name of the source file, by which it can be accessed in the filesystem. This may be
@@ -47,13 +48,20 @@ public:
 		QDateTime			lastModifiedDateTime;
 		std::shared_ptr<const QString>	htmlDocument;
 		QStringList			sourceCodeTextlines;
+		/* The number of characters (line number and machine code marker) that are prepended
+		 * to each source code line in the generated document. */
+		int				lineNumberPrefixLength = 0;
 		std::shared_ptr<QTextDocument>	textDocument;
 	};
-	std::shared_ptr<const SourceFileCacheData> getSourceFileCacheData(const QString & sourceFileName, QString &errorMessage);
-	void setSourceFileData(std::shared_ptr<const QHash<QString /* gdb reported full file name */, SourceFileData>> sourceFileData)
+	std::shared_ptr<const SourceFileCacheData> getSourceFileCacheData(const QString & sourceFileName, QString &errorMessage)
+	{ return getSourceFileCacheData(PathTable::global().fileId(sourceFileName), errorMessage); }
+	std::shared_ptr<const SourceFileCacheData> getSourceFileCacheData(FileId fileId, QString &errorMessage);
+	void setSourceFileData(std::shared_ptr<const QHash<FileId, SourceFileData>> sourceFileData)
 	{ this->sourceFileData = sourceFileData; }
 private:
-	std::shared_ptr<const QHash<QString /* gdb reported full file name */, SourceFileData>> sourceFileData;
-	QHash<QString /* source file name */, std::shared_ptr<const struct SourceFileCacheData> /* source file data */> sourceFileCacheData;
+	/* The source file contents are read from the source corpus, so that they are shared with the other users of the corpus. */
+	SourceCorpus & sourceCorpus;
+	std::shared_ptr<const QHash<FileId, SourceFileData>> sourceFileData;
+	QHash<FileId, std::shared_ptr<const struct SourceFileCacheData> /* source file data */> sourceFileCacheData;
 };
 
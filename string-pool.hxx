@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include <QString>
+#include <QHash>
+
+/* A pool of interned strings. Each distinct string is stored only once, and is identified by a 32-bit id,
+ * so that data structures holding many copies of the same strings (e.g., symbol type strings, such as
+ * 'uint32_t') can store just the string ids, and can compare and hash strings by their ids.
+ *
+ * Strings are stored in their UTF-8 encoding, which is what the gdb machine interface parser produces,
+ * so that strings already in the pool are found without constructing a QString. Strings are converted
+ * to QString when retrieved from the pool, and are returned by value.
+ *
+ * Strings are never removed from the pool, and string ids remain valid for the lifetime of the program.
+ * Id 0 is always the empty string.
+ *
+ * This class is not thread safe, the global pool is only accessed from the main (gui) thread. */
+class StringPool
+{
+private:
+	/* The elements of a deque are not moved when the deque grows, so the string lookup keys below
+	 * can refer directly to the pooled strings, and the strings are not stored a second time as keys. */
+	std::deque<std::string> strings;
+	struct Key
+	{
+		const char * data;
+		size_t length;
+		bool operator ==(const Key & other) const { return length == other.length && !memcmp(data, other.data, length); }
+	};
+	struct KeyHash { size_t operator ()(const Key & key) const { return qHashBits(key.data, key.length); } };
+	std::unordered_map<Key, uint32_t /* string id */, KeyHash> ids;
+	StringPool(void) { intern(std::string()); }
+public:
+	static StringPool & global(void) { static StringPool pool; return pool; }
+
+	uint32_t intern(const std::string & s)
+	{
+		auto i = ids.find(Key { s.data(), s.length() });
+		if (i != ids.end())
+			return i->second;
+		uint32_t id = strings.size();
+		strings.push_back(s);
+		ids.insert(std::make_pair(Key { strings.back().data(), strings.back().length() }, id));
+		return id;
+	}
+	QString string(uint32_t id) const { return QString::fromStdString(strings.at(id)); }
+	/* Returns the UTF-8 encoding of a pooled string. The string is never moved, so the reference returned
+	 * remains valid for the lifetime of the program. This is useful for comparing strings without
+	 * converting them to QString. */
+	const std::string & utf8String(uint32_t id) const { return strings.at(id); }
+	int size(void) const { return strings.size(); }
+};
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <string.h>
+
+#include <QFile>
+#include <QHash>
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QDebug>
+
+#include "svd-image.hxx"
+
+bool SvdImage::load(const QString & svdFileName)
+{
+	clear();
+	QFile svdFile(svdFileName);
+	if (!svdFile.open(QFile::ReadOnly))
+		return false;
+	QByteArray svdHash = QCryptographicHash::hash(svdFile.readAll(), QCryptographicHash::Sha1);
+	svdFile.close();
+
+	QFile cacheFile(cacheFileName(svdFileName));
+	if (cacheFile.open(QFile::ReadOnly))
+	{
+		arena = cacheFile.readAll();
+		if (isArenaValid(svdHash))
+		{
+			isLoadedFromCacheFile = true;
+			return true;
+		}
+		qDebug() << "svd cache file" << cacheFile.fileName() << "is stale or invalid, rebuilding it";
+		arena.clear();
+	}
+
+	SvdFileParser parser;
+	parser.parse(svdFileName);
+	compile(parser.device, svdHash);
+
+	/* Failing to save the cache file is not an error, the SVD file will just be parsed again the next time it is loaded. */
+	QSaveFile f(cacheFileName(svdFileName));
+	if (!f.open(QFile::WriteOnly) || f.write(arena) != arena.size() || !f.commit())
+		qDebug() << "failed to save svd cache file" << f.fileName();
+	return true;
+}
+
+bool SvdImage::isArenaValid(const QByteArray & svdHash) const
+{
+	if ((unsigned) arena.size() < sizeof(Header))
+		return false;
+	const Header & h = header();
+	if (memcmp(h.magic, magic(), sizeof h.magic) || h.formatVersion != FORMAT_VERSION || h.arenaSize != (unsigned) arena.size()
+			|| svdHash.size() != sizeof h.svdHash || memcmp(h.svdHash, svdHash.constData(), sizeof h.svdHash))
+		return false;
+	/* In the order of the section enumeration. */
+	const size_t elementSizes[SECTION_COUNT] = { sizeof(String), 1, sizeof(Peripheral), sizeof(AddressBlock), sizeof(Register), sizeof(Field), };
+	for (int i = 0; i < SECTION_COUNT; i ++)
+		if ((h.sections[i].offset & 3) || h.sections[i].offset > h.arenaSize
+				|| (h.arenaSize - h.sections[i].offset) / elementSizes[i] < h.sections[i].count)
+			return false;
+
+	auto isRangeValid = [] (uint32_t first, uint32_t count, uint32_t limit) -> bool { return first <= limit && count <= limit - first; };
+	uint32_t stringCount = count(STRINGS);
+	auto isStringValid = [&] (uint32_t stringId) -> bool { return stringId < stringCount; };
+
+	for (uint32_t i = 0; i < stringCount; i ++)
+		if (!isRangeValid(section<String>(STRINGS)[i].offset, section<String>(STRINGS)[i].length, count(STRING_DATA)))
+			return false;
+	if (!isStringValid(h.deviceName) || !isStringValid(h.deviceDescription) || !isStringValid(h.cpuName))
+		return false;
+	for (uint32_t i = 0; i < peripheralCount(); i ++)
+	{
+		const Peripheral & p = peripheral(i);
+		if (!isStringValid(p.name) || !isStringValid(p.description) || !isStringValid(p.groupName)
+				|| !isRangeValid(p.firstAddressBlock, p.addressBlockCount, addressBlockCount())
+				|| !isRangeValid(p.firstRegister, p.registerCount, registerCount()))
+			return false;
+	}
+	for (uint32_t i = 0; i < addressBlockCount(); i ++)
+		if (!isStringValid(addressBlock(i).usage))
+			return false;
+	for (uint32_t i = 0; i < registerCount(); i ++)
+	{
+		const Register & r = svdRegister(i);
+		if (!isStringValid(r.name) || !isStringValid(r.description) || !isStringValid(r.access) || !isStringValid(r.readAction)
+				|| !isRangeValid(r.firstField, r.fieldCount, fieldCount())
+				|| !isRangeValid(r.firstChild, r.childCount, registerCount())
+				|| (r.parent != NO_INDEX && r.parent >= registerCount()) || r.peripheral >= peripheralCount())
+			return false;
+	}
+	for (uint32_t i = 0; i < fieldCount(); i ++)
+	{
+		const Field & f = field(i);
+		if (!isStringValid(f.name) || !isStringValid(f.description) || !isStringValid(f.access) || !isStringValid(f.readAction)
+				|| f.parentRegister >= registerCount())
+			return false;
+	}
+	return true;
+}
+
+void SvdImage::compile(const SvdFileParser::SvdDeviceNode & device, const QByteArray & svdHash)
+{
+	std::vector<String> strings;
+	QByteArray stringData;
+	QHash<QString, uint32_t> stringIds;
+	std::vector<Peripheral> peripherals;
+	std::vector<AddressBlock> addressBlocks;
+	std::vector<Register> registers;
+	std::vector<Field> fields;
+
+	auto intern = [&] (const QString & s) -> uint32_t
+	{
+		auto i = stringIds.constFind(s);
+		if (i != stringIds.cend())
+			return i.value();
+		QByteArray utf8 = s.toUtf8();
+		String t = { (uint32_t) stringData.size(), (uint32_t) utf8.size(), };
+		strings.push_back(t);
+		stringData += utf8;
+		stringIds.insert(s, strings.size() - 1);
+		return strings.size() - 1;
+	};
+	/* String id 0 is always the empty string. */
+	intern(QString());
+	/* This is used to remove any excessive whitespace in description strings. */
+	QRegularExpression rx("\\s\\s+");
+	auto internDescription = [&] (const QString & s) -> uint32_t { return intern(QString(s).replace(rx, " ")); };
+
+	/* Registers are stored so that the top level registers and clusters of a peripheral, and the children of a
+	 * cluster, occupy contiguous ranges of the register array. The slots for all siblings are allocated first,
+	 * and after that the siblings are filled in, recursively allocating the slots for their own children. */
+	std::function<void(uint32_t index, const SvdFileParser::SvdRegisterOrClusterNode & rc, uint32_t baseAddress, uint32_t parent, uint32_t peripheral)> fill =
+		[&] (uint32_t index, const SvdFileParser::SvdRegisterOrClusterNode & rc, uint32_t baseAddress, uint32_t parent, uint32_t peripheral) -> void
+	{
+		Register r;
+		r.name = intern(rc.name);
+		r.description = internDescription(rc.description);
+		r.access = intern(rc.access);
+		r.readAction = intern(rc.readAction);
+		r.flags = rc.isRegisterNode ? 0 : Register::IS_CLUSTER;
+		if (!rc.readAction.isEmpty())
+			r.flags |= Register::HAS_READ_SIDE_EFFECTS;
+		r.address = baseAddress + rc.addressOffset;
+		r.size = rc.size;
+		r.resetValue = rc.resetValue;
+		r.parent = parent;
+		r.peripheral = peripheral;
+		r.firstField = fields.size();
+		r.fieldCount = rc.fields.size();
+		for (const auto & f : rc.fields)
+		{
+			Field t = { intern(f.name), internDescription(f.description), intern(f.access), intern(f.readAction), f.bitOffset, f.bitWidth, index, };
+			fields.push_back(t);
+			if (!f.readAction.isEmpty())
+				r.flags |= Register::HAS_READ_SIDE_EFFECTS;
+		}
+		r.firstChild = registers.size();
+		r.childCount = rc.children.size();
+		registers.resize(registers.size() + rc.children.size());
+		registers.at(index) = r;
+		uint32_t i = r.firstChild;
+		for (const auto & child : rc.children)
+			fill(i ++, child, r.address, index, peripheral);
+	};
+	for (const auto & p : device.peripherals)
+	{
+		Peripheral t;
+		t.name = intern(p.name);
+		t.description = internDescription(p.description);
+		t.groupName = intern(p.groupName);
+		t.baseAddress = p.baseAddress;
+		t.firstAddressBlock = addressBlocks.size();
+		t.addressBlockCount = p.addressBlocks.size();
+		for (const auto & b : p.addressBlocks)
+		{
+			AddressBlock a = { b.offset, b.size, intern(b.usage), };
+			addressBlocks.push_back(a);
+		}
+		t.firstRegister = registers.size();
+		t.registerCount = p.registersAndClusters.size();
+		registers.resize(registers.size() + p.registersAndClusters.size());
+		peripherals.push_back(t);
+		uint32_t i = t.firstRegister;
+		for (const auto & rc : p.registersAndClusters)
+			fill(i ++, rc, p.baseAddress, NO_INDEX, peripherals.size() - 1);
+	}
+
+	/* Lay out the arena. */
+	Header h;
+	memset(& h, 0, sizeof h);
+	memcpy(h.magic, magic(), sizeof h.magic);
+	h.formatVersion = FORMAT_VERSION;
+	memcpy(h.svdHash, svdHash.constData(), std::min(sizeof h.svdHash, (size_t) svdHash.size()));
+	h.deviceName = intern(device.name);
+	h.deviceDescription = internDescription(device.description);
+	h.cpuName = intern(device.cpu.name);
+
+	arena = QByteArray((const char *) & h, sizeof h);
+	auto append = [&] (enum SECTION_ENUM s, const void * data, size_t size, uint32_t count)
+	{
+		/* Keep all sections aligned. */
+		while (arena.size() & 3)
+			arena.append('\0');
+		Header * t = reinterpret_cast<Header *>(arena.data());
+		t->sections[s].offset = arena.size();
+		t->sections[s].count = count;
+		arena.append((const char *) data, size);
+	};
+	append(STRINGS, strings.data(), strings.size() * sizeof(String), strings.size());
+	append(STRING_DATA, stringData.constData(), stringData.size(), stringData.size());
+	append(PERIPHERALS, peripherals.data(), peripherals.size() * sizeof(Peripheral), peripherals.size());
+	append(ADDRESS_BLOCKS, addressBlocks.data(), addressBlocks.size() * sizeof(AddressBlock), addressBlocks.size());
+	append(REGISTERS, registers.data(), registers.size() * sizeof(Register), registers.size());
+	append(FIELDS, fields.data(), fields.size() * sizeof(Field), fields.size());
+	reinterpret_cast<Header *>(arena.data())->arenaSize = arena.size();
+}
+
+QString SvdImage::registerPathName(uint32_t registerIndex) const
+{
+	QString name = string(svdRegister(registerIndex).name);
+	for (uint32_t i = svdRegister(registerIndex).parent; i != NO_INDEX; i = svdRegister(i).parent)
+		name.prepend(string(svdRegister(i).name) + '.');
+	return name;
+}
+
+std::vector<uint32_t> SvdImage::peripheralRegisters(uint32_t peripheralIndex) const
+{
+	std::vector<uint32_t> registers;
+	std::function<void(uint32_t first, uint32_t count)> collect = [&] (uint32_t first, uint32_t count) -> void
+	{
+		for (uint32_t i = first; i < first + count; i ++)
+			if (svdRegister(i).isCluster())
+				collect(svdRegister(i).firstChild, svdRegister(i).childCount);
+			else
+				registers.push_back(i);
+	};
+	collect(peripheral(peripheralIndex).firstRegister, peripheral(peripheralIndex).registerCount);
+	std::stable_sort(registers.begin(), registers.end(), [&] (uint32_t a, uint32_t b) -> bool { return svdRegister(a).address < svdRegister(b).address; });
+	return registers;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> SvdImage::readRanges(uint32_t peripheralIndex, std::function<bool(uint32_t registerIndex)> isRequested) const
+{
+	std::vector<std::pair<uint32_t, uint32_t>> ranges;
+	const Peripheral & p = peripheral(peripheralIndex);
+	auto addressBlockIndex = [&] (uint32_t start, uint32_t end) -> uint32_t
+	{
+		for (uint32_t i = p.firstAddressBlock; i < p.firstAddressBlock + p.addressBlockCount; i ++)
+			if (start >= p.baseAddress + addressBlock(i).offset && end <= p.baseAddress + addressBlock(i).offset + addressBlock(i).size)
+				return i;
+		return NO_INDEX;
+	};
+	/* The address block of the range being built, or NO_INDEX if no range is being built. */
+	uint32_t rangeBlock = NO_INDEX;
+	for (const auto & i : peripheralRegisters(peripheralIndex))
+	{
+		uint32_t start = svdRegister(i).address, end = start + registerByteSize(i);
+		uint32_t block = addressBlockIndex(start, end);
+		if (!isRequested(i))
+		{
+			/* Do not read registers with read side effects as part of a larger range. */
+			if (svdRegister(i).hasReadSideEffects())
+				rangeBlock = NO_INDEX;
+			continue;
+		}
+		if (block != NO_INDEX && block == rangeBlock && start >= ranges.back().first)
+			ranges.back().second = std::max(ranges.back().second, end);
+		else
+			ranges.push_back(std::make_pair(start, end)), rangeBlock = block;
+	}
+	return ranges;
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <algorithm>
+
+#include <QByteArray>
+#include <QString>
+
+#include "svdfileparser.hxx"
+
+/* A compiled, flat, form of a parsed SVD file.
+ *
+ * Parsing large SVD files (e.g., the SVD files for some STM32H7 devices are over 3 MB in size) with the xml
+ * parser, and expanding their 'dim' elements, is slow. Instead, an SVD file is parsed only once, and the
+ * parsed data is compiled into flat arrays of peripherals, address blocks, registers and fields, which are
+ * all stored in a single memory arena. All strings are interned, and are referenced by string ids.
+ * The arena is saved in a cache file next to the SVD file, and on subsequent loads of the SVD file, the
+ * arena is read back from the cache file, and is used directly, without any further processing.
+ *
+ * The cache file is keyed by a hash of the SVD file contents, so that it is discarded when the SVD file changes.
+ *
+ * All 'dim' elements and 'derivedFrom' references are resolved when compiling the SVD data, and the absolute
+ * addresses of all registers are computed. The children of a register cluster, the top level registers
+ * and clusters of a peripheral, and the fields of a register, are stored in contiguous ranges of the
+ * corresponding arrays. */
+class SvdImage
+{
+public:
+	enum
+	{
+		/* Increment this when the layout of the arena changes. */
+		FORMAT_VERSION		= 2,
+		/* Index value denoting no element. */
+		NO_INDEX		= 0xffffffff,
+	};
+	struct Peripheral
+	{
+		uint32_t	name;
+		uint32_t	description;
+		uint32_t	groupName;
+		uint32_t	baseAddress;
+		uint32_t	firstAddressBlock;
+		uint32_t	addressBlockCount;
+		/* The top level registers and clusters of the peripheral. */
+		uint32_t	firstRegister;
+		uint32_t	registerCount;
+	};
+	struct AddressBlock
+	{
+		uint32_t	offset;
+		uint32_t	size;
+		uint32_t	usage;
+	};
+	/* A register, or a register cluster. */
+	struct Register
+	{
+		enum
+		{
+			IS_CLUSTER		= 1 << 0,
+			/* Set if reading the register, or any of its fields, has side effects (e.g. clears status flags). */
+			HAS_READ_SIDE_EFFECTS	= 1 << 1,
+		};
+		uint32_t	name;
+		uint32_t	description;
+		uint32_t	access;
+		uint32_t	readAction;
+		uint32_t	flags;
+		/* The absolute address of the register, or cluster. */
+		uint32_t	address;
+		/* The size of the register in bits, 0xffffffff if not specified in the SVD file. */
+		uint32_t	size;
+		uint32_t	resetValue;
+		uint32_t	firstField;
+		uint32_t	fieldCount;
+		/* For clusters - the registers and clusters in the cluster. */
+		uint32_t	firstChild;
+		uint32_t	childCount;
+		/* The parent cluster, or NO_INDEX for top level registers and clusters. */
+		uint32_t	parent;
+		uint32_t	peripheral;
+		bool isCluster(void) const { return flags & IS_CLUSTER; }
+		bool hasReadSideEffects(void) const { return flags & HAS_READ_SIDE_EFFECTS; }
+	};
+	struct Field
+	{
+		uint32_t	name;
+		uint32_t	description;
+		uint32_t	access;
+		uint32_t	readAction;
+		uint32_t	bitOffset;
+		uint32_t	bitWidth;
+		uint32_t	parentRegister;
+	};
+
+private:
+	struct String
+	{
+		uint32_t	offset;
+		uint32_t	length;
+	};
+	enum SECTION_ENUM
+	{
+		STRINGS = 0,
+		STRING_DATA,
+		PERIPHERALS,
+		ADDRESS_BLOCKS,
+		REGISTERS,
+		FIELDS,
+		SECTION_COUNT,
+	};
+	struct Header
+	{
+		char		magic[8];
+		uint32_t	formatVersion;
+		uint32_t	arenaSize;
+		uint8_t		svdHash[20];
+		uint32_t	deviceName;
+		uint32_t	deviceDescription;
+		uint32_t	cpuName;
+		struct
+		{
+			uint32_t	offset;
+			uint32_t	count;
+		}
+		sections[SECTION_COUNT];
+	};
+	static const char * magic(void) { return "TURBOSVD"; }
+
+	QByteArray arena;
+	bool isLoadedFromCacheFile = false;
+
+	const Header & header(void) const { return * reinterpret_cast<const Header *>(arena.constData()); }
+	template <typename T> const T * section(enum SECTION_ENUM s) const
+	{ return reinterpret_cast<const T *>(arena.constData() + header().sections[s].offset); }
+	uint32_t count(enum SECTION_ENUM s) const { return arena.isEmpty() ? 0 : header().sections[s].count; }
+
+	static QString cacheFileName(const QString & svdFileName) { return svdFileName + ".turbo-cache"; }
+	/* Checks that all sections, string ids, and element index ranges in the arena are valid. */
+	bool isArenaValid(const QByteArray & svdHash) const;
+	void compile(const SvdFileParser::SvdDeviceNode & device, const QByteArray & svdHash);
+
+public:
+	/* Loads an SVD file, either from its cache file, or by parsing and compiling it. Returns false if the SVD file cannot be read. */
+	bool load(const QString & svdFileName);
+	void clear(void) { arena.clear(); isLoadedFromCacheFile = false; }
+	bool isEmpty(void) const { return arena.isEmpty(); }
+	bool isLoadedFromCache(void) const { return isLoadedFromCacheFile; }
+
+	QString string(uint32_t stringId) const
+	{
+		if (stringId >= count(STRINGS))
+			return QString();
+		const String & s = section<String>(STRINGS)[stringId];
+		return QString::fromUtf8(section<char>(STRING_DATA) + s.offset, s.length);
+	}
+	QString deviceName(void) const { return arena.isEmpty() ? QString() : string(header().deviceName); }
+	QString deviceDescription(void) const { return arena.isEmpty() ? QString() : string(header().deviceDescription); }
+	QString cpuName(void) const { return arena.isEmpty() ? QString() : string(header().cpuName); }
+
+	uint32_t peripheralCount(void) const { return count(PERIPHERALS); }
+	const Peripheral & peripheral(uint32_t index) const { return section<Peripheral>(PERIPHERALS)[index]; }
+	uint32_t addressBlockCount(void) const { return count(ADDRESS_BLOCKS); }
+	const AddressBlock & addressBlock(uint32_t index) const { return section<AddressBlock>(ADDRESS_BLOCKS)[index]; }
+	uint32_t registerCount(void) const { return count(REGISTERS); }
+	const Register & svdRegister(uint32_t index) const { return section<Register>(REGISTERS)[index]; }
+	uint32_t fieldCount(void) const { return count(FIELDS); }
+	const Field & field(uint32_t index) const { return section<Field>(FIELDS)[index]; }
+
+	/* Returns the size of a register in bytes. Registers wider than 32 bits are not supported, and are treated as 32-bit registers. */
+	uint32_t registerByteSize(uint32_t registerIndex) const
+	{
+		uint32_t size = svdRegister(registerIndex).size;
+		return size == NO_INDEX ? 4 : std::max(1u, std::min(4u, (size + 7) / 8));
+	}
+	/* Returns the name of a register, prefixed with the names of its enclosing clusters, separated by dots. */
+	QString registerPathName(uint32_t registerIndex) const;
+	/* Returns the indices of all registers (but not clusters) of a peripheral, including the registers in clusters, sorted by address. */
+	std::vector<uint32_t> peripheralRegisters(uint32_t peripheralIndex) const;
+	/* Computes the target memory ranges to read, in order to read some of the registers of a peripheral with as few
+	 * memory reads as possible. All requested registers that lie in the same address block of the peripheral are
+	 * read with a single memory read, unless there are registers with read side effects between them - these are
+	 * never read, unless requested. Registers that are not in any address block of their peripheral are read
+	 * separately. The ranges are returned as pairs of [start address, end address). */
+	std::vector<std::pair<uint32_t, uint32_t>> readRanges(uint32_t peripheralIndex, std::function<bool(uint32_t registerIndex)> isRequested) const;
+};
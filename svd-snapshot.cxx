@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QHash>
+
+#include "svd-snapshot.hxx"
+
+std::vector<std::pair<uint32_t, uint32_t>> SvdSnapshot::addPeripheral(const SvdImage & svdImage, uint32_t peripheralIndex)
+{
+	const SvdImage::Peripheral & p = svdImage.peripheral(peripheralIndex);
+	Peripheral peripheral;
+	peripheral.name = svdImage.string(p.name);
+	peripheral.baseAddress = p.baseAddress;
+	for (const auto & i : svdImage.peripheralRegisters(peripheralIndex))
+	{
+		const SvdImage::Register & r = svdImage.svdRegister(i);
+		Register t;
+		t.name = svdImage.registerPathName(i);
+		t.address = r.address;
+		t.size = svdImage.registerByteSize(i);
+		if (r.hasReadSideEffects())
+			t.state = SKIPPED;
+		for (uint32_t f = r.firstField; f < r.firstField + r.fieldCount; f ++)
+		{
+			Field field;
+			field.name = svdImage.string(svdImage.field(f).name);
+			field.bitOffset = svdImage.field(f).bitOffset;
+			field.bitWidth = svdImage.field(f).bitWidth;
+			t.fields.push_back(field);
+		}
+		peripheral.registers.push_back(t);
+	}
+	peripherals.push_back(peripheral);
+	return svdImage.readRanges(peripheralIndex, [&] (uint32_t registerIndex) -> bool { return !svdImage.svdRegister(registerIndex).hasReadSideEffects(); });
+}
+
+void SvdSnapshot::memoryRead(uint32_t address, uint32_t length, const QByteArray & data)
+{
+	for (auto & p : peripherals)
+		for (auto & r : p.registers)
+		{
+			if (r.state == SKIPPED || r.address < address || r.address - address + r.size > length)
+				continue;
+			if (r.address - address + r.size > (uint32_t) data.length())
+			{
+				r.state = READ_FAILED;
+				continue;
+			}
+			r.value = 0;
+			for (int i = r.size - 1; i >= 0; i --)
+				r.value = (r.value << 8) | (uint8_t) data.at(r.address - address + i);
+			r.state = READ;
+			for (auto & f : r.fields)
+				f.value = fieldValue(r.value, f.bitOffset, f.bitWidth);
+		}
+}
+
+bool SvdSnapshot::save(const QString & fileName) const
+{
+	QJsonArray jsonPeripherals;
+	for (const auto & p : peripherals)
+	{
+		QJsonArray jsonRegisters;
+		for (const auto & r : p.registers)
+		{
+			QJsonArray jsonFields;
+			for (const auto & f : r.fields)
+				jsonFields.append(QJsonObject({ { "name", f.name }, { "bitOffset", (double) f.bitOffset }, { "bitWidth", (double) f.bitWidth },
+								{ "value", (double) f.value }, }));
+			jsonRegisters.append(QJsonObject({ { "name", r.name }, { "address", (double) r.address }, { "size", (double) r.size },
+							   { "state", (int) r.state }, { "value", (double) r.value }, { "fields", jsonFields }, }));
+		}
+		jsonPeripherals.append(QJsonObject({ { "name", p.name }, { "baseAddress", (double) p.baseAddress }, { "registers", jsonRegisters }, }));
+	}
+	QJsonObject snapshot({ { "label", label }, { "time", time.toString(Qt::ISODate) }, { "device", deviceName }, { "peripherals", jsonPeripherals }, });
+	QSaveFile f(fileName);
+	QByteArray data = QJsonDocument(snapshot).toJson();
+	return f.open(QFile::WriteOnly) && f.write(data) == data.size() && f.commit();
+}
+
+bool SvdSnapshot::load(const QString & fileName)
+{
+	QFile f(fileName);
+	if (!f.open(QFile::ReadOnly))
+		return false;
+	QJsonDocument document = QJsonDocument::fromJson(f.readAll());
+	if (!document.isObject())
+		return false;
+	QJsonObject snapshot = document.object();
+	label = snapshot.value("label").toString();
+	time = QDateTime::fromString(snapshot.value("time").toString(), Qt::ISODate);
+	deviceName = snapshot.value("device").toString();
+	peripherals.clear();
+	for (const auto & jp : snapshot.value("peripherals").toArray())
+	{
+		QJsonObject jsonPeripheral = jp.toObject();
+		Peripheral p;
+		p.name = jsonPeripheral.value("name").toString();
+		p.baseAddress = jsonPeripheral.value("baseAddress").toDouble();
+		for (const auto & jr : jsonPeripheral.value("registers").toArray())
+		{
+			QJsonObject jsonRegister = jr.toObject();
+			Register r;
+			r.name = jsonRegister.value("name").toString();
+			r.address = jsonRegister.value("address").toDouble();
+			r.size = jsonRegister.value("size").toDouble();
+			int state = jsonRegister.value("state").toInt();
+			r.state = (state >= NOT_READ && state <= SKIPPED) ? (enum REGISTER_STATE) state : NOT_READ;
+			r.value = jsonRegister.value("value").toDouble();
+			for (const auto & jf : jsonRegister.value("fields").toArray())
+			{
+				QJsonObject jsonField = jf.toObject();
+				Field f;
+				f.name = jsonField.value("name").toString();
+				f.bitOffset = jsonField.value("bitOffset").toDouble();
+				f.bitWidth = jsonField.value("bitWidth").toDouble();
+				f.value = jsonField.value("value").toDouble();
+				r.fields.push_back(f);
+			}
+			p.registers.push_back(r);
+		}
+		peripherals.push_back(p);
+	}
+	return true;
+}
+
+std::vector<SvdSnapshot::Difference> SvdSnapshot::compare(const SvdSnapshot & from, const SvdSnapshot & to)
+{
+	std::vector<struct Difference> differences;
+	auto registerValue = [] (const Register & r) -> QString
+	{
+		switch (r.state)
+		{
+		case READ: return QString("0x%1").arg(r.value, r.size * 2, 16, QChar('0'));
+		case READ_FAILED: return "<read failed>";
+		case SKIPPED: return "<not read, read side effects>";
+		default: return "<not read>";
+		}
+	};
+	QHash<QString /* peripheral name + '.' + register name */, const Register *> fromRegisters;
+	for (const auto & p : from.peripherals)
+		for (const auto & r : p.registers)
+			fromRegisters.insert(p.name + '.' + r.name, & r);
+	for (const auto & p : to.peripherals)
+		for (const auto & r : p.registers)
+		{
+			QString name = p.name + '.' + r.name;
+			const Register * old = fromRegisters.value(name, 0);
+			fromRegisters.remove(name);
+			if (!old)
+			{
+				differences.push_back(Difference(name, r.address, "<missing>", registerValue(r)));
+				continue;
+			}
+			if (old->state != READ || r.state != READ)
+			{
+				if (old->state != r.state)
+					differences.push_back(Difference(name, r.address, registerValue(* old), registerValue(r)));
+				continue;
+			}
+			if (old->value == r.value)
+				continue;
+			/* Report the differences of the individual fields. If no field differences are found (e.g., the register has
+			 * no fields, or only bits that are not part of any field have changed), report the register difference. */
+			bool isFieldDifferenceFound = false;
+			for (const auto & f : r.fields)
+				for (const auto & oldField : old->fields)
+					if (oldField.name == f.name)
+					{
+						if (oldField.value != f.value)
+						{
+							differences.push_back(Difference(name + '.' + f.name, r.address, QString("0x%1").arg(oldField.value, 0, 16),
+											 QString("0x%1").arg(f.value, 0, 16)));
+							isFieldDifferenceFound = true;
+						}
+						break;
+					}
+			if (!isFieldDifferenceFound)
+				differences.push_back(Difference(name, r.address, registerValue(* old), registerValue(r)));
+		}
+	/* Registers only present in the 'from' snapshot. */
+	for (const auto & p : from.peripherals)
+		for (const auto & r : p.registers)
+			if (fromRegisters.contains(p.name + '.' + r.name))
+				differences.push_back(Difference(p.name + '.' + r.name, r.address, registerValue(r), "<missing>"));
+	return differences;
+}
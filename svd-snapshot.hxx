@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+
+#include <QString>
+#include <QDateTime>
+#include <QByteArray>
+
+#include "svd-image.hxx"
+
+/* A snapshot of the register values of some peripherals of a target device, described in an SVD file.
+ *
+ * The values of all fields of the registers are decoded when the register values are read from the target, and
+ * are stored in the snapshot together with the register values, so that snapshots are self-contained, and can be
+ * compared even if the SVD file they were taken with is no longer available. Snapshots are compared by peripheral,
+ * register and field names, so that snapshots taken with different firmware versions, or with different versions
+ * of the SVD file, can also be compared.
+ *
+ * Registers with read side effects (having a 'readAction' element in the SVD file) are never read, reading them
+ * may change the state of the peripheral being inspected. */
+class SvdSnapshot
+{
+public:
+	enum REGISTER_STATE
+	{
+		NOT_READ = 0,
+		READ,
+		READ_FAILED,
+		/* The register has read side effects, and has not been read. */
+		SKIPPED,
+	};
+	struct Field
+	{
+		QString		name;
+		uint32_t	bitOffset = 0;
+		uint32_t	bitWidth = 0;
+		uint32_t	value = 0;
+	};
+	struct Register
+	{
+		/* The register name, prefixed with the names of its enclosing clusters, if any. */
+		QString		name;
+		uint32_t	address = 0;
+		/* The register size, in bytes. */
+		uint32_t	size = 4;
+		enum REGISTER_STATE state = NOT_READ;
+		uint32_t	value = 0;
+		std::vector<struct Field> fields;
+	};
+	struct Peripheral
+	{
+		QString		name;
+		uint32_t	baseAddress = 0;
+		std::vector<struct Register> registers;
+	};
+	/* A difference between two snapshots, for a register or a register field. */
+	struct Difference
+	{
+		/* The name of the peripheral, register, and field (if any), separated by dots. */
+		QString		name;
+		uint32_t	address;
+		QString		oldValue;
+		QString		newValue;
+		Difference(const QString & name, uint32_t address, const QString & oldValue, const QString & newValue) :
+			name(name), address(address), oldValue(oldValue), newValue(newValue) {}
+	};
+
+	QString		label;
+	QDateTime	time;
+	QString		deviceName;
+	std::vector<struct Peripheral> peripherals;
+
+	/* Adds all registers of a peripheral to the snapshot, and returns the target memory ranges that must be read
+	 * in order to take the snapshot, as pairs of [start address, end address). */
+	std::vector<std::pair<uint32_t, uint32_t>> addPeripheral(const SvdImage & svdImage, uint32_t peripheralIndex);
+	/* Records the contents of a target memory range read from the target. An empty 'data' array means that reading
+	 * the range has failed. */
+	void memoryRead(uint32_t address, uint32_t length, const QByteArray & data);
+
+	bool save(const QString & fileName) const;
+	bool load(const QString & fileName);
+
+	/* Returns the differences between two snapshots, in the register order of the 'to' snapshot, followed by
+	 * any registers that are only present in the 'from' snapshot. */
+	static std::vector<struct Difference> compare(const SvdSnapshot & from, const SvdSnapshot & to);
+	static uint32_t fieldValue(uint32_t registerValue, uint32_t bitOffset, uint32_t bitWidth)
+	{
+		if (bitOffset >= 32)
+			return 0;
+		return (registerValue >> bitOffset) & (bitWidth < 32 ? (1u << bitWidth) - 1 : 0xffffffff);
+	}
+};
@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <QAbstractItemModel>
+#include <QString>
+
+#include "svd-image.hxx"
+
+/* An item model for the SVD device tree view. The tree has a single top level item for the device, its only
+ * child is the 'Peripherals' item, the children of which are the peripheral groups (if any), followed by the
+ * peripherals that are not part of a peripheral group. Peripheral items contain registers and register
+ * clusters, and register items contain their fields.
+ *
+ * SVD files of large devices contain tens of thousands of registers and fields, so items are only created when
+ * they are first needed - the children of an item are created when the item is first expanded in a view
+ * (via 'fetchMore()'), or when a search result under the item must be displayed.
+ *
+ * Each created item is a node in the 'nodes' vector, and the internal id of a model index is the index of
+ * its node in this vector. Node 0 is the invisible root node.
+ *
+ * For searching, an index of all peripheral, register, cluster and field names is built when the model is
+ * reset. All names, converted to lower case, are stored in a single string, separated by newlines, so that
+ * substring searches are performed by a single scan of this string, and a sorted list of the names is used
+ * for prefix searches. */
+class SvdTreeModel : public QAbstractItemModel
+{
+public:
+	enum NODE_KIND
+	{
+		ROOT = 0,
+		DEVICE,
+		PERIPHERALS,
+		GROUP,
+		PERIPHERAL,
+		/* A register, or a register cluster. */
+		REGISTER,
+		FIELD,
+	};
+	/* Item data roles. The register roles are available for register items (but not for register cluster items),
+	 * and the peripheral role is available for peripheral items. */
+	enum
+	{
+		SVD_REGISTER_INDEX = Qt::UserRole,
+		SVD_REGISTER_ADDRESS,
+		SVD_PERIPHERAL_INDEX,
+	};
+	struct Match
+	{
+		enum NODE_KIND	kind;
+		/* The index of the peripheral, register, or field in the SVD image. */
+		uint32_t	index;
+		Match(enum NODE_KIND kind, uint32_t index) : kind(kind), index(index) {}
+	};
+private:
+	const SvdImage & svdImage;
+	struct Node
+	{
+		enum NODE_KIND	kind;
+		/* For peripheral groups - the index of the group in the 'groupNames' vector, for peripherals,
+		 * registers and fields - the index of the element in the SVD image, otherwise unused. */
+		uint32_t	index;
+		int		parent;
+		/* The row of this node in its parent node. */
+		int		row;
+		bool		isPopulated = false;
+		std::vector<int> children;
+		Node(enum NODE_KIND kind, uint32_t index, int parent, int row) : kind(kind), index(index), parent(parent), row(row) {}
+	};
+	std::vector<struct Node> nodes;
+
+	/* Peripheral group names, in alphabetical order. */
+	std::vector<QString> groupNames;
+	/* The peripherals in each group, in alphabetical order. */
+	std::vector<std::vector<uint32_t /* peripheral index */>> groupPeripherals;
+	/* The group of each peripheral, or SvdImage::NO_INDEX for peripherals not in a group. */
+	std::vector<uint32_t /* group index */> peripheralGroups;
+	/* The peripherals that are not part of a group, in SVD file order. */
+	std::vector<uint32_t /* peripheral index */> ungroupedPeripherals;
+
+	/* The name index. */
+	std::vector<struct Match> names;
+	/* All names in the name index, in lower case, each name terminated by a newline. */
+	QString nameData;
+	/* The offset of each name in the 'nameData' string. */
+	std::vector<int> nameOffsets;
+	/* The indices of the names in the name index, sorted by name. */
+	std::vector<int> sortedNames;
+
+	QStringRef name(int nameIndex) const
+	{ return nameData.midRef(nameOffsets.at(nameIndex), (nameIndex + 1 < (int) nameOffsets.size() ? nameOffsets.at(nameIndex + 1) : nameData.length()) - nameOffsets.at(nameIndex) - 1); }
+
+	int childCount(enum NODE_KIND kind, uint32_t index) const
+	{
+		switch (kind)
+		{
+		case ROOT: return svdImage.isEmpty() ? 0 : 1;
+		case DEVICE: return svdImage.peripheralCount() ? 1 : 0;
+		case PERIPHERALS: return groupNames.size() + ungroupedPeripherals.size();
+		case GROUP: return groupPeripherals.at(index).size();
+		case PERIPHERAL: return svdImage.peripheral(index).registerCount;
+		case REGISTER:
+		{
+			const SvdImage::Register & r = svdImage.svdRegister(index);
+			return r.isCluster() ? r.childCount : r.fieldCount;
+		}
+		default: return 0;
+		}
+	}
+	struct Match childKey(enum NODE_KIND kind, uint32_t index, int row) const
+	{
+		switch (kind)
+		{
+		case ROOT: return Match(DEVICE, 0);
+		case DEVICE: return Match(PERIPHERALS, 0);
+		case PERIPHERALS:
+			if (row < (int) groupNames.size())
+				return Match(GROUP, row);
+			return Match(PERIPHERAL, ungroupedPeripherals.at(row - groupNames.size()));
+		case GROUP: return Match(PERIPHERAL, groupPeripherals.at(index).at(row));
+		case PERIPHERAL: return Match(REGISTER, svdImage.peripheral(index).firstRegister + row);
+		default:
+		{
+			const SvdImage::Register & r = svdImage.svdRegister(index);
+			return r.isCluster() ? Match(REGISTER, r.firstChild + row) : Match(FIELD, r.firstField + row);
+		}
+		}
+	}
+	QModelIndex nodeIndex(int node) const { return node ? createIndex(nodes.at(node).row, 0, (quintptr) node) : QModelIndex(); }
+	/* Creates the child nodes of a node, if not already created. */
+	void populate(int node, bool notifyViews = true)
+	{
+		if (nodes.at(node).isPopulated)
+			return;
+		nodes.at(node).isPopulated = true;
+		int count = childCount(nodes.at(node).kind, nodes.at(node).index);
+		if (!count)
+			return;
+		if (notifyViews)
+			beginInsertRows(nodeIndex(node), 0, count - 1);
+		for (int row = 0; row < count; row ++)
+		{
+			struct Match key = childKey(nodes.at(node).kind, nodes.at(node).index, row);
+			nodes.at(node).children.push_back(nodes.size());
+			nodes.push_back(Node(key.kind, key.index, node, row));
+		}
+		if (notifyViews)
+			endInsertRows();
+	}
+	void buildNameIndex(void)
+	{
+		names.clear();
+		nameData.clear();
+		nameOffsets.clear();
+		auto add = [&] (enum NODE_KIND kind, uint32_t index, uint32_t nameId)
+		{
+			names.push_back(Match(kind, index));
+			nameOffsets.push_back(nameData.length());
+			nameData += svdImage.string(nameId).toLower() + '\n';
+		};
+		for (uint32_t i = 0; i < svdImage.peripheralCount(); i ++)
+			add(PERIPHERAL, i, svdImage.peripheral(i).name);
+		for (uint32_t i = 0; i < svdImage.registerCount(); i ++)
+			add(REGISTER, i, svdImage.svdRegister(i).name);
+		for (uint32_t i = 0; i < svdImage.fieldCount(); i ++)
+			add(FIELD, i, svdImage.field(i).name);
+		sortedNames.resize(names.size());
+		for (int i = 0; i < (int) sortedNames.size(); i ++)
+			sortedNames.at(i) = i;
+		std::stable_sort(sortedNames.begin(), sortedNames.end(), [&] (int a, int b) -> bool { return name(a) < name(b); });
+	}
+public:
+	SvdTreeModel(const SvdImage & svdImage, QObject * parent = 0) : QAbstractItemModel(parent), svdImage(svdImage) {}
+	/* Must be called after the SVD image is changed. */
+	void reset(void)
+	{
+		beginResetModel();
+		nodes.clear();
+		groupNames.clear();
+		groupPeripherals.clear();
+		ungroupedPeripherals.clear();
+		peripheralGroups.assign(svdImage.peripheralCount(), SvdImage::NO_INDEX);
+
+		std::map<QString, std::vector<uint32_t /* peripheral index */>> groups;
+		for (uint32_t i = 0; i < svdImage.peripheralCount(); i ++)
+			if (svdImage.peripheral(i).groupName)
+				groups[svdImage.string(svdImage.peripheral(i).groupName)].push_back(i);
+			else
+				ungroupedPeripherals.push_back(i);
+		for (auto & g : groups)
+		{
+			std::stable_sort(g.second.begin(), g.second.end(), [&] (uint32_t a, uint32_t b) -> bool
+				{ return svdImage.string(svdImage.peripheral(a).name) < svdImage.string(svdImage.peripheral(b).name); });
+			for (const auto & p : g.second)
+				peripheralGroups.at(p) = groupNames.size();
+			groupNames.push_back(g.first);
+			groupPeripherals.push_back(g.second);
+		}
+		buildNameIndex();
+
+		nodes.push_back(Node(ROOT, 0, -1, 0));
+		populate(0, false);
+		endResetModel();
+	}
+
+	/* Finds the peripherals, registers, register clusters and fields, whose names contain a string, ignoring case.
+	 * Names that start with the string are returned first, in alphabetical order, followed by the other
+	 * matching names, in SVD file order. At most 'maxMatches' matches are returned. */
+	std::vector<struct Match> find(const QString & text, int maxMatches) const
+	{
+		std::vector<struct Match> matches;
+		QString s = text.toLower();
+		if (s.isEmpty() || s.contains('\n'))
+			return matches;
+		std::vector<bool> isMatched(names.size(), false);
+		auto i = std::lower_bound(sortedNames.cbegin(), sortedNames.cend(), s, [&] (int a, const QString & b) -> bool { return name(a) < b; });
+		for (; i != sortedNames.cend() && name(* i).startsWith(s) && (int) matches.size() < maxMatches; i ++)
+			matches.push_back(names.at(* i)), isMatched.at(* i) = true;
+		int position = 0;
+		while ((int) matches.size() < maxMatches && (position = nameData.indexOf(s, position)) != -1)
+		{
+			int n = std::upper_bound(nameOffsets.cbegin(), nameOffsets.cend(), position) - nameOffsets.cbegin() - 1;
+			if (!isMatched.at(n))
+				matches.push_back(names.at(n));
+			if (n + 1 == (int) nameOffsets.size())
+				break;
+			position = nameOffsets.at(n + 1);
+		}
+		return matches;
+	}
+	/* Returns the model index for a search match, creating all of its ancestor items, if not already created.
+	 * The ancestors of the returned index are the items that must be expanded in order to display the match. */
+	QModelIndex matchIndex(const struct Match & match)
+	{
+		/* Build the path from the device item to the match. */
+		std::vector<struct Match> path(1, match);
+		if (match.kind == FIELD)
+			path.push_back(Match(REGISTER, svdImage.field(match.index).parentRegister));
+		if (path.back().kind == REGISTER)
+		{
+			while (svdImage.svdRegister(path.back().index).parent != SvdImage::NO_INDEX)
+				path.push_back(Match(REGISTER, svdImage.svdRegister(path.back().index).parent));
+			path.push_back(Match(PERIPHERAL, svdImage.svdRegister(path.back().index).peripheral));
+		}
+		if (peripheralGroups.at(path.back().index) != SvdImage::NO_INDEX)
+			path.push_back(Match(GROUP, peripheralGroups.at(path.back().index)));
+		path.push_back(Match(PERIPHERALS, 0));
+		path.push_back(Match(DEVICE, 0));
+
+		int node = 0;
+		for (auto key = path.crbegin(); key != path.crend(); key ++)
+		{
+			populate(node);
+			int child = -1;
+			for (const auto & c : nodes.at(node).children)
+				if (nodes.at(c).kind == key->kind && nodes.at(c).index == key->index)
+				{
+					child = c;
+					break;
+				}
+			if (child == -1)
+				return QModelIndex();
+			node = child;
+		}
+		return nodeIndex(node);
+	}
+	QModelIndex deviceIndex(void) const { return index(0, 0); }
+
+	QModelIndex index(int row, int column, const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (!hasIndex(row, column, parent))
+			return QModelIndex();
+		return createIndex(row, column, (quintptr) nodes.at(parent.isValid() ? parent.internalId() : 0).children.at(row));
+	}
+	QModelIndex parent(const QModelIndex & index) const override
+	{
+		if (!index.isValid())
+			return QModelIndex();
+		return nodeIndex(nodes.at(index.internalId()).parent);
+	}
+	int rowCount(const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (parent.column() > 0 || nodes.empty())
+			return 0;
+		return nodes.at(parent.isValid() ? parent.internalId() : 0).children.size();
+	}
+	int columnCount(const QModelIndex & = QModelIndex()) const override { return 3; }
+	bool hasChildren(const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (parent.column() > 0 || nodes.empty())
+			return false;
+		const Node & node = nodes.at(parent.isValid() ? parent.internalId() : 0);
+		return childCount(node.kind, node.index) > 0;
+	}
+	bool canFetchMore(const QModelIndex & parent) const override
+	{
+		if (parent.column() > 0 || nodes.empty())
+			return false;
+		const Node & node = nodes.at(parent.isValid() ? parent.internalId() : 0);
+		return !node.isPopulated && childCount(node.kind, node.index) > 0;
+	}
+	void fetchMore(const QModelIndex & parent) override
+	{
+		if (parent.column() <= 0 && !nodes.empty())
+			populate(parent.isValid() ? parent.internalId() : 0);
+	}
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+	{
+		if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+			return QVariant();
+		switch (section)
+		{
+		case 0: return "Name";
+		case 1: return "Value";
+		case 2: return "Description";
+		default: return QVariant();
+		}
+	}
+	QVariant data(const QModelIndex & index, int role) const override
+	{
+		if (!index.isValid())
+			return QVariant();
+		const Node & node = nodes.at(index.internalId());
+		if (role == SVD_REGISTER_INDEX || role == SVD_REGISTER_ADDRESS)
+		{
+			if (node.kind != REGISTER || svdImage.svdRegister(node.index).isCluster())
+				return QVariant();
+			return role == SVD_REGISTER_INDEX ? node.index : svdImage.svdRegister(node.index).address;
+		}
+		if (role == SVD_PERIPHERAL_INDEX)
+			return node.kind == PERIPHERAL ? QVariant(node.index) : QVariant();
+		if (role != Qt::DisplayRole)
+			return QVariant();
+		switch (node.kind)
+		{
+		case DEVICE:
+			switch (index.column())
+			{
+			case 0: return svdImage.deviceName();
+			case 1: return svdImage.cpuName();
+			default: return svdImage.deviceDescription();
+			}
+		case PERIPHERALS: return index.column() ? QVariant() : "Peripherals";
+		case GROUP: return index.column() ? QVariant() : groupNames.at(node.index);
+		case PERIPHERAL:
+		{
+			const SvdImage::Peripheral & p = svdImage.peripheral(node.index);
+			switch (index.column())
+			{
+			case 0: return svdImage.string(p.name);
+			case 1: return QString("0x%1").arg(p.baseAddress, 8, 16, QChar('0'));
+			default: return svdImage.string(p.description);
+			}
+		}
+		case REGISTER:
+		{
+			const SvdImage::Register & r = svdImage.svdRegister(node.index);
+			switch (index.column())
+			{
+			case 0: return svdImage.string(r.name);
+			case 1: return QString("0x%1").arg(r.address, 8, 16, QChar('0'));
+			default: return svdImage.string(r.description);
+			}
+		}
+		case FIELD:
+		{
+			const SvdImage::Field & f = svdImage.field(node.index);
+			switch (index.column())
+			{
+			case 0: return svdImage.string(f.name);
+			case 1: return f.bitWidth > 1 ? QString("%1:%2").arg(f.bitOffset).arg(f.bitOffset + f.bitWidth - 1) : QString::number(f.bitOffset);
+			default: return svdImage.string(f.description);
+			}
+		}
+		default: return QVariant();
+		}
+	}
+};
@@ -197,6 +197,8 @@ there:
 							registerOrCluster.alternateRegister = origin->alternateRegister;
 						if (registerOrCluster.access.isEmpty())
 							registerOrCluster.access = origin->access;
+						if (registerOrCluster.readAction.isEmpty())
+							registerOrCluster.readAction = origin->readAction;
 						if (registerOrCluster.addressOffset == -1)
 							registerOrCluster.addressOffset = origin->addressOffset;
 						if (registerOrCluster.size == -1)
@@ -254,6 +256,8 @@ void SvdFileParser::parseRegisterField(SvdRegisterFieldNode & field)
 			field.description = xml.readElementText();
 		else if (xml.name() == "access")
 			field.access = xml.readElementText();
+		else if (xml.name() == "readAction")
+			field.readAction = xml.readElementText();
 		else if (xml.name() == "bitOffset")
 		{
 			unsigned t = xml.readElementText().toULong(& ok, 0);
@@ -324,6 +328,8 @@ void SvdFileParser::parseRegisterOrCluster(SvdRegisterOrClusterNode & registerOr
 			r.alternateRegister = xml.readElementText();
 		else if (xml.name() == "access")
 			r.access = xml.readElementText();
+		else if (xml.name() == "readAction")
+			r.readAction = xml.readElementText();
 		else if (xml.name() == "register")
 		{
 			r.children.push_back(SvdRegisterOrClusterNode());
@@ -105,6 +105,8 @@ public:
 		QString		name;
 		QString		description;
 		QString		access;
+		/* The side effect of reading the field, if any, e.g. "clear". */
+		QString		readAction;
 		unsigned	bitOffset = -1;
 		unsigned	bitWidth = -1;
 		/*! \todo	This is currently not used, because there are no known samples using it. Fix this if this changes in the future. */
@@ -119,6 +121,8 @@ public:
 		QString		description;
 		QString		alternateRegister;
 		QString		access;
+		/* The side effect of reading the register, if any, e.g. "clear". */
+		QString		readAction;
 		unsigned	addressOffset = -1;
 		unsigned	size = -1;
 		unsigned	resetValue = -1;
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <QString>
+#include <QByteArray>
+#include <QVariant>
+
+#include "source-file-data.hxx"
+#include "string-pool.hxx"
+#include "file-id.hxx"
+
+/* An index over the names of all known symbols - subprograms, data objects, data types, and source files,
+ * used by the object locator. The index supports fuzzy (subsequence) matching of names - a name matches
+ * a pattern if all characters of the pattern occur in the name, in the same order, but not necessarily
+ * adjacent to each other. Matches are scored, so that matches at word boundaries and runs of adjacent
+ * matching characters rank higher, and only the best scoring matches are returned.
+ *
+ * The index is built once, after all symbols have been retrieved from gdb, and is then only read.
+ * Matching is case insensitive for ASCII characters. */
+class SymbolIndex
+{
+public:
+	struct Symbol
+	{
+		enum SourceFileData::SymbolData::SymbolKind kind;
+		int line;
+		/* The symbol strings are kept in the global string pool, and the full file name in the global path table.
+		 * They are only converted to QString when needed, e.g. when a symbol is displayed. */
+		uint32_t nameId, fileNameId, descriptionId;
+		FileId fileId;
+		Symbol(enum SourceFileData::SymbolData::SymbolKind kind, uint32_t nameId, uint32_t fileNameId, FileId fileId,
+		       int line, uint32_t descriptionId = 0) :
+			kind(kind), line(line), nameId(nameId), fileNameId(fileNameId), descriptionId(descriptionId), fileId(fileId) {}
+		QString name(void) const { return StringPool::global().string(nameId); }
+		QString fileName(void) const { return StringPool::global().string(fileNameId); }
+		QString fullFileName(void) const { return PathTable::global().path(fileId); }
+		QString description(void) const { return StringPool::global().string(descriptionId); }
+		/* The UTF-8 encodings of the symbol strings, for comparing symbols. */
+		const std::string & utf8Name(void) const { return StringPool::global().utf8String(nameId); }
+		const std::string & utf8FileName(void) const { return StringPool::global().utf8String(fileNameId); }
+		const std::string & utf8Description(void) const { return StringPool::global().utf8String(descriptionId); }
+	};
+	struct Match
+	{
+		/* The index of the matching symbol, for use with 'symbol()'. */
+		int symbolIndex;
+		int score;
+	};
+private:
+	enum
+	{
+		SCORE_MATCH		= 16,
+		SCORE_GAP_START		= 3,
+		SCORE_GAP_EXTENSION	= 1,
+		BONUS_BOUNDARY		= 8,
+		BONUS_CAMEL_CASE	= 7,
+		BONUS_CONSECUTIVE	= 4,
+		/* The bonus for the first pattern character is multiplied by this. */
+		BONUS_FIRST_CHARACTER_MULTIPLIER	= 2,
+	};
+	std::vector<struct Symbol> symbols;
+	/* The data needed for matching symbol names is kept apart from the symbol data, and the names are
+	 * stored back to back in a single buffer, so that scanning all symbols touches as little memory as possible. */
+	struct MatchData
+	{
+		uint32_t	offset;
+		uint32_t	length;
+		/* A bit is set for each character class (see 'characterBit()') that occurs in the name. A pattern
+		 * can only match a name, if all bits of the pattern mask are also set in the name mask. */
+		uint64_t	characterMask;
+	};
+	std::vector<struct MatchData> matchData;
+	/* The symbol names, in UTF-8, and the same names with ASCII characters converted to lowercase. */
+	std::string names, foldedNames;
+
+	static unsigned char foldCharacter(unsigned char c) { return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c; }
+	static bool isAlphanumeric(unsigned char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (c & 0x80); }
+	static uint64_t characterBit(unsigned char foldedCharacter)
+	{
+		if (foldedCharacter >= 'a' && foldedCharacter <= 'z')
+			return 1ULL << (foldedCharacter - 'a');
+		if (foldedCharacter >= '0' && foldedCharacter <= '9')
+			return 1ULL << (26 + foldedCharacter - '0');
+		return 1ULL << (36 + foldedCharacter % 28);
+	}
+	static uint64_t characterMask(const char * foldedText, int length)
+	{
+		uint64_t mask = 0;
+		while (length --)
+			mask |= characterBit(* foldedText ++);
+		return mask;
+	}
+	static int boundaryBonus(const char * name, int position)
+	{
+		if (!position)
+			return BONUS_BOUNDARY;
+		unsigned char previous = name[position - 1], current = name[position];
+		if (!isAlphanumeric(previous) && isAlphanumeric(current))
+			return BONUS_BOUNDARY;
+		if ((previous >= 'a' && previous <= 'z') && (current >= 'A' && current <= 'Z'))
+			return BONUS_CAMEL_CASE;
+		return 0;
+	}
+	/* Returns the score for matching a pattern against a name, or -1 if the pattern does not match.
+	 * The pattern must already be folded to lowercase. */
+	static int matchScore(const char * name, const char * foldedName, int length, const char * pattern, int patternLength)
+	{
+		int i, j;
+		/* Find the leftmost position at which a match of the pattern ends. */
+		for (i = j = 0; i < length && j < patternLength; i ++)
+			if (foldedName[i] == pattern[j])
+				j ++;
+		if (j != patternLength)
+			return -1;
+		int end = i;
+		/* Scan back from the end of the match, to find the shortest match that ends there. */
+		for (i = end - 1, j = patternLength - 1; j >= 0; i --)
+			if (foldedName[i] == pattern[j])
+				j --;
+		int start = i + 1;
+
+		int score = 0, consecutiveCount = 0, chunkBonus = 0;
+		bool inGap = false;
+		for (i = start, j = 0; i < end; i ++)
+		{
+			if (foldedName[i] == pattern[j])
+			{
+				int bonus = boundaryBonus(name, i);
+				if (consecutiveCount)
+					/* A run of adjacent matching characters gets at least the bonus of the first character in the run. */
+					bonus = std::max(bonus, std::max(chunkBonus, (int) BONUS_CONSECUTIVE));
+				else
+					chunkBonus = bonus;
+				if (!j)
+					bonus *= BONUS_FIRST_CHARACTER_MULTIPLIER;
+				score += SCORE_MATCH + bonus;
+				consecutiveCount ++;
+				inGap = false;
+				j ++;
+			}
+			else
+			{
+				score -= inGap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+				inGap = true;
+				consecutiveCount = 0;
+			}
+		}
+		/* Very long gaps must not turn a match into a mismatch. */
+		return std::max(score, 0);
+	}
+	/* Symbols are kept sorted by the UTF-8 encodings of their names. */
+	struct SymbolNameLess
+	{
+		bool operator ()(const struct Symbol & a, const std::string & b) const { return a.utf8Name() < b; }
+		bool operator ()(const std::string & a, const struct Symbol & b) const { return a < b.utf8Name(); }
+	};
+	/* Returns true, if match 'a' ranks higher than match 'b'. Ties are broken by preferring shorter names,
+	 * and then by the alphabetical order of the symbols. */
+	bool isBetterMatch(const struct Match & a, const struct Match & b) const
+	{
+		if (a.score != b.score)
+			return a.score > b.score;
+		if (matchData[a.symbolIndex].length != matchData[b.symbolIndex].length)
+			return matchData[a.symbolIndex].length < matchData[b.symbolIndex].length;
+		return a.symbolIndex < b.symbolIndex;
+	}
+public:
+	void setSymbols(std::vector<struct Symbol> && newSymbols)
+	{
+		symbols = std::move(newSymbols);
+		std::sort(symbols.begin(), symbols.end(), [] (const struct Symbol & a, const struct Symbol & b) -> bool
+			{
+				int c = a.utf8Name().compare(b.utf8Name());
+				return c < 0 || (!c && (a.kind < b.kind || (a.kind == b.kind && a.fileId != b.fileId && a.fullFileName() < b.fullFileName())));
+			});
+		matchData.clear();
+		names.clear();
+		foldedNames.clear();
+		for (const auto & s : symbols)
+		{
+			const std::string & name = s.utf8Name();
+			struct MatchData m;
+			m.offset = names.size();
+			m.length = name.size();
+			names.append(name);
+			for (const auto & c : name)
+				foldedNames.push_back(foldCharacter(c));
+			m.characterMask = characterMask(foldedNames.data() + m.offset, m.length);
+			matchData.push_back(m);
+		}
+	}
+	int symbolCount(void) const { return symbols.size(); }
+	const struct Symbol & symbol(int symbolIndex) const { return symbols.at(symbolIndex); }
+	/* Returns the indices of all symbols with the name passed. */
+	std::vector<int> symbolsNamed(const QString & name) const
+	{
+		auto range = std::equal_range(symbols.cbegin(), symbols.cend(), name.toStdString(), SymbolNameLess());
+		std::vector<int> result;
+		for (auto i = range.first; i != range.second; i ++)
+			result.push_back(i - symbols.cbegin());
+		return result;
+	}
+
+	/* Returns at most 'maxResults' symbols matching the pattern passed, best matches first.
+	 * Whitespace in the pattern is ignored. */
+	std::vector<struct Match> search(const QString & pattern, int maxResults) const
+	{
+		std::string foldedPattern;
+		for (const auto & c : pattern.toUtf8())
+			if (c != ' ' && c != '\t')
+				foldedPattern.push_back(foldCharacter(c));
+		std::vector<struct Match> matches;
+		if (foldedPattern.empty() || maxResults <= 0)
+			return matches;
+		uint64_t patternMask = characterMask(foldedPattern.data(), foldedPattern.length());
+		uint32_t patternLength = foldedPattern.length();
+		/* Keep the best matches in a heap, with the worst of the best matches at its top. */
+		auto compare = [&] (const struct Match & a, const struct Match & b) -> bool { return isBetterMatch(a, b); };
+		for (int i = 0; i < (int) matchData.size(); i ++)
+		{
+			const struct MatchData & m = matchData[i];
+			if (m.length < patternLength || (m.characterMask & patternMask) != patternMask)
+				continue;
+			int score = matchScore(names.data() + m.offset, foldedNames.data() + m.offset, m.length, foldedPattern.data(), patternLength);
+			if (score < 0)
+				continue;
+			struct Match match = { i, score };
+			if ((int) matches.size() < maxResults)
+			{
+				matches.push_back(match);
+				std::push_heap(matches.begin(), matches.end(), compare);
+			}
+			else if (isBetterMatch(match, matches.front()))
+			{
+				std::pop_heap(matches.begin(), matches.end(), compare);
+				matches.back() = match;
+				std::push_heap(matches.begin(), matches.end(), compare);
+			}
+		}
+		std::sort_heap(matches.begin(), matches.end(), compare);
+		return matches;
+	}
+};
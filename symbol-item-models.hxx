@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <algorithm>
+
+#include <QVariant>
+#include <QHash>
+#include <QBrush>
+#include <QAbstractItemModel>
+#include <QAbstractTableModel>
+
+#include "symbol-index.hxx"
+#include "utils.hxx"
+
+/* Item models for the views that display symbols - the subprograms, static data objects, data types, and
+ * source files views, and the object locator. All of these models are backed by the symbol index, and only
+ * store indices of symbols in the index, so that no per-item objects are ever created. Only the items that
+ * are actually displayed by a view are ever materialized, through the 'data()' model functions.
+ *
+ * Whenever the symbol index is rebuilt, the models backed by it must be reset by calling their 'reset()' functions. */
+
+/* Returns the item data for the special item roles, used for source code navigation, and for building
+ * context menus for source items. See the 'SourceFileData' roles enumeration. */
+static inline QVariant symbolItemRoleData(const SymbolIndex::Symbol & s, int role)
+{
+	switch (role)
+	{
+	case SourceFileData::FILE_NAME:
+		return s.fullFileName();
+	case SourceFileData::LINE_NUMBER:
+		return s.line;
+	case SourceFileData::ITEM_KIND:
+		return (int) s.kind;
+	case SourceFileData::DISABLE_CONTEXT_MENU:
+		return s.kind == SourceFileData::SymbolData::SOURCE_FILE_NAME;
+	case SourceFileData::DISASSEMBLY_TARGET_COORDINATES:
+		if (s.kind != SourceFileData::SymbolData::SUBPROGRAM)
+			return QVariant();
+		/* Note - it is important that the '--function' argument is placed in quotation marks, because
+		 * gdb can report some function names as, e.g., 'foo(int, int)', and the spaces in such names
+		 * confuse gdb. */
+		return QString(" -f \"%1\" -l %2 -n -1 -- 5").arg(Utils::escapeString(s.fullFileName())).arg(s.line);
+	case SourceFileData::BREAKPOINT_TARGET_COORDINATES:
+		if (s.kind != SourceFileData::SymbolData::SUBPROGRAM)
+			return QVariant();
+		return QString(" --source \"%1\" --function \"%2\"").arg(Utils::escapeString(s.fullFileName())).arg(s.name());
+	default:
+		return QVariant();
+	}
+}
+
+/* A flat list of all symbols of a given kind, e.g., all subprograms. */
+class SymbolListModel : public QAbstractTableModel
+{
+private:
+	const SymbolIndex & symbolIndex;
+	const enum SourceFileData::SymbolData::SymbolKind symbolKind;
+	/* The indices of the displayed symbols in the symbol index, in display order. */
+	std::vector<int> rows;
+	int sortColumn = 0;
+	Qt::SortOrder sortOrder = Qt::AscendingOrder;
+
+	void sortRows(void)
+	{
+		std::function<bool(int, int)> lessThan;
+		switch (sortColumn)
+		{
+		default:
+		case 0:
+			/* The symbol index is already sorted by name. */
+			lessThan = [] (int a, int b) -> bool { return a < b; };
+			break;
+		case 1:
+			lessThan = [&] (int a, int b) -> bool
+			{
+				const SymbolIndex::Symbol & x = symbolIndex.symbol(a), & y = symbolIndex.symbol(b);
+				int c = x.utf8FileName().compare(y.utf8FileName());
+				return c < 0 || (!c && a < b);
+			};
+			break;
+		case 2:
+			lessThan = [&] (int a, int b) -> bool
+			{
+				const SymbolIndex::Symbol & x = symbolIndex.symbol(a), & y = symbolIndex.symbol(b);
+				return x.line < y.line || (x.line == y.line && a < b);
+			};
+			break;
+		case 3:
+			lessThan = [&] (int a, int b) -> bool
+			{
+				const SymbolIndex::Symbol & x = symbolIndex.symbol(a), & y = symbolIndex.symbol(b);
+				int c = x.utf8Description().compare(y.utf8Description());
+				return c < 0 || (!c && a < b);
+			};
+			break;
+		}
+		if (sortOrder == Qt::AscendingOrder)
+			std::sort(rows.begin(), rows.end(), lessThan);
+		else
+			std::sort(rows.begin(), rows.end(), [&] (int a, int b) -> bool { return lessThan(b, a); });
+	}
+public:
+	SymbolListModel(const SymbolIndex & symbolIndex, enum SourceFileData::SymbolData::SymbolKind symbolKind, QObject * parent = 0) :
+		QAbstractTableModel(parent), symbolIndex(symbolIndex), symbolKind(symbolKind) {}
+	void reset(void)
+	{
+		beginResetModel();
+		rows.clear();
+		for (int i = 0; i < symbolIndex.symbolCount(); i ++)
+			if (symbolIndex.symbol(i).kind == symbolKind)
+				rows.push_back(i);
+		sortRows();
+		endResetModel();
+	}
+
+	int rowCount(const QModelIndex & parent = QModelIndex()) const override { return parent.isValid() ? 0 : rows.size(); }
+	int columnCount(const QModelIndex & = QModelIndex()) const override { return symbolKind == SourceFileData::SymbolData::DATA_TYPE ? 3 : 4; }
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+	{
+		if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+			return QVariant();
+		switch (section)
+		{
+		case 0: return "Name";
+		case 1: return "File";
+		case 2: return symbolKind == SourceFileData::SymbolData::DATA_TYPE ? "Line" : "Line number";
+		case 3: return "Details";
+		default: return QVariant();
+		}
+	}
+	QVariant data(const QModelIndex & index, int role) const override
+	{
+		if (!index.isValid() || index.row() >= (int) rows.size())
+			return QVariant();
+		const SymbolIndex::Symbol & s = symbolIndex.symbol(rows.at(index.row()));
+		if (role != Qt::DisplayRole)
+			return symbolItemRoleData(s, role);
+		switch (index.column())
+		{
+		case 0: return s.name();
+		case 1: return s.fileName();
+		case 2: return s.line;
+		case 3: return s.description();
+		default: return QVariant();
+		}
+	}
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override
+	{
+		if (column == sortColumn && order == sortOrder)
+			return;
+		sortColumn = column;
+		sortOrder = order;
+		emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+		QModelIndexList persistentIndices = persistentIndexList();
+		std::vector<int> persistentSymbols;
+		for (const auto & i : persistentIndices)
+			persistentSymbols.push_back(rows.at(i.row()));
+		sortRows();
+		std::vector<int> symbolRows(symbolIndex.symbolCount(), -1);
+		for (int i = 0; i < (int) rows.size(); i ++)
+			symbolRows.at(rows.at(i)) = i;
+		QModelIndexList newPersistentIndices;
+		for (int i = 0; i < persistentIndices.size(); i ++)
+			newPersistentIndices << index(symbolRows.at(persistentSymbols.at(i)), persistentIndices.at(i).column());
+		changePersistentIndexList(persistentIndices, newPersistentIndices);
+		emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+	}
+};
+
+/* The source files view model. Top level items are source files, and the children of each source
+ * file item are the subprograms defined in that source file. The displayed source files can be
+ * filtered by a user-supplied predicate.
+ *
+ * Top level items have an internal id of 0, and child items have an internal id equal to the index
+ * of their parent source file in the 'files' vector, plus one. */
+class SourceFilesModel : public QAbstractItemModel
+{
+private:
+	const SymbolIndex & symbolIndex;
+	struct File
+	{
+		/* The index of the source file name symbol in the symbol index. */
+		int symbolIndex;
+		/* The indices of the subprogram symbols for this source file. */
+		std::vector<int> subprograms;
+	};
+	std::vector<struct File> files;
+	/* The indices in the 'files' vector of the displayed source files, in display order. */
+	std::vector<int> rows;
+	/* The display row for each source file in the 'files' vector, or -1 if the file is filtered out. */
+	std::vector<int> fileRows;
+	std::function<bool(const SymbolIndex::Symbol & sourceFile)> filter;
+	int sortColumn = 0;
+	Qt::SortOrder sortOrder = Qt::AscendingOrder;
+
+	/* Returns true, if the source file with index 'a' in the 'files' vector is displayed before the file with index 'b'. */
+	bool isDisplayedBefore(int a, int b) const
+	{
+		if (sortOrder != Qt::AscendingOrder)
+			std::swap(a, b);
+		if (!sortColumn)
+			/* The symbol index is already sorted by name. */
+			return files.at(a).symbolIndex < files.at(b).symbolIndex;
+		QString x = symbolIndex.symbol(files.at(a).symbolIndex).fullFileName(), y = symbolIndex.symbol(files.at(b).symbolIndex).fullFileName();
+		return x < y || (x == y && a < b);
+	}
+	void updateFileRows(void)
+	{
+		fileRows.assign(files.size(), -1);
+		for (int i = 0; i < (int) rows.size(); i ++)
+			fileRows.at(rows.at(i)) = i;
+	}
+	void sortRows(void)
+	{
+		std::sort(rows.begin(), rows.end(), [&] (int a, int b) -> bool { return isDisplayedBefore(a, b); });
+		updateFileRows();
+	}
+	void filterRows(void)
+	{
+		rows.clear();
+		for (int i = 0; i < (int) files.size(); i ++)
+			if (!filter || filter(symbolIndex.symbol(files.at(i).symbolIndex)))
+				rows.push_back(i);
+		sortRows();
+	}
+public:
+	SourceFilesModel(const SymbolIndex & symbolIndex, QObject * parent = 0) : QAbstractItemModel(parent), symbolIndex(symbolIndex) {}
+	void reset(void)
+	{
+		beginResetModel();
+		files.clear();
+		QHash<FileId, int /* index in the 'files' vector */> fileIndices;
+		for (int i = 0; i < symbolIndex.symbolCount(); i ++)
+			if (symbolIndex.symbol(i).kind == SourceFileData::SymbolData::SOURCE_FILE_NAME)
+			{
+				fileIndices.insert(symbolIndex.symbol(i).fileId, files.size());
+				files.push_back(File());
+				files.back().symbolIndex = i;
+			}
+		/* Subprograms are listed by their descriptions, in alphabetical order. */
+		std::vector<int> subprograms;
+		for (int i = 0; i < symbolIndex.symbolCount(); i ++)
+			if (symbolIndex.symbol(i).kind == SourceFileData::SymbolData::SUBPROGRAM && fileIndices.contains(symbolIndex.symbol(i).fileId))
+				subprograms.push_back(i);
+		std::sort(subprograms.begin(), subprograms.end(), [&] (int a, int b) -> bool
+			{ return symbolIndex.symbol(a).utf8Description() < symbolIndex.symbol(b).utf8Description(); });
+		for (const auto & s : subprograms)
+			files.at(fileIndices.value(symbolIndex.symbol(s).fileId)).subprograms.push_back(s);
+		filterRows();
+		endResetModel();
+	}
+	/* Sets the predicate that decides which source files are displayed. */
+	void setFilter(std::function<bool(const SymbolIndex::Symbol & sourceFile)> newFilter)
+	{
+		beginResetModel();
+		filter = newFilter;
+		filterRows();
+		endResetModel();
+	}
+	/* Applies the current predicate again, when the data that the predicate depends on has changed.
+	 * The model is not reset, only the rows of the source files whose visibility has changed are
+	 * removed or inserted, so that the expanded and selected items of views are preserved. */
+	void refilter(void)
+	{
+		auto isDisplayed = [&] (int file) -> bool { return !filter || filter(symbolIndex.symbol(files.at(file).symbolIndex)); };
+		std::vector<bool> displayed(files.size());
+		for (int i = 0; i < (int) files.size(); i ++)
+			displayed.at(i) = isDisplayed(i);
+		/* Remove the rows that are no longer displayed, in runs of adjacent rows. */
+		for (int last = rows.size() - 1; last >= 0; last --)
+		{
+			if (displayed.at(rows.at(last)))
+				continue;
+			int first = last;
+			while (first > 0 && !displayed.at(rows.at(first - 1)))
+				first --;
+			beginRemoveRows(QModelIndex(), first, last);
+			rows.erase(rows.begin() + first, rows.begin() + last + 1);
+			updateFileRows();
+			endRemoveRows();
+			last = first;
+		}
+		/* Insert the rows that are now displayed, in runs of adjacent rows. The rows still displayed
+		 * keep their relative order, so the new rows are merged into them. */
+		std::vector<int> newRows;
+		for (int i = 0; i < (int) files.size(); i ++)
+			if (displayed.at(i))
+				newRows.push_back(i);
+		std::sort(newRows.begin(), newRows.end(), [&] (int a, int b) -> bool { return isDisplayedBefore(a, b); });
+		for (int row = 0; row < (int) newRows.size(); row ++)
+		{
+			if (fileRows.at(newRows.at(row)) != -1)
+				continue;
+			int last = row;
+			while (last + 1 < (int) newRows.size() && fileRows.at(newRows.at(last + 1)) == -1)
+				last ++;
+			beginInsertRows(QModelIndex(), row, last);
+			rows.insert(rows.begin() + row, newRows.begin() + row, newRows.begin() + last + 1);
+			updateFileRows();
+			endInsertRows();
+			row = last;
+		}
+	}
+
+	QModelIndex index(int row, int column, const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (!hasIndex(row, column, parent))
+			return QModelIndex();
+		if (!parent.isValid())
+			return createIndex(row, column, (quintptr) 0);
+		return createIndex(row, column, (quintptr) rows.at(parent.row()) + 1);
+	}
+	QModelIndex parent(const QModelIndex & index) const override
+	{
+		if (!index.isValid() || !index.internalId())
+			return QModelIndex();
+		return createIndex(fileRows.at(index.internalId() - 1), 0, (quintptr) 0);
+	}
+	int rowCount(const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (!parent.isValid())
+			return rows.size();
+		if (parent.internalId() || parent.column() > 0)
+			return 0;
+		return files.at(rows.at(parent.row())).subprograms.size();
+	}
+	int columnCount(const QModelIndex & = QModelIndex()) const override { return 2; }
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+	{
+		if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+			return QVariant();
+		switch (section)
+		{
+		case 0: return "Name";
+		case 1: return "Full name";
+		default: return QVariant();
+		}
+	}
+	QVariant data(const QModelIndex & index, int role) const override
+	{
+		if (!index.isValid())
+			return QVariant();
+		if (!index.internalId())
+		{
+			const SymbolIndex::Symbol & s = symbolIndex.symbol(files.at(rows.at(index.row())).symbolIndex);
+			if (role != Qt::DisplayRole)
+				return symbolItemRoleData(s, role);
+			return index.column() ? s.fullFileName() : s.fileName();
+		}
+		const SymbolIndex::Symbol & s = symbolIndex.symbol(files.at(index.internalId() - 1).subprograms.at(index.row()));
+		if (role != Qt::DisplayRole)
+			return symbolItemRoleData(s, role);
+		return index.column() ? QVariant() : s.description();
+	}
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override
+	{
+		if (column == sortColumn && order == sortOrder)
+			return;
+		sortColumn = column;
+		sortOrder = order;
+		emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+		/* Only the rows of top level items change, child items keep their rows, and their internal ids. */
+		QModelIndexList persistentIndices = persistentIndexList(), oldIndices, newIndices;
+		std::vector<int> persistentFiles;
+		for (const auto & i : persistentIndices)
+			if (!i.internalId())
+				oldIndices << i, persistentFiles.push_back(rows.at(i.row()));
+		sortRows();
+		for (int i = 0; i < oldIndices.size(); i ++)
+			newIndices << index(fileRows.at(persistentFiles.at(i)), oldIndices.at(i).column());
+		changePersistentIndexList(oldIndices, newIndices);
+		emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+	}
+};
+
+/* An item model for displaying the object locator results. If there are no results to display,
+ * a single row with an informational message is displayed instead. */
+class ObjectLocatorModel : public QAbstractTableModel
+{
+private:
+	const SymbolIndex & symbolIndex;
+	std::vector<struct SymbolIndex::Match> matches;
+	QString message;
+	static QString symbolKindName(enum SourceFileData::SymbolData::SymbolKind kind)
+	{
+		switch (kind)
+		{
+		case SourceFileData::SymbolData::SUBPROGRAM: return "subprogram";
+		case SourceFileData::SymbolData::DATA_OBJECT: return "data object";
+		case SourceFileData::SymbolData::DATA_TYPE: return "data type";
+		case SourceFileData::SymbolData::SOURCE_FILE_NAME: return "file";
+		default: return "???";
+		}
+	}
+public:
+	ObjectLocatorModel(const SymbolIndex & symbolIndex, QObject * parent = 0) : QAbstractTableModel(parent), symbolIndex(symbolIndex) {}
+	void setMatches(std::vector<struct SymbolIndex::Match> && newMatches, const QString & noMatchesMessage)
+	{
+		beginResetModel();
+		matches = std::move(newMatches);
+		message = noMatchesMessage;
+		endResetModel();
+	}
+	void setMessage(const QString & newMessage) { setMatches(std::vector<struct SymbolIndex::Match>(), newMessage); }
+
+	int rowCount(const QModelIndex & parent = QModelIndex()) const override
+	{
+		if (parent.isValid())
+			return 0;
+		return matches.empty() ? 1 : matches.size();
+	}
+	int columnCount(const QModelIndex & = QModelIndex()) const override { return 2; }
+	QVariant data(const QModelIndex & index, int role) const override
+	{
+		if (!index.isValid())
+			return QVariant();
+		if (matches.empty())
+		{
+			switch (role)
+			{
+			case Qt::DisplayRole: return index.column() ? QVariant() : message;
+			case Qt::BackgroundRole: return QBrush(Qt::lightGray);
+			case SourceFileData::DISABLE_CONTEXT_MENU:
+			case SourceFileData::DISABLE_SOURCE_CODE_NAVIGATION: return true;
+			default: return QVariant();
+			}
+		}
+		if (index.row() >= (int) matches.size() || matches.at(index.row()).symbolIndex >= symbolIndex.symbolCount())
+			return QVariant();
+		const SymbolIndex::Symbol & s = symbolIndex.symbol(matches.at(index.row()).symbolIndex);
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			if (!index.column())
+				return s.name();
+			if (s.kind == SourceFileData::SymbolData::SOURCE_FILE_NAME)
+				return QString("%1, %2").arg(symbolKindName(s.kind)).arg(s.fullFileName());
+			return QString("%1, %2:%3").arg(symbolKindName(s.kind)).arg(s.fileName()).arg(s.line);
+		case Qt::ToolTipRole:
+			return s.utf8Description().empty() ? QVariant() : s.description();
+		case Qt::ForegroundRole:
+			return index.column() ? QBrush(Qt::darkGray) : QVariant();
+		default:
+			return symbolItemRoleData(s, role);
+		}
+	}
+};
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <bitset>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include <QByteArray>
+
+/* A cache of target memory contents, shared by all frontend views that read target memory, so that reading
+ * the same target memory more than once while the target is halted does not need a round trip to the target.
+ *
+ * Memory contents are stored in aligned pages, and the cache keeps track of which bytes in a page are known,
+ * so that reads of any size and alignment can be cached. The cache must be invalidated whenever the target
+ * memory contents can change, i.e. when the target is resumed, and when target memory is written.
+ *
+ * Reads of memory ranges that are marked as volatile (e.g., memory mapped peripheral registers, for which
+ * reading a register can have side effects, and which can change even while the target is halted) are never
+ * served from the cache, and are never cached. */
+class TargetMemoryCache
+{
+public:
+	enum
+	{
+		PAGE_SIZE	= 256,
+	};
+private:
+	struct Page
+	{
+		QByteArray		data = QByteArray(PAGE_SIZE, 0);
+		std::bitset<PAGE_SIZE>	isKnown;
+	};
+	std::unordered_map<uint32_t /* page address */, struct Page> pages;
+	/* Sorted by start address, and non-overlapping. */
+	std::vector<std::pair<uint64_t /* start */, uint64_t /* end */>> volatileRanges;
+
+	static uint32_t pageAddress(uint32_t address) { return address & ~(PAGE_SIZE - 1); }
+	/* Calls 'f' for each part of a range that is contained in a single page. */
+	static void forEachPage(uint32_t address, uint32_t length, std::function<void(uint32_t page, int offset, int count, int dataOffset)> f)
+	{
+		uint64_t a = address, end = (uint64_t) address + length;
+		while (a < end)
+		{
+			uint32_t page = pageAddress(a);
+			int offset = a - page;
+			int count = std::min((uint64_t) page + PAGE_SIZE, end) - a;
+			f(page, offset, count, a - address);
+			a += count;
+		}
+	}
+public:
+	TargetMemoryCache(void) { resetVolatileRanges(); }
+	/* Marks as volatile the address ranges which are not memory in the ARMv7-M architectural memory map,
+	 * i.e. the 'Peripheral', 'Device' and 'System' address ranges. */
+	void resetVolatileRanges(void)
+	{
+		volatileRanges.clear();
+		addVolatileRange(0x40000000, 0x20000000);
+		addVolatileRange(0xa0000000, 0x60000000);
+	}
+	void addVolatileRange(uint32_t address, uint32_t length)
+	{
+		if (!length)
+			return;
+		std::pair<uint64_t, uint64_t> r(address, (uint64_t) address + length);
+		std::vector<std::pair<uint64_t, uint64_t>> ranges;
+		for (const auto & v : volatileRanges)
+			if (v.second < r.first || v.first > r.second)
+				ranges.push_back(v);
+			else
+				r.first = std::min(r.first, v.first), r.second = std::max(r.second, v.second);
+		ranges.push_back(r);
+		std::sort(ranges.begin(), ranges.end());
+		volatileRanges.swap(ranges);
+		for (auto p = pages.begin(); p != pages.end();)
+			if (isVolatile(p->first, PAGE_SIZE))
+				p = pages.erase(p);
+			else
+				p ++;
+	}
+	bool isVolatile(uint32_t address, uint32_t length) const
+	{
+		uint64_t end = (uint64_t) address + length;
+		/* Find the first range that ends after the start address. */
+		auto r = std::upper_bound(volatileRanges.cbegin(), volatileRanges.cend(), (uint64_t) address,
+					  [] (uint64_t a, const std::pair<uint64_t, uint64_t> & range) -> bool { return a < range.second; });
+		return r != volatileRanges.cend() && r->first < end;
+	}
+	/* Records the contents of target memory read. Volatile memory contents are discarded. */
+	void insert(uint32_t address, const QByteArray & data)
+	{
+		forEachPage(address, data.size(), [&] (uint32_t page, int offset, int count, int dataOffset) -> void
+		{
+			if (isVolatile(page + offset, count))
+				return;
+			struct Page & p = pages[page];
+			for (int i = 0; i < count; i ++)
+				p.data[offset + i] = data.at(dataOffset + i), p.isKnown.set(offset + i);
+		});
+	}
+	/* Returns true, and the memory contents, if the whole range is in the cache. */
+	bool lookup(uint32_t address, uint32_t length, QByteArray & data) const
+	{
+		if (!length || isVolatile(address, length))
+			return false;
+		bool isCached = true;
+		data.resize(length);
+		forEachPage(address, length, [&] (uint32_t page, int offset, int count, int dataOffset) -> void
+		{
+			auto p = pages.find(page);
+			if (!isCached || p == pages.end())
+			{
+				isCached = false;
+				return;
+			}
+			for (int i = 0; i < count; i ++)
+			{
+				if (!p->second.isKnown.test(offset + i))
+				{
+					isCached = false;
+					return;
+				}
+				data[dataOffset + i] = p->second.data.at(offset + i);
+			}
+		});
+		return isCached;
+	}
+	void invalidate(void) { pages.clear(); }
+	void invalidate(uint32_t address, uint32_t length)
+	{
+		forEachPage(address, length, [&] (uint32_t page, int, int, int) -> void { pages.erase(page); });
+	}
+};
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <QByteArray>
+#include <QString>
+
+#include <elfio/elfio.hpp>
+
+/* Verifies the contents of the target memory against the loadable segments of an ELF file.
+ *
+ * Reading back the whole target memory is slow, especially for large images over slow debug links.
+ * Instead, the ELF segments are split into blocks, and a CRC32 checksum of each block is computed by
+ * the gdb server on the target side (by the remote protocol 'qCRC' packet), and is compared to the
+ * checksum of the block data in the ELF file. Only the blocks whose checksums differ, or whose checksums
+ * could not be computed on the target side (e.g., because the gdb server does not support the 'qCRC'
+ * packet), are read back, in order to find out the exact addresses of the differences.
+ *
+ * This class does not communicate with gdb, it only keeps track of the verification state. */
+class TargetMemoryVerifier
+{
+public:
+	enum
+	{
+		BLOCK_SIZE		= 4096,
+	};
+	struct Block
+	{
+		enum STATE
+		{
+			CRC_PENDING = 0,
+			MATCH,
+			MISMATCH,
+			/* The target side checksum could not be computed, the block must be read back. */
+			CRC_UNAVAILABLE,
+		};
+		uint32_t	address;
+		QByteArray	expectedData;
+		uint32_t	expectedCrc;
+		enum STATE	state = CRC_PENDING;
+		bool		isReadBackPending = false;
+		bool		isReadBackFailed = false;
+		QByteArray	actualData;
+		Block(uint32_t address, const QByteArray & expectedData) :
+			address(address), expectedData(expectedData), expectedCrc(crc32(expectedData.constData(), expectedData.length())) {}
+	};
+
+	/* Computes the CRC32 checksum of a memory area, the same way as the gdb 'qCRC' packet does.
+	 * This is the CRC-32 with polynomial 0x04c11db7, initial value 0xffffffff, with no bit reflection
+	 * and no final xor. */
+	static uint32_t crc32(const char * data, int length, uint32_t crc = 0xffffffff)
+	{
+		static uint32_t table[256];
+		static bool isTableInitialized = false;
+		if (!isTableInitialized)
+		{
+			for (uint32_t i = 0; i < 256; i ++)
+			{
+				uint32_t c = i << 24;
+				for (int j = 0; j < 8; j ++)
+					c = (c & 0x80000000) ? (c << 1) ^ 0x04c11db7 : (c << 1);
+				table[i] = c;
+			}
+			isTableInitialized = true;
+		}
+		while (length --)
+			crc = (crc << 8) ^ table[((crc >> 24) ^ (uint8_t) * data ++) & 0xff];
+		return crc;
+	}
+
+private:
+	std::vector<struct Block> verifiedBlocks;
+	int crcPendingCount = 0;
+	int readBackPendingCount = 0;
+	bool isVerificationActive = false;
+
+public:
+	/* Starts a new verification, returns false if there are no loadable segments to verify. */
+	bool start(const ELFIO::elfio & elf)
+	{
+		verifiedBlocks.clear();
+		for (const auto & segment : elf.segments)
+		{
+			if (segment->get_type() != PT_LOAD || !segment->get_file_size())
+				continue;
+			QByteArray data(segment->get_data(), segment->get_file_size());
+			for (int offset = 0; offset < data.length(); offset += BLOCK_SIZE)
+				verifiedBlocks.push_back(Block(segment->get_physical_address() + offset, data.mid(offset, BLOCK_SIZE)));
+		}
+		crcPendingCount = verifiedBlocks.size();
+		readBackPendingCount = 0;
+		return isVerificationActive = !verifiedBlocks.empty();
+	}
+	void cancel(void) { verifiedBlocks.clear(); crcPendingCount = readBackPendingCount = 0; isVerificationActive = false; }
+	bool isActive(void) const { return isVerificationActive; }
+	const std::vector<struct Block> & blocks(void) const { return verifiedBlocks; }
+
+	/* Records the target side checksum of a block. Returns true when all checksums have been received. */
+	bool crcReceived(int blockIndex, bool isCrcValid, uint32_t crc)
+	{
+		if (blockIndex < 0 || blockIndex >= (int) verifiedBlocks.size() || verifiedBlocks.at(blockIndex).state != Block::CRC_PENDING)
+			return false;
+		struct Block & b = verifiedBlocks.at(blockIndex);
+		b.state = !isCrcValid ? Block::CRC_UNAVAILABLE : (crc == b.expectedCrc ? Block::MATCH : Block::MISMATCH);
+		return -- crcPendingCount == 0;
+	}
+	/* Returns the indices of the blocks that must be read back, and marks them as pending read back. */
+	std::vector<int> startReadBack(void)
+	{
+		std::vector<int> indices;
+		for (int i = 0; i < (int) verifiedBlocks.size(); i ++)
+			if (verifiedBlocks.at(i).state == Block::MISMATCH || verifiedBlocks.at(i).state == Block::CRC_UNAVAILABLE)
+				verifiedBlocks.at(i).isReadBackPending = true, indices.push_back(i);
+		readBackPendingCount = indices.size();
+		return indices;
+	}
+	/* Records the data read back for a block. An empty data array denotes a failed read.
+	 * Returns true when all pending blocks have been read back. */
+	bool readBackCompleted(int blockIndex, const QByteArray & data)
+	{
+		if (blockIndex < 0 || blockIndex >= (int) verifiedBlocks.size() || !verifiedBlocks.at(blockIndex).isReadBackPending)
+			return false;
+		struct Block & b = verifiedBlocks.at(blockIndex);
+		b.isReadBackPending = false;
+		b.actualData = data;
+		b.isReadBackFailed = data.length() != b.expectedData.length();
+		return -- readBackPendingCount == 0;
+	}
+	/* Called when the verification results have been reported. */
+	void finish(void) { isVerificationActive = false; }
+
+	int blockCount(int state) const
+	{ return std::count_if(verifiedBlocks.cbegin(), verifiedBlocks.cend(), [=] (const struct Block & b) { return b.state == state; }); }
+	bool isReadBackFailed(void) const
+	{ return std::any_of(verifiedBlocks.cbegin(), verifiedBlocks.cend(), [] (const struct Block & b) { return b.isReadBackFailed; }); }
+	/* Returns the address ranges, in the form [start, end), whose contents differ from the ELF file, for the blocks
+	 * that have been read back. Adjacent ranges are merged. */
+	std::vector<std::pair<uint32_t, uint32_t>> differences(void) const
+	{
+		std::vector<std::pair<uint32_t, uint32_t>> ranges;
+		for (const auto & b : verifiedBlocks)
+		{
+			if (b.isReadBackFailed || b.actualData.isEmpty())
+				continue;
+			for (int i = 0; i < b.expectedData.length(); i ++)
+			{
+				if (b.expectedData.at(i) == b.actualData.at(i))
+					continue;
+				uint32_t address = b.address + i;
+				if (!ranges.empty() && ranges.back().second == address)
+					ranges.back().second ++;
+				else
+					ranges.push_back(std::make_pair(address, address + 1));
+			}
+		}
+		return ranges;
+	}
+};
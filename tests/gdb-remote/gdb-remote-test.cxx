@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <random>
+
+#include <QtTest>
+
+#include "gdb-remote.hxx"
+
+/* Tests the remote protocol packet framer and encoder with random payloads, split at random points, and
+ * with corrupted data, and measures their throughput. The random number generator is seeded with fixed
+ * values, so that failures are reproducible. */
+class GdbRemoteTest : public QObject
+{
+	Q_OBJECT
+private:
+	enum
+	{
+		FUZZ_ITERATIONS		= 20000,
+		/* The size of the payload of a typical memory read reply, a hex dump of 2 KB of memory. */
+		BENCHMARK_PAYLOAD_SIZE	= 4096,
+		BENCHMARK_PACKET_COUNT	= 256,
+	};
+	/* Generates payloads rich in the bytes that need escaping, and in runs of repeated bytes. */
+	static QByteArray randomPayload(std::mt19937 & random, int maxLength)
+	{
+		QByteArray payload;
+		int length = random() % (maxLength + 1);
+		while (payload.length() < length)
+			switch (random() % 4)
+			{
+			case 0: payload.append("$#}*"[random() % 4]); break;
+			case 1: payload.append(QByteArray(random() % 120, (char) random())); break;
+			default: payload.append((char) random()); break;
+			}
+		return payload.left(length);
+	}
+	/* Returns the payloads of all packets found in a stream, split into chunks of random sizes. */
+	static QVector<QByteArray> framePackets(std::mt19937 & random, const QByteArray & stream, bool & isAllChecksumsValid)
+	{
+		GdbRemotePacketFramer framer;
+		QVector<QByteArray> payloads;
+		isAllChecksumsValid = true;
+		for (int i = 0; i < stream.length();)
+		{
+			int length = random() % 64 + 1;
+			framer.append(stream.mid(i, length));
+			i += length;
+			while (framer.nextPacket())
+			{
+				payloads << framer.payload();
+				isAllChecksumsValid = isAllChecksumsValid && framer.isChecksumValid();
+			}
+		}
+		return payloads;
+	}
+	static QByteArray memoryReadReplyPayload(void)
+	{
+		QByteArray memory;
+		for (int i = 0; i < BENCHMARK_PAYLOAD_SIZE / 2; i ++)
+			/* Mostly zeros, as is typical for target memory. */
+			memory.append((char) ((i % 16) ? 0 : i));
+		return memory.toHex();
+	}
+private slots:
+	void encodeKnownPackets(void)
+	{
+		QCOMPARE(GdbRemote::encodePacket("OK"), QByteArray("$OK#9a"));
+		QCOMPARE(GdbRemote::encodePacket(QByteArray(16, '0'), true), QByteArray("$0*,#86"));
+		/* Repeat counts of 6 and 7 would be encoded as the '#' and '$' characters. */
+		QCOMPARE(GdbRemote::encodePacket(QByteArray(7, '0'), true), QByteArray("$0*\"0#ac"));
+		QCOMPARE(GdbRemote::encodePacket("a$b#c}d*e"), QByteArray("$a}\x04" "b}\x03" "c}]d}\x0a" "e#51"));
+	}
+	void decodePackets(void)
+	{
+		QByteArray payload;
+		QVERIFY(GdbRemote::decodePacket("$0*,#86", payload));
+		QCOMPARE(payload, QByteArray(16, '0'));
+		QVERIFY(GdbRemote::decodePacket("$OK#9A", payload));
+		QVERIFY(!GdbRemote::decodePacket("$OK#9b", payload));
+		QVERIFY(!GdbRemote::decodePacket("+$OK#9a", payload));
+		QVERIFY(!GdbRemote::decodePacket("$OK#9a$OK#9a", payload));
+		QVERIFY(!GdbRemote::decodePacket("$OK#9", payload));
+		QVERIFY(GdbRemote::isOkResponse("$OK#9a"));
+		QCOMPARE(GdbRemote::errorCode("$E05#aa"), 5);
+		QCOMPARE(GdbRemote::packetData(GdbRemote::encodePacket("m}*#$", true)), QByteArray("m}*#$"));
+	}
+	void fuzzRoundTrip(void)
+	{
+		std::mt19937 random(1);
+		for (int i = 0; i < FUZZ_ITERATIONS; i ++)
+		{
+			QVector<QByteArray> payloads;
+			QByteArray stream;
+			int count = random() % 8 + 1;
+			for (int j = 0; j < count; j ++)
+			{
+				/* Bytes outside of packets, e.g. acknowledgements, must be skipped. */
+				for (int k = random() % 4; k; k --)
+				{
+					char c = random();
+					if (c != '$')
+						stream.append(c);
+				}
+				payloads << randomPayload(random, 512);
+				stream += GdbRemote::encodePacket(payloads.back(), random() & 1);
+			}
+			bool isAllChecksumsValid;
+			QVector<QByteArray> decoded = framePackets(random, stream, isAllChecksumsValid);
+			if (decoded != payloads || !isAllChecksumsValid)
+				QFAIL(qPrintable(QString("round trip failed, iteration %1, stream: %2").arg(i).arg(QString(stream.toHex()))));
+		}
+	}
+	void fuzzCorruptedData(void)
+	{
+		std::mt19937 random(2);
+		for (int i = 0; i < FUZZ_ITERATIONS; i ++)
+		{
+			QByteArray stream;
+			for (int j = random() % 4 + 1; j; j --)
+				stream += GdbRemote::encodePacket(randomPayload(random, 64), random() & 1);
+			for (int j = random() % 4 + 1; j; j --)
+				stream[(int) (random() % stream.length())] = (char) random();
+			if (random() & 1)
+				stream.truncate(random() % (stream.length() + 1));
+			/* Whatever the state the corrupted data leaves the framer in, the next packet must be found intact. */
+			QByteArray lastPayload = randomPayload(random, 64);
+			stream += GdbRemote::encodePacket(lastPayload, random() & 1);
+			bool isAllChecksumsValid;
+			QVector<QByteArray> decoded = framePackets(random, stream, isAllChecksumsValid);
+			if (decoded.isEmpty() || decoded.back() != lastPayload)
+				QFAIL(qPrintable(QString("resynchronization failed, iteration %1, stream: %2").arg(i).arg(QString(stream.toHex()))));
+		}
+	}
+	void benchmarkFraming(void)
+	{
+		QByteArray packet = GdbRemote::encodePacket(memoryReadReplyPayload()), stream;
+		for (int i = 0; i < BENCHMARK_PACKET_COUNT; i ++)
+			stream += "+" + packet;
+		int payloadBytes = 0;
+		QBENCHMARK
+		{
+			GdbRemotePacketFramer framer;
+			/* Data arrives from the serial port, or from the network, in chunks of a few KB. */
+			for (int i = 0; i < stream.length(); i += 4096)
+				framer.append(stream.mid(i, 4096));
+			payloadBytes = 0;
+			while (framer.nextPacket())
+				payloadBytes += framer.payload().length();
+		}
+		QCOMPARE(payloadBytes, BENCHMARK_PACKET_COUNT * BENCHMARK_PAYLOAD_SIZE);
+	}
+	void benchmarkEncoding_data(void)
+	{
+		QTest::addColumn<bool>("isRunLengthEncoded");
+		QTest::newRow("plain") << false;
+		QTest::newRow("run-length encoded") << true;
+	}
+	void benchmarkEncoding(void)
+	{
+		QFETCH(bool, isRunLengthEncoded);
+		QByteArray payload = memoryReadReplyPayload();
+		int packetBytes = 0;
+		QBENCHMARK
+		{
+			packetBytes = 0;
+			for (int i = 0; i < BENCHMARK_PACKET_COUNT; i ++)
+				packetBytes += GdbRemote::encodePacket(payload, isRunLengthEncoded).length();
+		}
+		QVERIFY(packetBytes > 0);
+	}
+};
+
+QTEST_MAIN(GdbRemoteTest)
+#include "gdb-remote-test.moc"
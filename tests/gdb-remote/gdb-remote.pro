@@ -0,0 +1,16 @@
+QT       += testlib
+QT       -= gui
+
+TARGET = gdb-remote-test
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../troll/
+
+SOURCES += \
+	   gdb-remote-test.cxx
+
+HEADERS += \
+	   ../../troll/gdb-remote.hxx
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <QtTest>
+
+#include "gdb-value.hxx"
+
+/* Tests the detection of values truncated by gdb. Small element limits are used, so that the values
+ * are short, the values are as gdb prints them with 'set print elements 4' and 'set print repeats 3'. */
+class GdbValueTest : public QObject
+{
+	Q_OBJECT
+private:
+	enum
+	{
+		MAX_ELEMENTS		= 4,
+		REPEAT_THRESHOLD	= 3,
+	};
+private slots:
+	void isTruncated_data(void)
+	{
+		QTest::addColumn<QString>("value");
+		QTest::addColumn<bool>("isTruncated");
+
+		QTest::newRow("string") << "\"abc\"" << false;
+		QTest::newRow("string at the limit") << "\"abcd\"" << false;
+		QTest::newRow("truncated string") << "\"abcd\"..." << true;
+		QTest::newRow("truncated pointed to string") << "0x8000 \"abcd\"..." << true;
+		QTest::newRow("ellipsis in string") << "\"a...b\"" << false;
+		QTest::newRow("ellipsis string") << "\"...\"" << false;
+		QTest::newRow("escaped quotes") << "\"a\\\"...\\\"b\"" << false;
+		QTest::newRow("truncated string with escaped quote") << "\"ab\\\"c\"..." << true;
+		QTest::newRow("truncated string with octal escapes") << "\"\\000\\001\\002\\003\"..." << true;
+		QTest::newRow("ellipsis after too few characters") << "\"ab\"..." << false;
+
+		QTest::newRow("repeated character") << "'x' <repeats 20 times>" << false;
+		QTest::newRow("truncated string parts") << "\"ab\", 'x' <repeats 20 times>..." << true;
+		QTest::newRow("truncated string parts, repeats first") << "'x' <repeats 20 times>, \"cd\"..." << true;
+
+		QTest::newRow("array") << "{1, 2, 3}" << false;
+		QTest::newRow("truncated array") << "{1, 2, 3, 4...}" << true;
+		QTest::newRow("nested arrays") << "{{1, 2}, {3, 4}}" << false;
+		QTest::newRow("truncated nested array") << "{{1, 2, 3, 4...}, {5, 6}}" << true;
+		QTest::newRow("truncated array of arrays") << "{{1, 2}, {3, 4}, {5, 6}, {7, 8}...}" << true;
+		QTest::newRow("repeated elements") << "{0 <repeats 15 times>}" << false;
+		QTest::newRow("truncated array with repeated elements") << "{0 <repeats 15 times>, 1, 2...}" << true;
+		QTest::newRow("character elements") << "{46 '.', 46 '.', 46 '.'}" << false;
+
+		QTest::newRow("array of strings") << "{\"ab\", \"cd\"}" << false;
+		QTest::newRow("array of strings with ellipses") << "{\"a...\", \"b...\"}" << false;
+		QTest::newRow("truncated string in array") << "{\"abcd\"..., \"ef\"}" << true;
+		QTest::newRow("repeated strings") << "{\"ab\" <repeats 5 times>}" << false;
+		QTest::newRow("repeated strings, ellipsis in string") << "{\"ab\" <repeats 5 times>, \"cd\", \"e...\"}" << false;
+		QTest::newRow("truncated array of repeated strings") << "{\"ab\" <repeats 5 times>, \"cd\"...}" << true;
+
+		QTest::newRow("truncated string member") << "{name = \"abcd\"..., id = 1}" << true;
+		QTest::newRow("aggregate nested too deeply") << "{a = {...}, b = 1}" << false;
+		QTest::newRow("aggregates nested too deeply") << "{a = {...}, b = {...}, c = {...}, d = {...}}" << false;
+		QTest::newRow("variadic function") << "{void (int, ...)} 0x8000 <printf>" << false;
+	}
+	void isTruncated(void)
+	{
+		QFETCH(QString, value);
+		QFETCH(bool, isTruncated);
+		QCOMPARE(GdbValue::isTruncated(value, MAX_ELEMENTS, REPEAT_THRESHOLD), isTruncated);
+	}
+};
+
+QTEST_MAIN(GdbValueTest)
+#include "gdb-value-test.moc"
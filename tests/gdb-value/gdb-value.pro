@@ -0,0 +1,16 @@
+QT       += testlib
+QT       -= gui
+
+TARGET = gdb-value-test
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../
+
+SOURCES += \
+	   gdb-value-test.cxx
+
+HEADERS += \
+	   ../../gdb-value.hxx
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <QtTest>
+#include <QDirIterator>
+#include <QRegularExpression>
+
+#include "literal-search.hxx"
+
+/* Checks the literal string search used by the project-wide search against a straightforward reference
+ * implementation, and measures it against the regular expression search, which it replaces for most searches.
+ * The searched corpus is the C and C++ sources checked in this source tree. */
+class LiteralSearchTest : public QObject
+{
+	Q_OBJECT
+private:
+	QByteArray corpus;
+
+	typedef const char * (* FindFunction)(const char *, const char *, const char *, int);
+	static QVector<int> matchingLines(const QByteArray & contents, const QByteArray & literal, bool isWholeWordsOnlySearch,
+					  FindFunction find = LiteralSearch::find)
+	{
+		QVector<int> lines;
+		LiteralSearch::findLines(contents, literal, isWholeWordsOnlySearch,
+					 [&] (int lineNumber, const char *, const char *) -> bool { lines << lineNumber; return true; }, find);
+		return lines;
+	}
+	/* Checks every line, and every position in the line, for a match. */
+	static QVector<int> referenceMatchingLines(const QByteArray & contents, const QByteArray & literal, bool isWholeWordsOnlySearch)
+	{
+		QVector<int> lines;
+		QList<QByteArray> l = contents.split('\n');
+		for (int i = 0; i < l.size(); i ++)
+			for (int p = 0; (p = l.at(i).indexOf(literal, p)) != -1; p ++)
+			{
+				int end = p + literal.length();
+				if (isWholeWordsOnlySearch
+					&& ((p > 0 && LiteralSearch::isWordByte(l.at(i).at(p - 1))) == LiteralSearch::isWordByte(literal.at(0))
+					    || (end < l.at(i).length() && LiteralSearch::isWordByte(l.at(i).at(end)))
+						== LiteralSearch::isWordByte(literal.at(literal.length() - 1))))
+					continue;
+				lines << i + 1;
+				break;
+			}
+		return lines;
+	}
+	/* The strings searched for in the corpus. Most of them start with bytes that are very common in C sources. */
+	static void addSearchedStrings(void)
+	{
+		QTest::addColumn<QByteArray>("literal");
+		QTest::newRow("_t") << QByteArray("_t");
+		QTest::newRow("s") << QByteArray("s");
+		QTest::newRow("static") << QByteArray("static");
+		QTest::newRow("sizeof") << QByteArray("sizeof");
+		QTest::newRow("space if") << QByteArray(" if (");
+		QTest::newRow("_section") << QByteArray("_section");
+		QTest::newRow("PathTable") << QByteArray("PathTable");
+		/* Split, so that this source file does not contain the string searched. */
+		QTest::newRow("not found") << QByteArray("string_that_does_not_").append("occur_in_the_corpus");
+	}
+private slots:
+	void initTestCase(void)
+	{
+		QDirIterator i(SOURCE_TREE_DIRECTORY, QStringList() << "*.c" << "*.h" << "*.cxx" << "*.hxx" << "*.cpp" << "*.hpp",
+			       QDir::Files, QDirIterator::Subdirectories);
+		while (i.hasNext())
+		{
+			QFile f(i.next());
+			if (f.open(QFile::ReadOnly))
+				corpus += f.readAll();
+		}
+		QVERIFY(corpus.size() > 500000);
+	}
+	void findKnownStrings(void)
+	{
+		QCOMPARE(matchingLines("", "a", false), QVector<int>());
+		QCOMPARE(matchingLines("a", "ab", false), QVector<int>());
+		QCOMPARE(matchingLines("ab", "ab", false), QVector<int>() << 1);
+		QCOMPARE(matchingLines("\n\nab", "b", false), QVector<int>() << 3);
+		QCOMPARE(matchingLines("aa aa\naaa\n", "aa", false), QVector<int>() << 1 << 2);
+		QCOMPARE(matchingLines("aa aa\naaa\n", "aa", true), QVector<int>() << 1);
+		QCOMPARE(matchingLines("x_y x\nx(x)", "x", true), QVector<int>() << 1 << 2);
+		QCOMPARE(matchingLines("a->b\na-->b", "->", true), QVector<int>() << 1 << 2);
+		QCOMPARE(matchingLines("axb\naxyb", "axyb", false, LiteralSearch::findByFirstAndLastBytes), QVector<int>() << 2);
+	}
+	void findInCorpus_data(void) { addSearchedStrings(); }
+	void findInCorpus(void)
+	{
+		QFETCH(QByteArray, literal);
+		for (bool isWholeWordsOnlySearch : { false, true })
+		{
+			QVector<int> expected = referenceMatchingLines(corpus, literal, isWholeWordsOnlySearch);
+			QCOMPARE(matchingLines(corpus, literal, isWholeWordsOnlySearch), expected);
+			QCOMPARE(matchingLines(corpus, literal, isWholeWordsOnlySearch, LiteralSearch::findByFirstAndLastBytes), expected);
+		}
+	}
+	void benchmarkLiteralSearch_data(void) { addSearchedStrings(); }
+	void benchmarkLiteralSearch(void)
+	{
+		QFETCH(QByteArray, literal);
+		int lineCount = 0;
+		QBENCHMARK { lineCount = matchingLines(corpus, literal, false).size(); }
+		QCOMPARE(lineCount, referenceMatchingLines(corpus, literal, false).size());
+	}
+	void benchmarkFirstAndLastBytesSearch_data(void) { addSearchedStrings(); }
+	void benchmarkFirstAndLastBytesSearch(void)
+	{
+		QFETCH(QByteArray, literal);
+		int lineCount = 0;
+		QBENCHMARK { lineCount = matchingLines(corpus, literal, false, LiteralSearch::findByFirstAndLastBytes).size(); }
+		QCOMPARE(lineCount, referenceMatchingLines(corpus, literal, false).size());
+	}
+	/* The regular expression search, as done by the project-wide search when the literal search cannot be applied. */
+	void benchmarkRegularExpressionSearch_data(void) { addSearchedStrings(); }
+	void benchmarkRegularExpressionSearch(void)
+	{
+		QFETCH(QByteArray, literal);
+		QRegularExpression rx(QRegularExpression::escape(QString::fromUtf8(literal)));
+		QList<QByteArray> lines = corpus.split('\n');
+		int lineCount = 0;
+		QBENCHMARK
+		{
+			lineCount = 0;
+			for (const auto & line : lines)
+				if (rx.match(line).lastCapturedIndex() != -1)
+					lineCount ++;
+		}
+		QCOMPARE(lineCount, referenceMatchingLines(corpus, literal, false).size());
+	}
+};
+
+QTEST_MAIN(LiteralSearchTest)
+#include "literal-search-test.moc"
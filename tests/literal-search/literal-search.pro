@@ -0,0 +1,19 @@
+QT       += testlib
+QT       -= gui
+
+TARGET = literal-search-test
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../
+
+# The sources checked in this source tree are used as the searched corpus.
+DEFINES += SOURCE_TREE_DIRECTORY=\\\"$$PWD/../..\\\"
+
+SOURCES += \
+	   literal-search-test.cxx
+
+HEADERS += \
+	   ../../literal-search.hxx
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <deque>
+
+#include <QtTest>
+
+#include "live-watch.hxx"
+
+/* Stands in for a target, and for the probe connection to it. Memory read requests from the live watch engine
+ * are queued, and are only completed when asked to, so that the tests control the order of events. */
+class FakeTarget
+{
+private:
+	LiveWatchEngine & engine;
+public:
+	struct Request
+	{
+		unsigned	number;
+		uint32_t	address;
+		uint32_t	length;
+	};
+	const uint32_t	baseAddress;
+	QByteArray	memory;
+	std::deque<struct Request> pendingRequests;
+	/* All read requests issued by the engine, in order. */
+	std::vector<struct Request> requestHistory;
+	bool		isFailingReads = false;
+
+	FakeTarget(LiveWatchEngine & engine, uint32_t baseAddress, int size) : engine(engine), baseAddress(baseAddress)
+	{
+		for (int i = 0; i < size; i ++)
+			memory += (char) (i * 7 + 3);
+		QObject::connect(& engine, & LiveWatchEngine::readMemory, [this] (unsigned number, uint32_t address, uint32_t length) {
+			struct Request r = { number, address, length, };
+			pendingRequests.push_back(r);
+			requestHistory.push_back(r);
+		});
+	}
+	QByteArray contents(uint32_t address, uint32_t length) const { return memory.mid(address - baseAddress, length); }
+	/* Completes the pending read requests, including the ones issued while completing them. */
+	void completePendingReads(void)
+	{
+		while (!pendingRequests.empty())
+		{
+			struct Request r = pendingRequests.front();
+			pendingRequests.pop_front();
+			engine.memoryReadCompleted(r.number, isFailingReads ? QByteArray() : contents(r.address, r.length));
+		}
+	}
+};
+
+class LiveWatchTest : public QObject
+{
+	Q_OBJECT
+private:
+	static std::vector<LiveWatchEngine::MemoryRead> ranges(const std::vector<std::pair<uint32_t, uint32_t>> & addressesAndLengths)
+	{
+		std::vector<LiveWatchEngine::MemoryRead> r;
+		int id = 1;
+		for (const auto & a : addressesAndLengths)
+			r.push_back(LiveWatchEngine::MemoryRead(a.first, a.second, id ++));
+		return r;
+	}
+	static std::vector<int> sorted(std::vector<int> v) { std::sort(v.begin(), v.end()); return v; }
+private slots:
+	void coalesceNearbyRanges(void)
+	{
+		auto reads = LiveWatchEngine::coalesceReads(ranges({ { 0x100, 4 }, { 0x104, 4 }, { 0x120, 4 }, }));
+		QCOMPARE(reads.size(), (size_t) 1);
+		QCOMPARE(reads.at(0).address, (uint32_t) 0x100);
+		QCOMPARE(reads.at(0).length, (uint32_t) 0x24);
+		QCOMPARE(sorted(reads.at(0).watchIds), std::vector<int>({ 1, 2, 3, }));
+	}
+	void coalesceGapLimit(void)
+	{
+		/* Ranges exactly 'MAX_COALESCING_GAP' bytes apart are merged, ranges further apart are not. */
+		auto reads = LiveWatchEngine::coalesceReads(ranges({ { 0x100, 4 }, { 0x104 + LiveWatchEngine::MAX_COALESCING_GAP, 4 }, }));
+		QCOMPARE(reads.size(), (size_t) 1);
+		reads = LiveWatchEngine::coalesceReads(ranges({ { 0x100, 4 }, { 0x104 + LiveWatchEngine::MAX_COALESCING_GAP + 1, 4 }, }));
+		QCOMPARE(reads.size(), (size_t) 2);
+	}
+	void coalesceReadLengthLimit(void)
+	{
+		auto reads = LiveWatchEngine::coalesceReads(ranges({ { 0, 200 }, { 232, 100 }, }));
+		QCOMPARE(reads.size(), (size_t) 2);
+		for (const auto & r : reads)
+			QVERIFY(r.length <= LiveWatchEngine::MAX_READ_LENGTH);
+	}
+	void coalesceUnsortedAndOverlappingRanges(void)
+	{
+		auto reads = LiveWatchEngine::coalesceReads(ranges({ { 0x208, 4 }, { 0x200, 16 }, { 0x204, 4 }, { 0x200, 16 }, }));
+		QCOMPARE(reads.size(), (size_t) 1);
+		QCOMPARE(reads.at(0).address, (uint32_t) 0x200);
+		QCOMPARE(reads.at(0).length, (uint32_t) 16);
+		QCOMPARE(sorted(reads.at(0).watchIds), std::vector<int>({ 1, 2, 3, 4, }));
+	}
+	void coalesceAtTopOfAddressSpace(void)
+	{
+		auto reads = LiveWatchEngine::coalesceReads(ranges({ { 0xfffffff0, 16 }, { 0xffffffc0, 4 }, }));
+		QCOMPARE(reads.size(), (size_t) 1);
+		QCOMPARE(reads.at(0).address, (uint32_t) 0xffffffc0);
+		QCOMPARE(reads.at(0).length, (uint32_t) 0x40);
+	}
+	void sampleRingKeepsLatestSamples(void)
+	{
+		LiveWatchSampleRing ring(3);
+		for (int i = 0; i < 5; i ++)
+			ring.push(i, QByteArray(1, (char) i));
+		QCOMPARE(ring.size(), (size_t) 3);
+		QCOMPARE(ring.at(0).timestamp, (qint64) 2);
+		QCOMPARE(ring.latest().data, QByteArray(1, (char) 4));
+	}
+	void samplingRoundReadsAllWatches(void)
+	{
+		LiveWatchEngine engine;
+		FakeTarget target(engine, 0x20000000, 0x1000);
+		int a = engine.addWatch("a"), b = engine.addWatch("b"), c = engine.addWatch("c"), unresolved = engine.addWatch("d");
+		engine.setWatchAddress(a, 0x20000010), engine.setWatchSize(a, 4);
+		engine.setWatchAddress(b, 0x20000018), engine.setWatchSize(b, 2);
+		engine.setWatchAddress(c, 0x20000800), engine.setWatchSize(c, 8);
+		engine.setWatchAddress(unresolved, 0x20000020);
+		QSignalSpy samplesUpdated(& engine, & LiveWatchEngine::samplesUpdated);
+
+		engine.sampleOnce();
+		/* The reads of a round are issued one at a time. */
+		QCOMPARE(target.pendingRequests.size(), (size_t) 1);
+		target.completePendingReads();
+
+		QCOMPARE(target.requestHistory.size(), (size_t) 2);
+		QCOMPARE(engine.statistics().readsPerRound, 2u);
+		QCOMPARE(engine.statistics().completedRounds, 1u);
+		QCOMPARE(samplesUpdated.count(), 1);
+		for (const auto & w : engine.watches())
+			if (w.id == unresolved)
+				QCOMPARE(w.samples.size(), (size_t) 0);
+			else
+			{
+				QCOMPARE(w.samples.size(), (size_t) 1);
+				QCOMPARE(w.samples.latest().data, target.contents(w.address, w.size));
+			}
+	}
+	void failedReadsAreCounted(void)
+	{
+		LiveWatchEngine engine;
+		FakeTarget target(engine, 0x1000, 0x100);
+		int a = engine.addWatch("a");
+		engine.setWatchAddress(a, 0x1010), engine.setWatchSize(a, 4);
+		target.isFailingReads = true;
+		engine.sampleOnce();
+		target.completePendingReads();
+		QCOMPARE(engine.statistics().failedReads, 1u);
+		QCOMPARE(engine.statistics().completedRounds, 1u);
+		QCOMPARE(engine.watches().at(0).samples.size(), (size_t) 0);
+	}
+	void staleCompletionsAreIgnored(void)
+	{
+		LiveWatchEngine engine;
+		FakeTarget target(engine, 0x1000, 0x100);
+		int a = engine.addWatch("a");
+		engine.setWatchAddress(a, 0x1010), engine.setWatchSize(a, 4);
+		engine.sampleOnce();
+		engine.stopSampling();
+		/* The round has been abandoned, its completion must be ignored. */
+		target.completePendingReads();
+		QCOMPARE(engine.watches().at(0).samples.size(), (size_t) 0);
+		QCOMPARE(engine.statistics().completedRounds, 0u);
+
+		engine.sampleOnce();
+		QCOMPARE(target.pendingRequests.size(), (size_t) 1);
+		engine.memoryReadCompleted(target.pendingRequests.front().number + 1, target.contents(0x1010, 4));
+		QCOMPARE(engine.watches().at(0).samples.size(), (size_t) 0);
+		target.completePendingReads();
+		QCOMPARE(engine.watches().at(0).samples.size(), (size_t) 1);
+	}
+	void watchRemovedDuringRound(void)
+	{
+		LiveWatchEngine engine;
+		FakeTarget target(engine, 0x1000, 0x100);
+		int a = engine.addWatch("a"), b = engine.addWatch("b");
+		engine.setWatchAddress(a, 0x1010), engine.setWatchSize(a, 4);
+		engine.setWatchAddress(b, 0x1014), engine.setWatchSize(b, 4);
+		engine.sampleOnce();
+		engine.removeWatch(a);
+		target.completePendingReads();
+		QCOMPARE(engine.watches().size(), (size_t) 1);
+		QCOMPARE(engine.watches().at(0).samples.size(), (size_t) 1);
+		/* The read plan is recomputed for the next round. */
+		engine.sampleOnce();
+		QCOMPARE(target.pendingRequests.back().address, (uint32_t) 0x1014);
+		QCOMPARE(target.pendingRequests.back().length, (uint32_t) 4);
+		target.completePendingReads();
+	}
+	void overlappingRoundsAreSkipped(void)
+	{
+		LiveWatchEngine engine;
+		FakeTarget target(engine, 0x1000, 0x100);
+		int a = engine.addWatch("a");
+		engine.setWatchAddress(a, 0x1010), engine.setWatchSize(a, 4);
+		engine.setSampleRate(1000);
+		engine.startSampling();
+		/* The target does not reply, no new rounds must be started while the first one is pending. */
+		QTest::qWait(50);
+		QCOMPARE(target.requestHistory.size(), (size_t) 1);
+		QVERIFY(engine.statistics().skippedRounds > 0);
+		target.completePendingReads();
+		QCOMPARE(engine.statistics().completedRounds, 1u);
+		QTRY_VERIFY(engine.statistics().completedRounds > 1 || target.pendingRequests.size());
+		engine.stopSampling();
+		QVERIFY(!engine.isSamplingActive());
+	}
+};
+
+QTEST_MAIN(LiveWatchTest)
+#include "live-watch-test.moc"
@@ -0,0 +1,16 @@
+QT       += testlib
+QT       -= gui
+
+TARGET = live-watch-test
+TEMPLATE = app
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../
+
+SOURCES += \
+	   live-watch-test.cxx
+
+HEADERS += \
+	   ../../live-watch.hxx
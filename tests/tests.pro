@@ -0,0 +1,14 @@
+# Tests for the parts of the frontend that can be checked without a debug probe, or a target.
+#
+# To build and run the tests from the command line:
+#	qmake ../turbo/tests/tests.pro
+#	make
+#	make check
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+	   gdb-remote \
+	   gdb-value \
+	   literal-search \
+	   live-watch
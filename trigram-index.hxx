@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 Stoyan Shopov <stoyan.shopov@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+
+#include "file-id.hxx"
+
+/* A trigram index over the contents of a set of files. For each sequence of three bytes that
+ * occurs in any of the indexed files, a sorted list (a posting list) of the files that contain
+ * this trigram is maintained. When searching for a string, only the files that contain all of
+ * the trigrams of the searched string can possibly contain a match, so that only these
+ * candidate files need to be scanned for exact matches.
+ *
+ * Searches are performed line by line, so trigrams that span multiple lines are not indexed.
+ *
+ * Files are identified by their global file ids (see 'PathTable'), and only files that have been
+ * registered in the index are searched. */
+class TrigramIndex
+{
+private:
+	struct FileData
+	{
+		QString fileName;
+		bool isRegistered = false;
+		bool isIndexed = false;
+	};
+	/* Indexed by file id. */
+	std::vector<struct FileData> files;
+	int registeredFileCount = 0;
+	std::unordered_map<uint32_t /* trigram */, std::vector<int /* file id */>> postings;
+
+	static bool isIndexedCharacter(char c) { return c != '\n' && c != '\r'; }
+	static std::vector<uint32_t> trigrams(const QByteArray & data)
+	{
+		std::vector<uint32_t> result;
+		const unsigned char * p = (const unsigned char *) data.constData();
+		int i, length = data.length();
+		for (i = 0; i + 2 < length; i ++)
+		{
+			if (!isIndexedCharacter(p[i]) || !isIndexedCharacter(p[i + 1]) || !isIndexedCharacter(p[i + 2]))
+				continue;
+			result.push_back((p[i] << 16) | (p[i + 1] << 8) | p[i + 2]);
+		}
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
+		return result;
+	}
+public:
+	/* Registers a file in the index, if not already registered. Returns true, if the file was newly registered.
+	 * Newly registered files are not indexed - call 'indexFile()' for them. */
+	bool registerFile(FileId fileId, const QString & fileName)
+	{
+		if (fileId >= files.size())
+			files.resize(fileId + 1);
+		if (files.at(fileId).isRegistered)
+			return false;
+		files.at(fileId).fileName = fileName;
+		files.at(fileId).isRegistered = true;
+		registeredFileCount ++;
+		return true;
+	}
+	bool isFileRegistered(FileId fileId) const { return fileId < files.size() && files.at(fileId).isRegistered; }
+	const QString & fileName(int fileId) const { return files.at(fileId).fileName; }
+	bool isFileIndexed(int fileId) const { return files.at(fileId).isIndexed; }
+	int fileCount(void) const { return registeredFileCount; }
+	/* File ids of registered files are below this limit. */
+	int fileIdLimit(void) const { return files.size(); }
+
+	void indexFile(int fileId, const QByteArray & contents)
+	{
+		if (files.at(fileId).isIndexed)
+			removeFile(fileId);
+		for (const auto & t : trigrams(contents))
+		{
+			std::vector<int> & p = postings[t];
+			/* Files are usually indexed in the order of their ids, in which case a plain append keeps
+			 * the posting list sorted. */
+			if (p.empty() || p.back() < fileId)
+				p.push_back(fileId);
+			else
+				p.insert(std::lower_bound(p.begin(), p.end(), fileId), fileId);
+		}
+		files.at(fileId).isIndexed = true;
+	}
+	/* Removes a file from all posting lists. The file stays registered, but is marked as not indexed. */
+	void removeFile(int fileId)
+	{
+		if (!files.at(fileId).isIndexed)
+			return;
+		for (auto i = postings.begin(); i != postings.end();)
+		{
+			std::vector<int> & p = i->second;
+			auto f = std::lower_bound(p.begin(), p.end(), fileId);
+			if (f != p.end() && * f == fileId)
+				p.erase(f);
+			if (p.empty())
+				i = postings.erase(i);
+			else
+				i ++;
+		}
+		files.at(fileId).isIndexed = false;
+	}
+	/* Computes the ids of the files that may contain the pattern passed, in ascending order.
+	 * Files that are not indexed are always considered candidates. Returns false, if the pattern is
+	 * too short to be looked up in the index - in this case, all registered files are candidates. */
+	bool candidateFiles(const QByteArray & pattern, std::vector<int> & candidates) const
+	{
+		candidates.clear();
+		std::vector<uint32_t> patternTrigrams = trigrams(pattern);
+		if (patternTrigrams.empty())
+		{
+			for (int i = 0; i < (int) files.size(); i ++)
+				if (files.at(i).isRegistered)
+					candidates.push_back(i);
+			return false;
+		}
+		/* Intersect the posting lists, starting with the shortest one. */
+		std::vector<const std::vector<int> *> lists;
+		for (const auto & t : patternTrigrams)
+		{
+			auto p = postings.find(t);
+			if (p == postings.cend())
+			{
+				lists.clear();
+				break;
+			}
+			lists.push_back(& p->second);
+		}
+		if (!lists.empty())
+		{
+			std::sort(lists.begin(), lists.end(), [] (const std::vector<int> * a, const std::vector<int> * b) -> bool { return a->size() < b->size(); });
+			candidates = * lists.at(0);
+			for (int i = 1; i < (int) lists.size() && !candidates.empty(); i ++)
+			{
+				std::vector<int> t;
+				std::set_intersection(candidates.cbegin(), candidates.cend(), lists.at(i)->cbegin(), lists.at(i)->cend(), std::back_inserter(t));
+				candidates.swap(t);
+			}
+		}
+		std::vector<int> unindexedFiles;
+		for (int i = 0; i < (int) files.size(); i ++)
+			if (files.at(i).isRegistered && !files.at(i).isIndexed)
+				unindexedFiles.push_back(i);
+		if (!unindexedFiles.empty())
+		{
+			std::vector<int> t;
+			std::set_union(candidates.cbegin(), candidates.cend(), unindexedFiles.cbegin(), unindexedFiles.cend(), std::back_inserter(t));
+			candidates.swap(t);
+		}
+		return true;
+	}
+};
@@ -23,6 +23,10 @@
 #ifndef GDBREMOTE_HXX
 #define GDBREMOTE_HXX
 
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+
 #include <QByteArray>
 #include <QString>
 #include <QVector>
@@ -30,54 +34,272 @@
 #include <QDebug>
 #include "util.hxx"
 
+/* Extracts gdb remote protocol packets from a stream of received bytes.
+ *
+ * Received byte arrays are queued as they are - they are implicitly shared with the caller, and are not
+ * copied. The queued bytes are processed by a state machine, which keeps its state across byte arrays, so
+ * packets may be split across any number of byte arrays. In a single pass over the received bytes, packet
+ * boundaries are found, the packet payload is unescaped and run-length decoded, and the packet checksum is
+ * computed and verified. The payload is the only copy of the packet bytes made - unescaping and run-length
+ * decoding rewrite the payload, so it cannot be referenced in the received bytes. Runs of bytes that need
+ * no decoding are copied to the payload at once. Bytes outside of packets (e.g. acknowledgements) are
+ * skipped. A start-of-packet character anywhere in a packet restarts the packet, so that the framer
+ * resynchronizes after corrupted data. */
+class GdbRemotePacketFramer
+{
+public:
+	enum
+	{
+		/* Packets with larger payloads are considered corrupted, and are discarded. */
+		MAX_PAYLOAD_SIZE	= 256 * 1024,
+	};
+private:
+	enum STATE
+	{
+		WAIT_PACKET_START = 0,
+		PAYLOAD,
+		ESCAPED_BYTE,
+		REPEAT_COUNT,
+		CHECKSUM_HIGH_DIGIT,
+		CHECKSUM_LOW_DIGIT,
+	};
+	/* The received byte arrays, that have not yet been completely processed, and the number of bytes
+	 * already processed in the first of them. */
+	std::deque<QByteArray> chunks;
+	int		chunkOffset = 0;
+	int		bufferedBytes = 0;
+
+	enum STATE	state = WAIT_PACKET_START;
+	QByteArray	data;
+	uint8_t		computedChecksum = 0;
+	uint8_t		receivedChecksum = 0;
+	bool		isReceivedChecksumValid = false;
+
+	static int hexDigitValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
+	}
+	static bool isSpecialPayloadByte(char c) { return c == '#' || c == '$' || c == '}' || c == '*'; }
+	void startPacket(void) { data.resize(0); computedChecksum = 0; state = PAYLOAD; }
+	/* Processes the bytes of a byte array, starting at 'offset', until a packet is complete, or until the end
+	 * of the byte array. Returns the offset of the first unprocessed byte, and sets 'isPacketComplete'. */
+	int process(const char * bytes, int offset, int length, bool & isPacketComplete)
+	{
+		isPacketComplete = false;
+		while (offset < length)
+		{
+			if (state == PAYLOAD)
+			{
+				/* Copy the run of bytes that need no decoding at once. */
+				int i = offset;
+				uint8_t sum = computedChecksum;
+				while (i < length && !isSpecialPayloadByte(bytes[i]))
+					sum += bytes[i ++];
+				if (i != offset)
+				{
+					data.append(bytes + offset, i - offset);
+					computedChecksum = sum;
+					offset = i;
+					if (data.size() > MAX_PAYLOAD_SIZE)
+					{
+						state = WAIT_PACKET_START, data.resize(0);
+						continue;
+					}
+					if (offset == length)
+						break;
+				}
+			}
+			char c = bytes[offset ++];
+			/* The start-of-packet character never appears inside valid packets, in any state. */
+			if (c == '$')
+			{
+				startPacket();
+				continue;
+			}
+			switch (state)
+			{
+			case WAIT_PACKET_START:
+				break;
+			case PAYLOAD:
+				if (c == '#')
+					state = CHECKSUM_HIGH_DIGIT;
+				else
+				{
+					computedChecksum += c;
+					if (c == '}')
+						state = ESCAPED_BYTE;
+					else if (c == '*' && data.size())
+						state = REPEAT_COUNT;
+					else
+						data.append(c);
+				}
+				break;
+			case ESCAPED_BYTE:
+				computedChecksum += c;
+				data.append((char) (c ^ 0x20));
+				state = PAYLOAD;
+				break;
+			case REPEAT_COUNT:
+				computedChecksum += c;
+				/* The repeat count is encoded as the number of repetitions of the previous byte, plus 29. */
+				if ((uint8_t) c > 29)
+					data.append(QByteArray((uint8_t) c - 29, data.at(data.size() - 1)));
+				state = PAYLOAD;
+				break;
+			case CHECKSUM_HIGH_DIGIT:
+			{
+				int x = hexDigitValue(c);
+				isReceivedChecksumValid = x != -1;
+				receivedChecksum = (x & 15) << 4;
+				state = CHECKSUM_LOW_DIGIT;
+				break;
+			}
+			case CHECKSUM_LOW_DIGIT:
+			{
+				int x = hexDigitValue(c);
+				isReceivedChecksumValid = isReceivedChecksumValid && x != -1;
+				receivedChecksum |= x & 15;
+				state = WAIT_PACKET_START;
+				isPacketComplete = true;
+				return offset;
+			}
+			}
+			if (data.size() > MAX_PAYLOAD_SIZE)
+				state = WAIT_PACKET_START, data.resize(0);
+		}
+		return offset;
+	}
+public:
+	void append(const QByteArray & bytes) { if (bytes.size()) chunks.push_back(bytes), bufferedBytes += bytes.size(); }
+	void reset(void) { chunks.clear(); chunkOffset = bufferedBytes = 0; state = WAIT_PACKET_START; data.resize(0); }
+	/* Processes the buffered bytes, until a complete packet is found. Returns true if a packet has been found,
+	 * its payload is then available via 'payload()', and the validity of its checksum via 'isChecksumValid()'.
+	 * Returns false if there are no more complete packets in the buffered bytes. */
+	bool nextPacket(void)
+	{
+		while (!chunks.empty())
+		{
+			const QByteArray & chunk = chunks.front();
+			bool isPacketComplete;
+			int offset = process(chunk.constData(), chunkOffset, chunk.size(), isPacketComplete);
+			bufferedBytes -= offset - chunkOffset;
+			if (offset == chunk.size())
+				chunks.pop_front(), chunkOffset = 0;
+			else
+				chunkOffset = offset;
+			if (isPacketComplete)
+				return true;
+		}
+		return false;
+	}
+	/* The unescaped, and run-length decoded, payload of the last packet found. */
+	const QByteArray & payload(void) const { return data; }
+	bool isChecksumValid(void) const { return isReceivedChecksumValid && receivedChecksum == computedChecksum; }
+	int bufferedByteCount(void) const { return bufferedBytes; }
+};
+
 class GdbRemote
 {
 private:
-	static QByteArray escape(QByteArray data) { return data.replace('}', "}]").replace('#', "}\003").replace('$', "}\004"); }
-	static QByteArray unescape(QByteArray data) { int i; for (i = 0; i < data.length(); i ++) if (data[i] == '}') data.remove(i, 1), data[i] = data[i] ^ ' '; return data; }
-	static int checksum(const QByteArray & data) { int i, x; for (i = x = 0; i < data.length(); x += data[i ++]); return x & 0xff; }
-	static QByteArray strip(const QByteArray & packet) { return packet.mid(1, packet.length() - 4); }
-	static QByteArray makePacket(const QByteArray & data) { return QByteArray("$") + escape(data) + "#" + QString("%1").arg(checksum(escape(data)), 2, 16, QChar('0')).toLocal8Bit(); }
+	static QByteArray makePacket(const QByteArray & data) { return encodePacket(data); }
 public:
-	static QByteArray extractPacket(QByteArray & bytes)
+	/* Builds a packet for a payload, in a single pass over the payload - the payload bytes are escaped, the
+	 * packet checksum is computed, and, if requested, runs of repeated bytes are run-length encoded. Only
+	 * replies sent to gdb may be run-length encoded, requests must not be. */
+	static QByteArray encodePacket(const QByteArray & payload, bool isRunLengthEncoded = false)
 	{
-		/* Sanity check - if the first character of the data is not a start-of-packet character,
-		 * that means the communication has gone out of sync - this case must be handled by
-		 * the caller. */
-		if (bytes.size() && bytes.at(0) != '$')
-			Util::panic();
-		QRegularExpression rx("^\\$.*#..", QRegularExpression::InvertedGreedinessOption);
-		QRegularExpressionMatch match;
-		if ((match = rx.match(bytes)).hasMatch())
+		const char * hexDigits = "0123456789abcdef";
+		const char * p = payload.constData();
+		int length = payload.size();
+		QByteArray packet;
+		/* Escaping normally expands the payload only slightly. */
+		packet.reserve(length + (length >> 4) + 4);
+		packet.append('$');
+		uint8_t sum = 0;
+		for (int i = 0; i < length;)
 		{
-			bytes.remove(0, match.capturedEnd());
-			return match.captured().toLocal8Bit();
+			char c = p[i];
+			if (c == '$' || c == '#' || c == '}' || c == '*')
+			{
+				packet.append('}');
+				packet.append((char) (c ^ 0x20));
+				sum += '}' + (c ^ 0x20);
+				i ++;
+				continue;
+			}
+			packet.append(c);
+			sum += c;
+			int repeats = 0;
+			if (isRunLengthEncoded)
+				/* The repeat count is encoded as a printable character, with a value of the count plus 29,
+				 * which must not exceed 126, so at most 97 repetitions can be encoded at once. */
+				while (i + 1 + repeats < length && p[i + 1 + repeats] == c && repeats < 97)
+					repeats ++;
+			/* Counts of 6 and 7 would be encoded as the '#' and '$' characters, which are not allowed. */
+			if (repeats == 6 || repeats == 7)
+				repeats = 5;
+			/* Encoding fewer than 3 repetitions does not make the packet shorter. */
+			if (repeats >= 3)
+			{
+				packet.append('*');
+				packet.append((char) (repeats + 29));
+				sum += '*' + repeats + 29;
+				i += repeats;
+			}
+			i ++;
 		}
-		return QByteArray();
+		packet.append('#');
+		packet.append(hexDigits[sum >> 4]);
+		packet.append(hexDigits[sum & 15]);
+		return packet;
 	}
-	static bool isValidPacket(const QByteArray & packet)
+	/* Decodes a single, complete, packet with the packet framer. Returns false if the packet is not valid,
+	 * otherwise 'payload' is set to the unescaped, and run-length decoded, packet payload. */
+	static bool decodePacket(const QByteArray & packet, QByteArray & payload)
 	{
-		bool ok; int l; int c;
-		return ((l = packet.length()) < 4 || packet[0] != '$' || packet[l - 3] != '#' || (c = packet.mid(l - 2).toInt(& ok, 16), ! ok)
-			|| c != checksum(packet.mid(1, l - 4))) ? false : true;
+		GdbRemotePacketFramer framer;
+		framer.append(packet);
+		if (!packet.startsWith('$') || !framer.nextPacket() || !framer.isChecksumValid() || framer.bufferedByteCount())
+			return false;
+		payload = framer.payload();
+		return true;
 	}
-	static int errorCode(const QByteArray & reply) { if (!isValidPacket(reply) || reply.length() != 7 || reply[1] != 'E') return -1; return (reply.mid(2, 2).toInt(0, 16)); }
+	static bool isValidPacket(const QByteArray & packet) { QByteArray payload; return decodePacket(packet, payload); }
+	static int errorCode(const QByteArray & reply) { QByteArray p = packetData(reply); if (p.length() != 3 || p[0] != 'E') return -1; return (p.mid(1, 2).toInt(0, 16)); }
 	static bool isErrorResponse(const QByteArray & reply) { return errorCode(reply) != -1
 		||	/* failed monitor commands as of now (29072017) return a single 'E' character packet, without an error code...
 			 * maybe this should be fixed in the blackmagic probe? special-case this case here... */
 				packetData(reply) == "E"; }
-	static bool isOkResponse(const QByteArray & data) { return data.toLower().operator ==(makePacket("OK").toLower()); }
+	static bool isOkResponse(const QByteArray & data) { return packetData(data) == "OK"; }
 	static bool isTargetStopReplyPacket(const QByteArray & data)
 	{
 		QByteArray p = packetData(data);
 		return ((p.size() && p.at(0) == 'T') ? true : false);
 	}
-	static bool isEmptyResponse(const QByteArray & data) { return data.toLower().operator ==(makePacket("").toLower()); }
-	static QByteArray packetData(const QByteArray & packet) { if (isValidPacket(packet)) return strip(packet); return QByteArray(); }
+	static bool isEmptyResponse(const QByteArray & data) { QByteArray payload; return decodePacket(data, payload) && payload.isEmpty(); }
+	static QByteArray packetData(const QByteArray & packet) { QByteArray payload; if (decodePacket(packet, payload)) return payload; return QByteArray(); }
 	static QByteArray monitorRequest(const QString & request) { return makePacket((QByteArray("qRcmd,") + request.toLocal8Bit().toHex())); }
 	static QByteArray readRegistersRequest(void) { return makePacket("g"); }
 	static QByteArray attachRequest(void) { return makePacket("vAttach;1"); }
 	static QByteArray memoryMapReadRequest(void) { return makePacket("qXfer:memory-map:read::0,400"); }
+	static QByteArray memoryMapReadRequest(uint32_t offset, uint32_t length) { return makePacket(QString("qXfer:memory-map:read::%1,%2").arg(offset, 0, 16).arg(length, 0, 16).toLocal8Bit()); }
+	static QByteArray crcRequest(uint32_t address, uint32_t length) { return makePacket(QString("qCRC:%1,%2").arg(address, 0, 16).arg(length, 0, 16).toLocal8Bit()); }
+	/* returns false if the reply is not a valid reply to a 'qCRC' request */
+	static bool crcReply(const QByteArray & reply, uint32_t & crc)
+	{
+		QByteArray p = packetData(reply);
+		bool ok;
+		if (p.length() < 2 || p.at(0) != 'C')
+			return false;
+		crc = p.mid(1).toUInt(& ok, 16);
+		return ok;
+	}
 	static QByteArray singleStepRequest(void) { return makePacket("s"); }
 	static QByteArray continueRequest(void) { return makePacket("c"); }
 	static QByteArray resetRequest(void) { return makePacket("r"); }
@@ -85,9 +307,9 @@ public:
 	static QByteArray removeHardwareBreakpointRequest(uint32_t address, int length) { return makePacket(QString("z1,%1,%2").arg(address, 0, 16).arg(length).toLocal8Bit()); }
 	static QByteArray memoryMapReadData(const QByteArray & reply)
 	{
-		if (!isValidPacket(reply))
+		QByteArray x;
+		if (!decodePacket(reply, x))
 			Util::panic();
-		auto x = strip(reply);
 		if (!x.length() || x[0] != 'm')
 			Util::panic();
 		return x.mid(1);
@@ -95,9 +317,9 @@ public:
 	static QVector<uint32_t> readRegisters(const QByteArray & reply)
 	{
 		QVector<uint32_t> registers;
-		if (!isValidPacket(reply)) Util::panic();
+		QByteArray x;
+		if (!decodePacket(reply, x)) Util::panic();
 		int i;
-		auto x = strip(reply);
 		if (x.length() & 7) Util::panic();
 		for (i = 0; i < x.length() >> 3; i ++)
 		{
@@ -126,7 +348,7 @@ public:
 		int i;
 		for (i = 0; i < reply.size(); i ++)
 		{
-			if (reply[i][0] == 'E')
+			if (isErrorResponse(reply[i]))
 				return QByteArray();
 			data += QByteArray::fromHex(packetData(reply[i]));
 		}
@@ -149,7 +371,7 @@ public:
 
 
 	/* GDB response packets. Used when running a gdbserver, these are responses returned to an external gdb client */
-	static QByteArray rawResponsePacket(const QString& rawData) { return makePacket(rawData.toLocal8Bit()); }
+	static QByteArray rawResponsePacket(const QString& rawData) { return encodePacket(rawData.toLocal8Bit(), true); }
 	static QByteArray emptyResponsePacket(void) { return makePacket(""); }
 	static QByteArray okResponsePacket(void) { return makePacket("OK"); }
 	static QByteArray stopReplySignalNumberPacket(int signal_number) { return makePacket(QString("T%1").arg(signal_number & 0xff, 2, 16, QChar('0')).toUpper().toLocal8Bit()); }
@@ -68,9 +68,8 @@ GdbServer::GdbServer(Target *target)
 	connect(& gdb_tcpserver, SIGNAL(newConnection()), this, SLOT(newConneciton()));
 }
 
-void GdbServer::handleGdbPacket(const QByteArray &packet)
+void GdbServer::handleGdbPacket(const QByteArray &pd)
 {
-	auto pd = GdbRemote::packetData(packet);
 	if (pd.startsWith("qSupported"))
 		sendGdbReply(GdbRemote::rawResponsePacket("qXfer:features:read+"));
 	else if (pd.startsWith("!"))
@@ -136,7 +135,7 @@ void GdbServer::handleGdbPacket(const QByteArray &packet)
 	}
 	else
 	{
-		qDebug() << "Unhandled gdb remote packet:" << packet;
+		qDebug() << "Unhandled gdb remote packet:" << pd;
 		sendGdbReply(GdbRemote::emptyResponsePacket());
 	}
 }
@@ -145,26 +144,26 @@ void GdbServer::newConneciton(void)
 {
 	qDebug() << "gdb client connected";
 	gdb_client_socket = gdb_tcpserver.nextPendingConnection();
+	packetFramer.reset();
 	connect(gdb_client_socket, &QTcpSocket::disconnected, [&] { gdb_client_socket->disconnect(); gdb_client_socket = 0; qDebug() << "gdb client disconnected"; });
 	connect(gdb_client_socket, SIGNAL(readyRead()), this, SLOT(gdbClientSocketReadyRead()));
 }
 
 void GdbServer::gdbClientSocketReadyRead(void)
 {
-	incoming_data += gdb_client_socket->readAll();
-	QByteArray packet;
-	while ((packet = GdbRemote::extractPacket(incoming_data)).length())
+	packetFramer.append(gdb_client_socket->readAll());
+	while (packetFramer.nextPacket())
 	{
-		qDebug() << "Received gdb packet:" << packet;
-		if (!GdbRemote::isValidPacket(packet))
+		qDebug() << "Received gdb packet:" << packetFramer.payload();
+		if (!packetFramer.isChecksumValid())
 		{
-			qDebug() << "Invalid gdb packet received:" << packet;
+			qDebug() << "Invalid gdb packet received:" << packetFramer.payload();
 			gdb_client_socket->write("-");
 		}
 		else
 		{
 			gdb_client_socket->write("+");
-			handleGdbPacket(packet);
+			handleGdbPacket(packetFramer.payload());
 		}
 	}
 }
@@ -46,8 +46,8 @@ private:
 	Target		* target;
 	QTcpServer	gdb_tcpserver;
 	QTcpSocket	* gdb_client_socket = 0;
-	QByteArray	incoming_data;
-	void		handleGdbPacket(const QByteArray& packet);
+	GdbRemotePacketFramer	packetFramer;
+	void		handleGdbPacket(const QByteArray& pd);
 	void		sendGdbReply(const QByteArray& packet) { qDebug() << "Sending reply:" << packet; gdb_client_socket->write(packet); }
 	static const QByteArray cortexmTargetDescriptionXml;
 private slots:
@@ -28,6 +28,8 @@
 #include <QDebug>
 #include <QXmlStreamReader>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "util.hxx"
 
@@ -47,12 +49,10 @@ enum TARGET_ERROR_ENUM
 	MEMORY_READ_ERROR,
 };
 
-class Target : public QObject
+/* the memory areas of a target, as described by the target memory map xml document (i.e., the reply of
+ * the gdb 'qXfer:memory-map:read' request); this is usable without a connection to the target */
+class TargetMemoryAreas
 {
-	Q_OBJECT
-signals:
-	void targetHalted(enum TARGET_HALT_REASON reason);
-	void targetRunning(void);
 public:
 	struct ram_area
 	{
@@ -65,19 +65,6 @@ public:
 		uint32_t	length;
 		unsigned	blocksize;
 	};
-	virtual uint32_t readWord(uint32_t address) = 0;
-	virtual bool reset(void) = 0;
-	virtual QByteArray readBytes(uint32_t address, int byte_count, bool is_failure_allowed = false) = 0;
-	virtual uint32_t readRawUncachedRegister(uint32_t register_number) = 0;
-	virtual bool breakpointSet(uint32_t address, int length) = 0;
-	virtual bool breakpointClear(uint32_t address, int length) = 0;
-	virtual void requestSingleStep(void) = 0;
-	virtual bool resume(void) = 0;
-	virtual bool requestHalt(void) = 0;
-	virtual bool connect(void) = 0;
-	virtual uint32_t haltReason(void) = 0;
-	virtual QByteArray memoryMap(void) = 0;
-	virtual bool syncFlash(const Memory & memory_contents) = 0;
 	void parseMemoryAreas(const QString & xml_memory_description)
 	{
 		uint32_t start, length;
@@ -125,7 +112,8 @@ public:
 			qDebug() << flash_areas[i].start << flash_areas[i].length;
 		std::sort(flash_areas.begin(), flash_areas.end(), compare_memory_areas);
 	}
-	/* if the memory range passed does not fit entirely in flash memory, an empty vector is returned */
+	/* if the memory range passed does not fit entirely in flash memory, an empty vector is returned;
+	 * the returned ranges are expanded to flash block boundaries */
 	std::vector<std::pair<uint32_t /* start address in flash */, uint32_t /* length of flash area */> > flashAreasForRange(uint32_t address, uint32_t length)
 	{
 		int i;
@@ -137,16 +125,24 @@ public:
 				ranges.push_back(std::pair<uint32_t, uint32_t>(address, x));
 				address += x;
 				length -= x;
-				x = ((ranges[i].first - flash_areas[i].start) % flash_areas[i].blocksize);
-				ranges[i].first -= x;
-				ranges[i].second += x;
+				x = ((ranges.back().first - flash_areas[i].start) % flash_areas[i].blocksize);
+				ranges.back().first -= x;
+				ranges.back().second += x;
 				x = flash_areas[i].blocksize;
-				ranges[i].second += (x - (ranges[i].second % x)) % x;
+				ranges.back().second += (x - (ranges.back().second % x)) % x;
 			}
 		if (length)
 			ranges.clear();
 		return ranges;
 	}
+	/* returns the flash block size for an address, or 0 if the address is not in flash memory */
+	unsigned flashBlockSize(uint32_t address) const
+	{
+		for (const auto & f : flash_areas)
+			if (f.start <= address && address - f.start < f.length)
+				return f.blocksize;
+		return 0;
+	}
 protected:
 	std::vector<struct ram_area> ram_areas;
 	std::vector<struct flash_area> flash_areas;
@@ -154,4 +150,26 @@ private:
 	static bool compare_memory_areas(const struct flash_area & first, const struct flash_area & second) { return first.start < second.start; }
 };
 
+class Target : public QObject, public TargetMemoryAreas
+{
+	Q_OBJECT
+signals:
+	void targetHalted(enum TARGET_HALT_REASON reason);
+	void targetRunning(void);
+public:
+	virtual uint32_t readWord(uint32_t address) = 0;
+	virtual bool reset(void) = 0;
+	virtual QByteArray readBytes(uint32_t address, int byte_count, bool is_failure_allowed = false) = 0;
+	virtual uint32_t readRawUncachedRegister(uint32_t register_number) = 0;
+	virtual bool breakpointSet(uint32_t address, int length) = 0;
+	virtual bool breakpointClear(uint32_t address, int length) = 0;
+	virtual void requestSingleStep(void) = 0;
+	virtual bool resume(void) = 0;
+	virtual bool requestHalt(void) = 0;
+	virtual bool connect(void) = 0;
+	virtual uint32_t haltReason(void) = 0;
+	virtual QByteArray memoryMap(void) = 0;
+	virtual bool syncFlash(const Memory & memory_contents) = 0;
+};
+
 #endif // TARGET_H
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui network serialport
+QT       += core gui network serialport concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -34,28 +34,52 @@ CONFIG += c++11
 SOURCES += \
 	   bmpdetect.cxx \
 	   clex/cscanner.cxx \
+	   identifier-index.cxx \
 	   mainwindow.cxx \
 	   main.cxx \
 	   ./troll/gdbserver.cxx \
 	   ./troll/target-corefile.cxx \
+	   path-resolver.cxx \
 	   source-files-cache.cxx \
+	   svd-image.cxx \
+	   svd-snapshot.cxx \
 	   svdfileparser.cxx
 
 HEADERS += \
 	   bmpdetect.hxx \
 	   breakpoint-cache.hxx \
+	   clex/clex.hxx \
 	   clex/cscanner.hxx \
 	   disassembly-cache.hxx \
+	   file-id.hxx \
 	   gdb-mi-parser.hxx \
+	   gdb-value.hxx \
+	   identifier-index.hxx \
+	   incremental-flasher.hxx \
+	   incremental-job.hxx \
+	   literal-search.hxx \
+	   live-watch.hxx \
 	   mainwindow.hxx \
+	   memory-dump-model.hxx \
 	   gdbmireceiver.hxx \
 	   ./troll/gdbserver.hxx \
 	   ./troll/target-corefile.hxx \
 	   ./troll/target.hxx \
+	   path-resolver.hxx \
 	   source-code-location.hxx \
+	   source-corpus.hxx \
 	   source-file-data.hxx \
 	   source-files-cache.hxx \
+	   string-pool.hxx \
+	   svd-image.hxx \
+	   svd-snapshot.hxx \
+	   svd-tree-model.hxx \
 	   svdfileparser.hxx \
+	   symbol-index.hxx \
+	   symbol-item-models.hxx \
+	   target-memory-cache.hxx \
+	   target-memory-verifier.hxx \
+	   trigram-index.hxx \
 	   troll/gdb-remote.hxx \
 	   utils.hxx
 
@@ -31,13 +31,16 @@ public:
 static QString filenameToWindowsFilename(const QString & filename)
 {
 /* A regular expression used for detecting msys paths, that need to be adjusted on windows systems.
- * This is not really exact... */
-QRegularExpression rx("^/(\\w)/");
+ * This is not really exact... The regular expression is compiled only once, as this is called for
+ * each source code file that is accessed. */
+static const QRegularExpression rx("^/(\\w)/");
 
 	QRegularExpressionMatch match = rx.match(filename);
 	if (match.hasMatch())
-		return QString(filename).replace(rx, match.captured(1) + ":/");
+		return match.captured(1) + ":/" + filename.mid(match.capturedLength());
 	return filename;
 }
+/* Escapes a string, so that it can be placed in quotation marks in gdb commands. */
+static QString escapeString(const QString & s) { QString t = s; return t.replace('\\', "\\\\").replace('\"', "\\\""); }
 
 };